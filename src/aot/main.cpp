@@ -0,0 +1,43 @@
+/**
+ * SOMOS AOT
+ *
+ * Translates a cartridge to C++ ahead of time, see Aot.h
+ * Usage: somos_aot <rom> <output.cpp> <name>
+ */
+
+#include "Aot.h"
+#include "Memory.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        std::cerr << "Usage: somos_aot <rom> <output.cpp> <name>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream rom_file{argv[1], std::ios::binary};
+    if (!rom_file) {
+        std::cerr << "Could not open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> rom{std::istreambuf_iterator<char>{rom_file}, {}};
+
+    Memory mem{};
+    mem.load_cartridge(rom);
+
+    AotTranslator translator{&mem};
+    translator.walk();
+
+    std::ofstream out{argv[2]};
+    translator.emit(out, argv[3]);
+    if (!out) {
+        std::cerr << "Could not write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Translated " << translator.get_blocks().size() << " blocks of " << argv[1] << std::endl;
+    return 0;
+}
@@ -204,8 +204,10 @@ void Application::draw_cart_mem_viewer() {
     }
     if (m_sms.cart_loaded()) {
         static MemoryEditor mem_edit;
-        auto cart = m_sms.dump_cartridge_data();
-        mem_edit.DrawContents(&cart[0], cart.size());
+        // The viewer shows the cartridge in place, so it must not write to it
+        mem_edit.ReadOnly = true;
+        const std::vector<uint8_t>& cart = m_sms.dump_cartridge_data();
+        mem_edit.DrawContents(const_cast<uint8_t*>(cart.data()), cart.size());
     } else {
         ImGui::TextWrapped("NO CART LOADED");
     }
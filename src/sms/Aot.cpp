@@ -0,0 +1,224 @@
+/**
+ * AOT
+ *
+ * Ahead of time translation of a cartridge to C++
+ */
+
+#include "Aot.h"
+#include "Z80.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <set>
+
+NativeBlock AotProgram::find_block(uint32_t physical) const {
+    const AotBlock* end = blocks + block_count;
+    const AotBlock* block = std::lower_bound(blocks, end, physical, [](const AotBlock& b, uint32_t p) {
+        return b.physical < p;
+    });
+
+    return (block != end && block->physical == physical) ? block->run : nullptr;
+}
+
+uint32_t rom_checksum(const std::vector<uint8_t> &rom) {
+    uint32_t hash = 2166136261u;
+    for (uint8_t byte : rom) {
+        hash = (hash ^ byte) * 16777619u;
+    }
+
+    return hash;
+}
+
+static std::vector<const AotProgram*>& aot_programs() {
+    // Function local so that it is constructed before the first static initialiser registers a program
+    static std::vector<const AotProgram*> programs;
+    return programs;
+}
+
+bool register_aot_program(const AotProgram *program) {
+    aot_programs().push_back(program);
+    return true;
+}
+
+void unregister_aot_program(const AotProgram *program) {
+    std::vector<const AotProgram*>& programs = aot_programs();
+    programs.erase(std::remove(programs.begin(), programs.end(), program), programs.end());
+}
+
+const AotProgram* find_aot_program(const std::vector<uint8_t> &rom) {
+    uint32_t checksum = rom_checksum(rom);
+    for (const AotProgram* program : aot_programs()) {
+        if (program->rom_size == rom.size() && program->rom_checksum == checksum) {
+            return program;
+        }
+    }
+
+    return nullptr;
+}
+
+AotTranslator::AotTranslator(Memory *mem) : m_mem(mem) {
+}
+
+void AotTranslator::walk() {
+    // Reset, maskable interrupt (IM 1) and non-maskable interrupt vectors
+    std::vector<uint16_t> pending = {0x0000, 0x0038, 0x0066};
+    std::set<uint32_t> visited;
+    std::vector<uint16_t> targets;
+
+    m_blocks.clear();
+    while (!pending.empty()) {
+        uint16_t pc = pending.back();
+        pending.pop_back();
+
+        // Code in RAM can change, so only ROM is translated
+        uint32_t physical = m_mem->physical_address(pc);
+        if (!m_mem->is_rom(physical) || !visited.insert(physical).second) {
+            continue;
+        }
+
+        Block block{physical, static_cast<uint8_t>(physical / CART_PAGE_SIZE), pc, {}};
+        int page_offset = physical & (MEMORY_PAGE_SIZE - 1);
+        while (true) {
+            uint16_t opcode = Z80::decode_opcode(m_mem, pc);
+            int size = Z80::opcode_info(opcode).size;
+
+            // Instructions that aren't implemented end the path. Instructions that cross into the next page run in the
+            // interpreter, the walk carries on after them
+            if (size == 0) {
+                break;
+            }
+            if (page_offset + size > MEMORY_PAGE_SIZE) {
+                pending.push_back(pc + size);
+                break;
+            }
+
+            block.opcodes.push_back(opcode);
+            targets.clear();
+            bool falls_through = successors(pc, opcode, targets);
+            pc += size;
+            page_offset += size;
+            pending.insert(pending.end(), targets.begin(), targets.end());
+
+            // A branch ends the block, the code after a conditional branch starts a block of its own
+            if (!falls_through) {
+                break;
+            }
+            if (!targets.empty() || page_offset == MEMORY_PAGE_SIZE) {
+                pending.push_back(pc);
+                break;
+            }
+        }
+
+        if (!block.opcodes.empty()) {
+            m_blocks.push_back(std::move(block));
+        }
+    }
+
+    std::sort(m_blocks.begin(), m_blocks.end(), [](const Block& a, const Block& b) {
+        return a.physical < b.physical;
+    });
+}
+
+bool AotTranslator::successors(uint16_t pc, uint16_t opcode, std::vector<uint16_t> &targets) const {
+    // https://clrhome.org/table/
+    auto relative = [&]() {
+        return static_cast<uint16_t>(pc + 2 + static_cast<int8_t>(m_mem->read(pc + 1)));
+    };
+
+    switch (opcode) {
+        // djnz d, jr cc, d
+        case 0x10:
+        case 0x20:
+        case 0x28:
+        case 0x30:
+        case 0x38:
+            targets.push_back(relative());
+            return true;
+        // jr d
+        case 0x18:
+            targets.push_back(relative());
+            return false;
+        // jp nn
+        case 0xC3:
+            targets.push_back(m_mem->read_word(pc + 1));
+            return false;
+        // call nn
+        case 0xCD:
+            targets.push_back(m_mem->read_word(pc + 1));
+            return true;
+        // ret, jp (hl), jp (ix), jp (iy)
+        case 0xC9:
+        case 0xE9:
+        case OPCODE_TABLE_DD | 0xE9:
+        case OPCODE_TABLE_FD | 0xE9:
+            return false;
+        default:
+            break;
+    }
+
+    // retn and reti, which are repeated every 8 opcodes
+    if ((opcode & 0xFFC7) == (OPCODE_TABLE_ED | 0x45)) {
+        return false;
+    }
+    // Nothing else that is prefixed branches
+    if (opcode >= OPCODE_TABLE_CB) {
+        return true;
+    }
+
+    // jp cc, nn and call cc, nn
+    if ((opcode & 0xC7) == 0xC2 || (opcode & 0xC7) == 0xC4) {
+        targets.push_back(m_mem->read_word(pc + 1));
+    }
+    // rst p
+    if ((opcode & 0xC7) == 0xC7) {
+        targets.push_back(opcode & 0x38);
+    }
+
+    return true;
+}
+
+const std::vector<AotTranslator::Block>& AotTranslator::get_blocks() const {
+    return m_blocks;
+}
+
+void AotTranslator::emit(std::ostream &out, const std::string &name) const {
+    const std::vector<uint8_t>& rom = m_mem->dump_cartridge_data();
+
+    out << std::hex << std::uppercase << std::setfill('0');
+    out << "// Generated by somos_aot. Do not edit\n"
+        << "// " << std::dec << rom.size() << " byte ROM, " << m_blocks.size() << " blocks\n\n"
+        << "#include \"Aot.h\"\n"
+        << "#include \"Z80_Opcodes.h\"\n\n"
+        << "namespace aot_" << name << " {\n" << std::hex;
+
+    for (const Block& block : m_blocks) {
+        out << "    // Bank " << std::dec << static_cast<int>(block.bank) << std::hex
+            << ", 0x" << std::setw(4) << block.address << "\n"
+            << "    void block_" << std::setw(6) << block.physical << "(Z80& cpu) {\n";
+        for (size_t i = 0; i < block.opcodes.size(); i++) {
+            out << "        ";
+            if (i + 1 < block.opcodes.size()) {
+                out << "if (!";
+            }
+            out << "Z80::aot_step<0x" << std::setw(2) << static_cast<int>(block.opcodes[i]) << ">(cpu)";
+            out << (i + 1 < block.opcodes.size() ? ") return;\n" : ";\n");
+        }
+        out << "    }\n\n";
+    }
+
+    if (!m_blocks.empty()) {
+        out << "    const AotBlock blocks[] = {\n";
+        for (const Block& block : m_blocks) {
+            out << "        {0x" << std::setw(6) << block.physical << ", " << std::dec << static_cast<int>(block.bank)
+                << std::hex << ", 0x" << std::setw(4) << block.address << ", block_" << std::setw(6) << block.physical
+                << "},\n";
+        }
+        out << "    };\n\n";
+    }
+
+    out << "    const AotProgram program = {" << std::dec << rom.size() << ", 0x" << std::hex << std::setw(8)
+        << rom_checksum(rom) << ", " << (m_blocks.empty() ? "nullptr" : "blocks") << ", " << std::dec
+        << m_blocks.size() << "};\n"
+        << "    [[maybe_unused]] const bool registered = register_aot_program(&program);\n"
+        << "}\n";
+}
@@ -0,0 +1,112 @@
+/**
+ * AOT
+ *
+ * Ahead of time translation of a cartridge to C++. The somos_aot tool walks the control flow of a ROM from the reset
+ * and interrupt vectors, and emits a function for every block of reachable code. The instructions are inlined from
+ * Z80_Opcodes.h, so each block compiles to straight-line code. Compiled into the emulator, the functions run whenever
+ * the PC reaches the start of a block of that ROM. Anything the walk couldn't reach, such as code behind computed
+ * jumps or in RAM, still runs in the interpreter
+ */
+
+#ifndef SOMOS_AOT_H
+#define SOMOS_AOT_H
+
+#include "Jit.h"
+#include "Memory.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct AotBlock {
+    // Physical address of the first instruction, which is also its offset in the ROM
+    uint32_t physical;
+    // Where the walk found the block: the 16KB ROM bank and the CPU address it was mapped at
+    uint8_t bank;
+    uint16_t address;
+    NativeBlock run;
+};
+
+/**
+ * The translated blocks of a single ROM, sorted by physical address
+ */
+struct AotProgram {
+    uint32_t rom_size;
+    uint32_t rom_checksum;
+    const AotBlock* blocks;
+    int block_count;
+
+    /**
+     * @return The translated block starting at the physical address, or nullptr if there isn't one
+     */
+    NativeBlock find_block(uint32_t physical) const;
+};
+
+/**
+ * Checksum used to check that a translated program belongs to the loaded cartridge (32-bit FNV-1a)
+ * @param rom The cartridge, without the dump header
+ */
+uint32_t rom_checksum(const std::vector<uint8_t>& rom);
+
+/**
+ * Makes a program available to every SMS. Called by the static initialisers of the generated code
+ * @return Always true, so that it can initialise a static variable
+ */
+bool register_aot_program(const AotProgram* program);
+
+/**
+ * Stops offering a registered program to the SMS. Cartridges that are already running from it keep using it
+ */
+void unregister_aot_program(const AotProgram* program);
+
+/**
+ * @return The registered program for the cartridge, or nullptr if it wasn't translated
+ */
+const AotProgram* find_aot_program(const std::vector<uint8_t>& rom);
+
+class AotTranslator {
+public:
+    /**
+     * A block found by the walk. It never crosses a 1KB page, as the next page can be mapped to another bank
+     */
+    struct Block {
+        uint32_t physical;
+        uint8_t bank;
+        uint16_t address;
+        // Indices in the opcode tables, see Z80::decode_opcode
+        std::vector<uint16_t> opcodes;
+    };
+
+    AotTranslator() = delete;
+
+    explicit AotTranslator(Memory* mem);
+
+    /**
+     * Finds the reachable code of the cartridge in mem, using the memory map it has after a reset.
+     * Fallthrough, relative and absolute jumps, calls and restarts are followed. Computed jumps and returns end the
+     * walk of their path
+     */
+    void walk();
+
+    const std::vector<Block>& get_blocks() const;
+
+    /**
+     * Writes the C++ source of the translated program
+     * @param out Where to write the source to
+     * @param name Identifier used for the program, it has to be unique among the translated ROMs
+     */
+    void emit(std::ostream& out, const std::string& name) const;
+
+private:
+    Memory* m_mem;
+    std::vector<Block> m_blocks;
+
+    /**
+     * Gets the addresses that can run after the instruction at pc
+     * @return Whether the instruction can also fall through to the next one
+     */
+    bool successors(uint16_t pc, uint16_t opcode, std::vector<uint16_t>& targets) const;
+};
+
+#endif //SOMOS_AOT_H
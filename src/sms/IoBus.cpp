@@ -0,0 +1,50 @@
+/**
+ * IO BUS
+ *
+ * Decodes the Z80 I/O ports into the devices attached to them
+ */
+
+#include "IoBus.h"
+
+// Handlers of the ports that nothing is attached to. Reads see the pull-ups of the data bus
+static uint8_t unconnected_read(void*, uint8_t) {
+    return 0xFF;
+}
+
+static void unconnected_write(void*, uint8_t, uint8_t) {
+}
+
+IoBus::IoBus() {
+    detach_all();
+}
+
+void IoBus::set_model(ConsoleModel model) {
+    m_model = model;
+    update_port_tables();
+}
+
+ConsoleModel IoBus::get_model() const {
+    return m_model;
+}
+
+void IoBus::detach_all() {
+    m_function_readers.fill({unconnected_read, nullptr, 0});
+    m_function_writers.fill({unconnected_write, nullptr});
+    update_port_tables();
+}
+
+void IoBus::update_port_tables() {
+    if (m_model == ConsoleModel::GAME_GEAR) {
+        decode_ports<GameGearPorts>();
+    } else {
+        decode_ports<SmsPorts>();
+    }
+}
+
+template<typename Ports>
+void IoBus::decode_ports() {
+    for (int port = 0; port < 256; port++) {
+        m_readers[port] = m_function_readers[static_cast<int>(Ports::read_function(port))];
+        m_writers[port] = m_function_writers[static_cast<int>(Ports::write_function(port))];
+    }
+}
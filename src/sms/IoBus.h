@@ -0,0 +1,199 @@
+/**
+ * IO BUS
+ *
+ * Connects the Z80 I/O ports to the devices behind them. The consoles only decode a few bits of the port number, so
+ * each device is mirrored over a range of ports. The decoding of every port is worked out once, when a device is
+ * attached or the console model changes, so an access is a single load from a 256 entry table and a call
+ */
+
+#ifndef SOMOS_IOBUS_H
+#define SOMOS_IOBUS_H
+
+#include <array>
+#include <cstdint>
+
+enum class ConsoleModel {
+    SMS1,
+    SMS2,
+    GAME_GEAR,
+};
+
+/**
+ * The functions a port can be decoded to. Devices attach their handlers to these rather than to port numbers
+ */
+enum class PortFunction : uint8_t {
+    // Nothing drives the data bus, reads return 0xFF
+    NONE,
+    MEMORY_CONTROL,
+    IO_CONTROL,
+    V_COUNTER,
+    H_COUNTER,
+    PSG,
+    VDP_DATA,
+    VDP_CONTROL,
+    // Controller port A and the low bits of port B
+    IO_PORT_AB,
+    // The high bits of controller port B, the reset button and the light gun lines
+    IO_PORT_B_MISC,
+    // Start button, serial port and stereo sound registers of the Game Gear (ports 0x00-0x06)
+    GG_REGISTERS,
+};
+
+constexpr int PORT_FUNCTION_COUNT = 11;
+
+/**
+ * Port decoding of the SMS1 and SMS2. Only bits 7, 6 and 0 of the port number are decoded. The two models differ in
+ * their VDP, not in their port map
+ */
+struct SmsPorts {
+    static constexpr PortFunction read_function(uint8_t port) {
+        switch (port & 0xC1) {
+            case 0x40: return PortFunction::V_COUNTER;
+            case 0x41: return PortFunction::H_COUNTER;
+            case 0x80: return PortFunction::VDP_DATA;
+            case 0x81: return PortFunction::VDP_CONTROL;
+            case 0xC0: return PortFunction::IO_PORT_AB;
+            case 0xC1: return PortFunction::IO_PORT_B_MISC;
+            default: return PortFunction::NONE;
+        }
+    }
+
+    static constexpr PortFunction write_function(uint8_t port) {
+        switch (port & 0xC1) {
+            case 0x00: return PortFunction::MEMORY_CONTROL;
+            case 0x01: return PortFunction::IO_CONTROL;
+            case 0x40:
+            case 0x41: return PortFunction::PSG;
+            case 0x80: return PortFunction::VDP_DATA;
+            case 0x81: return PortFunction::VDP_CONTROL;
+            default: return PortFunction::NONE;
+        }
+    }
+};
+
+/**
+ * Port decoding of the Game Gear. The same as the SMS, except for its own registers at the start of the range
+ */
+struct GameGearPorts {
+    static constexpr PortFunction read_function(uint8_t port) {
+        return port <= 0x06 ? PortFunction::GG_REGISTERS : SmsPorts::read_function(port);
+    }
+
+    static constexpr PortFunction write_function(uint8_t port) {
+        return port <= 0x06 ? PortFunction::GG_REGISTERS : SmsPorts::write_function(port);
+    }
+};
+
+class IoBus {
+public:
+    using ReadHandler = uint8_t (*)(void* device, uint8_t port);
+    using WriteHandler = void (*)(void* device, uint8_t port, uint8_t value);
+
+    IoBus();
+
+    /**
+     * Changes the port decoding to the one of the console model. Attached devices stay attached
+     */
+    void set_model(ConsoleModel model);
+
+    ConsoleModel get_model() const;
+
+    /**
+     * Attaches a device to the reads of every port decoded to the function
+     * @tparam Read Member function of the device that handles a read, it gets the port number
+     * @param changes_state Whether reading the port again right away can give a different value, like the VDP data
+     * port moving on to the next address. Reads that only clear flags, which the next read would find cleared anyway,
+     * don't count
+     */
+    template<auto Read, typename Device>
+    void attach_read(PortFunction function, Device* device, bool changes_state = false);
+
+    /**
+     * Attaches a device to the writes of every port decoded to the function
+     * @tparam Write Member function of the device that handles a write, it gets the port number and the value
+     */
+    template<auto Write, typename Device>
+    void attach_write(PortFunction function, Device* device);
+
+    /**
+     * Disconnects every device
+     */
+    void detach_all();
+
+    uint8_t read(uint8_t port);
+    void write(uint8_t port, uint8_t value);
+
+    /**
+     * @return The number of port writes, and of reads from ports attached with changes_state, made so far. Used by
+     * the Z80 to check that a loop has no side effects, so that loops polling a status port can still be skipped
+     */
+    uint32_t side_effect_count() const;
+
+private:
+    struct PortReader {
+        ReadHandler read;
+        void* device;
+        // 1 if reads change the state of the device, added to the side effect count
+        uint32_t side_effect;
+    };
+
+    struct PortWriter {
+        WriteHandler write;
+        void* device;
+    };
+
+    ConsoleModel m_model{ConsoleModel::SMS2};
+
+    // Handlers attached to each function
+    std::array<PortReader, PORT_FUNCTION_COUNT> m_function_readers{};
+    std::array<PortWriter, PORT_FUNCTION_COUNT> m_function_writers{};
+
+    // Handlers of each port, rebuilt from the ones above
+    std::array<PortReader, 256> m_readers{};
+    std::array<PortWriter, 256> m_writers{};
+
+    uint32_t m_side_effect_count{0};
+
+    /**
+     * Fills the port tables from the decoding of the current model
+     */
+    void update_port_tables();
+
+    template<typename Ports>
+    void decode_ports();
+};
+
+template<auto Read, typename Device>
+void IoBus::attach_read(PortFunction function, Device* device, bool changes_state) {
+    m_function_readers[static_cast<int>(function)] = {[](void* d, uint8_t port) -> uint8_t {
+        return (static_cast<Device*>(d)->*Read)(port);
+    }, device, changes_state ? 1u : 0u};
+    update_port_tables();
+}
+
+template<auto Write, typename Device>
+void IoBus::attach_write(PortFunction function, Device* device) {
+    m_function_writers[static_cast<int>(function)] = {[](void* d, uint8_t port, uint8_t value) {
+        (static_cast<Device*>(d)->*Write)(port, value);
+    }, device};
+    update_port_tables();
+}
+
+// The Z80 calls these for every in and out instruction, so they are defined inline
+inline uint8_t IoBus::read(uint8_t port) {
+    const PortReader& reader = m_readers[port];
+    m_side_effect_count += reader.side_effect;
+    return reader.read(reader.device, port);
+}
+
+inline void IoBus::write(uint8_t port, uint8_t value) {
+    m_side_effect_count++;
+    const PortWriter& writer = m_writers[port];
+    writer.write(writer.device, port, value);
+}
+
+inline uint32_t IoBus::side_effect_count() const {
+    return m_side_effect_count;
+}
+
+#endif //SOMOS_IOBUS_H
@@ -0,0 +1,133 @@
+/**
+ * JIT
+ *
+ * Executable memory for the Z80 recompiler
+ */
+
+#include "Jit.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define SOMOS_JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define SOMOS_JIT_X86_64 0
+#endif
+
+// Size of the code buffer. When it fills up all translations are discarded and the hot blocks are translated again
+constexpr size_t JIT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+#if SOMOS_JIT_X86_64
+/**
+ * Changes the protection of the pages holding a range of the buffer
+ * @return false if the system refused, e.g. because policy forbids making memory executable
+ */
+static bool protect(uint8_t* code, size_t start, size_t end, int protection) {
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t first = start & ~(page_size - 1);
+    size_t last = (end + page_size - 1) & ~(page_size - 1);
+
+    return mprotect(code + first, last - first, protection) == 0;
+}
+#endif
+
+JitCodeBuffer::~JitCodeBuffer() {
+#if SOMOS_JIT_X86_64
+    if (m_code != nullptr) {
+        munmap(m_code, JIT_BUFFER_SIZE);
+    }
+#endif
+}
+
+bool JitCodeBuffer::allocate() {
+#if SOMOS_JIT_X86_64
+    if (m_unusable) {
+        return false;
+    }
+
+    if (m_code == nullptr) {
+        void* code = mmap(nullptr, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (code == MAP_FAILED) {
+            return false;
+        }
+        m_code = static_cast<uint8_t*>(code);
+        m_used = 0;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool JitCodeBuffer::begin(size_t size) {
+    if (m_code == nullptr || m_unusable || m_used + size > JIT_BUFFER_SIZE) {
+        return false;
+    }
+
+#if SOMOS_JIT_X86_64
+    // The last page in use can hold the end of the previous function, which isn't running while this one is emitted
+    if (!protect(m_code, m_used, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE)) {
+        m_unusable = true;
+        return false;
+    }
+#endif
+    m_function = m_used;
+    return true;
+}
+
+NativeBlock JitCodeBuffer::finish(size_t entry) {
+#if SOMOS_JIT_X86_64
+    if (!protect(m_code, m_function, m_used, PROT_READ | PROT_EXEC)) {
+        m_unusable = true;
+        return nullptr;
+    }
+#endif
+    return reinterpret_cast<NativeBlock>(m_code + entry);
+}
+
+void JitCodeBuffer::clear() {
+    m_used = 0;
+    m_function = 0;
+}
+
+size_t JitCodeBuffer::position() const {
+    return m_used;
+}
+
+void JitCodeBuffer::emit(std::initializer_list<uint8_t> bytes) {
+    for (uint8_t byte : bytes) {
+        m_code[m_used++] = byte;
+    }
+}
+
+void JitCodeBuffer::emit_u8(uint8_t value) {
+    m_code[m_used++] = value;
+}
+
+void JitCodeBuffer::emit_u16(uint16_t value) {
+    std::memcpy(m_code + m_used, &value, sizeof(value));
+    m_used += sizeof(value);
+}
+
+void JitCodeBuffer::emit_u32(uint32_t value) {
+    std::memcpy(m_code + m_used, &value, sizeof(value));
+    m_used += sizeof(value);
+}
+
+void JitCodeBuffer::emit_u64(uint64_t value) {
+    std::memcpy(m_code + m_used, &value, sizeof(value));
+    m_used += sizeof(value);
+}
+
+void JitCodeBuffer::emit_rel32(size_t target) {
+    // Relative to the end of the displacement, which ends the instruction
+    emit_u32(static_cast<uint32_t>(target - (m_used + 4)));
+}
+
+void JitCodeBuffer::patch_rel32(size_t displacement) {
+    uint32_t value = static_cast<uint32_t>(m_used - (displacement + 4));
+    std::memcpy(m_code + displacement, &value, sizeof(value));
+}
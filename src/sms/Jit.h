@@ -0,0 +1,103 @@
+/**
+ * JIT
+ *
+ * Executable memory for the Z80 recompiler. The buffer is never writable and executable at the same time: code is
+ * emitted while it is mapped read-write, and it is switched to read-execute before any of it runs. The x86-64
+ * instructions themselves are chosen by the translator in Z80_Jit.cpp, this only stores their bytes
+ */
+
+#ifndef SOMOS_JIT_H
+#define SOMOS_JIT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+// The translator emits x86-64 code using the System V calling convention
+#if defined(SOMOS_JIT) && defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define SOMOS_Z80_JIT 1
+#else
+#define SOMOS_Z80_JIT 0
+#endif
+
+class Z80;
+
+// Executes a single instruction of a block and returns whether the block can carry on with the next one
+using BlockStep = bool (*)(Z80& cpu);
+
+// Translated block
+using NativeBlock = void (*)(Z80& cpu);
+
+class JitCodeBuffer {
+public:
+    JitCodeBuffer() = default;
+
+    ~JitCodeBuffer();
+
+    JitCodeBuffer(const JitCodeBuffer&) = delete;
+
+    JitCodeBuffer& operator=(const JitCodeBuffer&) = delete;
+
+    /**
+     * Maps the memory, if it hasn't been mapped yet
+     * @return false if native code can't be generated on this platform, or can't run because its protection couldn't
+     * be changed
+     */
+    bool allocate();
+
+    /**
+     * Starts a new function, making the unused part of the buffer writable
+     * @param size The most bytes the function can take
+     * @return false if there isn't that much space left, or if the buffer couldn't be made writable. The buffer can't
+     * be used any more in that case
+     */
+    bool begin(size_t size);
+
+    /**
+     * Makes the function started by begin() executable
+     * @param entry Position of the first instruction to run, which doesn't have to be the first one emitted
+     * @return The function, or nullptr if the buffer couldn't be made executable. Then none of the functions returned
+     * so far can run, and the buffer can't be used any more
+     */
+    NativeBlock finish(size_t entry);
+
+    /**
+     * Discards all translated code. Every NativeBlock returned so far becomes invalid
+     */
+    void clear();
+
+    /**
+     * @return The offset of the next byte, to be used as a jump target or patched by patch_rel32()
+     */
+    size_t position() const;
+
+    void emit(std::initializer_list<uint8_t> bytes);
+
+    void emit_u8(uint8_t value);
+
+    void emit_u16(uint16_t value);
+
+    void emit_u32(uint32_t value);
+
+    void emit_u64(uint64_t value);
+
+    /**
+     * Emits the 32-bit displacement of a jump or call to a position
+     */
+    void emit_rel32(size_t target);
+
+    /**
+     * Points the 32-bit displacement emitted at a position, which ends the instruction, to the next byte
+     */
+    void patch_rel32(size_t displacement);
+
+private:
+    uint8_t* m_code{nullptr};
+    // Bytes in use, and where the function being emitted starts
+    size_t m_used{0};
+    size_t m_function{0};
+    // Set when the protection of the buffer couldn't be changed
+    bool m_unusable{false};
+};
+
+#endif //SOMOS_JIT_H
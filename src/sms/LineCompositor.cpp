@@ -0,0 +1,135 @@
+/**
+ * LINE COMPOSITOR
+ *
+ * Scalar, SSE2 and AVX2 kernels of the line composition
+ */
+
+#include "LineCompositor.h"
+#include "Vdp.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOMOS_COMPOSITOR_SSE2 1
+#include <emmintrin.h>
+#else
+#define SOMOS_COMPOSITOR_SSE2 0
+#endif
+
+// The AVX2 kernel is built with a target attribute so the rest of the emulator doesn't need AVX2, which needs GCC or
+// Clang
+#if SOMOS_COMPOSITOR_SSE2 && (defined(__GNUC__) || defined(__clang__))
+#define SOMOS_COMPOSITOR_AVX2 1
+#include <immintrin.h>
+#else
+#define SOMOS_COMPOSITOR_AVX2 0
+#endif
+
+static void compose_line_scalar(const uint8_t* background, const uint8_t* priority, const uint8_t* sprites,
+                                const uint8_t* cram, uint8_t* out) {
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+        bool sprite_shown = sprites[x] != 0 && priority[x] == 0;
+        uint8_t index = sprite_shown ? 16 | sprites[x] : background[x];
+        out[x] = cram[index];
+    }
+}
+
+#if SOMOS_COMPOSITOR_SSE2
+static void compose_line_sse2(const uint8_t* background, const uint8_t* priority, const uint8_t* sprites,
+                              const uint8_t* cram, uint8_t* out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i sprite_palette = _mm_set1_epi8(16);
+    alignas(16) uint8_t indices[16];
+
+    for (int x = 0; x < SCREEN_WIDTH; x += 16) {
+        __m128i bg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(background + x));
+        __m128i front = _mm_loadu_si128(reinterpret_cast<const __m128i*>(priority + x));
+        __m128i sprite = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sprites + x));
+
+        // The background shows where there is no sprite or where it is in front
+        __m128i background_shown = _mm_or_si128(_mm_cmpeq_epi8(sprite, zero), front);
+        __m128i index = _mm_or_si128(_mm_and_si128(background_shown, bg),
+                                     _mm_andnot_si128(background_shown, _mm_or_si128(sprite, sprite_palette)));
+
+        // SSE2 has no byte shuffle, so CRAM is read one pixel at a time
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices), index);
+        for (int i = 0; i < 16; i++) {
+            out[x + i] = cram[indices[i]];
+        }
+    }
+}
+#endif
+
+#if SOMOS_COMPOSITOR_AVX2
+__attribute__((target("avx2")))
+static void compose_line_avx2(const uint8_t* background, const uint8_t* priority, const uint8_t* sprites,
+                              const uint8_t* cram, uint8_t* out) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i sprite_palette = _mm256_set1_epi8(16);
+    // Each half of CRAM in both 128 bit lanes, as the shuffle only looks up 16 bytes within a lane
+    const __m256i background_colors =
+            _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cram)));
+    const __m256i sprite_colors =
+            _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cram + 16)));
+
+    for (int x = 0; x < SCREEN_WIDTH; x += 32) {
+        __m256i bg = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(background + x));
+        __m256i front = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(priority + x));
+        __m256i sprite = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sprites + x));
+
+        __m256i background_shown = _mm256_or_si256(_mm256_cmpeq_epi8(sprite, zero), front);
+        __m256i index = _mm256_blendv_epi8(_mm256_or_si256(sprite, sprite_palette), bg, background_shown);
+
+        // Indices are below 32, so bit 7 is clear and the shuffle uses the low 4 bits. Bit 4 picks the palette
+        __m256i from_background = _mm256_shuffle_epi8(background_colors, index);
+        __m256i from_sprites = _mm256_shuffle_epi8(sprite_colors, index);
+        __m256i in_sprite_palette = _mm256_cmpeq_epi8(_mm256_and_si256(index, sprite_palette), sprite_palette);
+        __m256i color = _mm256_blendv_epi8(from_background, from_sprites, in_sprite_palette);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), color);
+    }
+}
+#endif
+
+bool compositor_supported(CompositorKernel kernel) {
+    switch (kernel) {
+        case CompositorKernel::SCALAR:
+            return true;
+        case CompositorKernel::SSE2:
+            return SOMOS_COMPOSITOR_SSE2;
+        case CompositorKernel::AVX2:
+#if SOMOS_COMPOSITOR_AVX2
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+LineCompositor get_line_compositor(CompositorKernel kernel) {
+    if (!compositor_supported(kernel)) {
+        return nullptr;
+    }
+
+    switch (kernel) {
+#if SOMOS_COMPOSITOR_AVX2
+        case CompositorKernel::AVX2:
+            return compose_line_avx2;
+#endif
+#if SOMOS_COMPOSITOR_SSE2
+        case CompositorKernel::SSE2:
+            return compose_line_sse2;
+#endif
+        default:
+            return compose_line_scalar;
+    }
+}
+
+CompositorKernel best_compositor_kernel() {
+    if (compositor_supported(CompositorKernel::AVX2)) {
+        return CompositorKernel::AVX2;
+    }
+    if (compositor_supported(CompositorKernel::SSE2)) {
+        return CompositorKernel::SSE2;
+    }
+    return CompositorKernel::SCALAR;
+}
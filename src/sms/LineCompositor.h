@@ -0,0 +1,46 @@
+/**
+ * LINE COMPOSITOR
+ *
+ * Last step of rendering a line: merges the background and sprite layers and looks the resulting palette indices up
+ * in CRAM. There is a scalar reference kernel and, on x86, SSE2 and AVX2 ones that must give the same output byte for
+ * byte. The fastest kernel the CPU supports is picked at run time
+ */
+
+#ifndef SOMOS_LINECOMPOSITOR_H
+#define SOMOS_LINECOMPOSITOR_H
+
+#include <cstdint>
+
+enum class CompositorKernel {
+    SCALAR,
+    SSE2,
+    AVX2,
+};
+
+/**
+ * Composes the 256 pixels of a line
+ * @param background Palette index (0-31) of every background pixel
+ * @param priority 0xFF where the background covers the sprites, 0 elsewhere
+ * @param sprites Colour (1-15) of every sprite pixel from the sprite palette, 0 where there is no sprite
+ * @param cram The 32 palette entries
+ * @param out The CRAM entry of every pixel
+ */
+using LineCompositor = void (*)(const uint8_t* background, const uint8_t* priority, const uint8_t* sprites,
+                                const uint8_t* cram, uint8_t* out);
+
+/**
+ * @return Whether the kernel was built in and the CPU can run it
+ */
+bool compositor_supported(CompositorKernel kernel);
+
+/**
+ * @return The kernel, or nullptr if it isn't supported
+ */
+LineCompositor get_line_compositor(CompositorKernel kernel);
+
+/**
+ * @return The fastest supported kernel
+ */
+CompositorKernel best_compositor_kernel();
+
+#endif //SOMOS_LINECOMPOSITOR_H
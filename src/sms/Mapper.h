@@ -0,0 +1,126 @@
+/**
+ * MAPPER
+ *
+ * Compile time descriptions of the cartridge mappers. When a cartridge is loaded Memory picks one of these and
+ * specialises its write and page table code on it, so the access paths never have to check which mapper is in use
+ * https://www.smspower.org/Development/Mappers
+ */
+
+#ifndef SOMOS_MAPPER_H
+#define SOMOS_MAPPER_H
+
+#include <array>
+#include <cstdint>
+
+// Mapper control registers
+constexpr uint16_t MAPPER_RAM_CONTROL_R = 0xfffc;
+constexpr uint16_t MAPPER_SLOT0_CONTROL_R = 0xfffd;
+constexpr uint16_t MAPPER_SLOT1_CONTROL_R = 0xfffe;
+constexpr uint16_t MAPPER_SLOT2_CONTROL_R = 0xffff;
+constexpr uint16_t CODEMASTERS_SLOT0_CONTROL_R = 0x0000;
+constexpr uint16_t CODEMASTERS_SLOT1_CONTROL_R = 0x4000;
+constexpr uint16_t CODEMASTERS_SLOT2_CONTROL_R = 0x8000;
+constexpr uint16_t KOREAN_SLOT2_CONTROL_R = 0xa000;
+
+enum class MapperType {
+    // Let Memory choose based on the cartridge header and size
+    AUTO,
+    // Up to 48KB of ROM mapped linearly, no control registers
+    NONE,
+    SEGA,
+    CODEMASTERS,
+    KOREAN,
+};
+
+/**
+ * Standard SEGA mapper. Control registers are in the last 4 bytes of the address space, which are also RAM
+ */
+struct SegaMapper {
+    // Whether the page of each slot can be changed and, if so, the register that selects it
+    static constexpr std::array<bool, 3> SLOT_PAGED = {true, true, true};
+    static constexpr std::array<uint16_t, 3> SLOT_CONTROL_R = {
+            MAPPER_SLOT0_CONTROL_R, MAPPER_SLOT1_CONTROL_R, MAPPER_SLOT2_CONTROL_R
+    };
+    static constexpr std::array<uint8_t, 3> RESET_PAGES = {0, 1, 2};
+    // The first 1KB of slot 0 is never paged as it contains the interrupt vectors
+    static constexpr bool FIXED_FIRST_KB = true;
+    // Has the RAM control register (0xfffc) that can map cartridge RAM to slot 2
+    static constexpr bool HAS_RAM_CONTROL = true;
+    // Maps 64KB of RAM over the whole address space instead of the slots
+    static constexpr bool FLAT_RAM = false;
+
+    static constexpr bool is_register(uint16_t address) {
+        return address >= MAPPER_RAM_CONTROL_R;
+    }
+};
+
+/**
+ * Codemasters mapper. The control registers are the first byte of each slot
+ * https://www.smspower.org/Development/CodemastersHeader
+ */
+struct CodemastersMapper {
+    static constexpr std::array<bool, 3> SLOT_PAGED = {true, true, true};
+    static constexpr std::array<uint16_t, 3> SLOT_CONTROL_R = {
+            CODEMASTERS_SLOT0_CONTROL_R, CODEMASTERS_SLOT1_CONTROL_R, CODEMASTERS_SLOT2_CONTROL_R
+    };
+    static constexpr std::array<uint8_t, 3> RESET_PAGES = {0, 1, 0};
+    static constexpr bool FIXED_FIRST_KB = false;
+    static constexpr bool HAS_RAM_CONTROL = false;
+    static constexpr bool FLAT_RAM = false;
+
+    static constexpr bool is_register(uint16_t address) {
+        return address == CODEMASTERS_SLOT0_CONTROL_R ||
+               address == CODEMASTERS_SLOT1_CONTROL_R ||
+               address == CODEMASTERS_SLOT2_CONTROL_R;
+    }
+};
+
+/**
+ * Korean mapper. Slots 0 and 1 are fixed to the first 32KB, writing to 0xa000 selects the page in slot 2
+ */
+struct KoreanMapper {
+    static constexpr std::array<bool, 3> SLOT_PAGED = {false, false, true};
+    static constexpr std::array<uint16_t, 3> SLOT_CONTROL_R = {0, 0, KOREAN_SLOT2_CONTROL_R};
+    static constexpr std::array<uint8_t, 3> RESET_PAGES = {0, 1, 0};
+    static constexpr bool FIXED_FIRST_KB = false;
+    static constexpr bool HAS_RAM_CONTROL = false;
+    static constexpr bool FLAT_RAM = false;
+
+    static constexpr bool is_register(uint16_t address) {
+        return address == KOREAN_SLOT2_CONTROL_R;
+    }
+};
+
+/**
+ * Cartridges of 48KB or less without a mapper chip
+ */
+struct NoMapper {
+    static constexpr std::array<bool, 3> SLOT_PAGED = {false, false, false};
+    static constexpr std::array<uint16_t, 3> SLOT_CONTROL_R = {0, 0, 0};
+    static constexpr std::array<uint8_t, 3> RESET_PAGES = {0, 1, 2};
+    static constexpr bool FIXED_FIRST_KB = false;
+    static constexpr bool HAS_RAM_CONTROL = false;
+    static constexpr bool FLAT_RAM = false;
+
+    static constexpr bool is_register(uint16_t) {
+        return false;
+    }
+};
+
+/**
+ * 64KB of RAM with no control registers, see Memory::load_ram_image
+ */
+struct FlatMapper {
+    static constexpr std::array<bool, 3> SLOT_PAGED = {false, false, false};
+    static constexpr std::array<uint16_t, 3> SLOT_CONTROL_R = {0, 0, 0};
+    static constexpr std::array<uint8_t, 3> RESET_PAGES = {0, 1, 2};
+    static constexpr bool FIXED_FIRST_KB = false;
+    static constexpr bool HAS_RAM_CONTROL = false;
+    static constexpr bool FLAT_RAM = true;
+
+    static constexpr bool is_register(uint16_t) {
+        return false;
+    }
+};
+
+#endif //SOMOS_MAPPER_H
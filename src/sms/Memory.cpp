@@ -7,101 +7,301 @@
 #include "Memory.h"
 #include "bit_utils.h"
 
-static inline bool is_slot0(uint16_t address) {
-    return (address >= SLOT0_BASE && address < SLOT1_BASE);
-}
-
-static inline bool is_slot1(uint16_t address) {
-    return (address >= SLOT1_BASE && address < SLOT2_BASE);
-}
+#include <algorithm>
 
-static inline bool is_slot2(uint16_t address) {
-    return (address >= SLOT2_BASE && address < RAM_BASE);
+Memory::Memory() {
+    // Map an empty cartridge so that reads are always backed by memory, even before a game is loaded
+    load_cartridge({});
 }
 
-static inline bool is_ram(uint16_t address) {
-    return (address >= RAM_BASE && address < RAM_MIRROR_BASE);
+void Memory::load_cartridge(const std::vector<uint8_t> &rom_file, MapperType mapper) {
+    load(rom_file, mapper, false);
 }
 
-static inline bool is_ram_mirror(uint16_t address) {
-    return (address >= RAM_MIRROR_BASE && address <= 0xffff);
+void Memory::load_ram_image(const std::vector<uint8_t>& image) {
+    load(image, MapperType::NONE, true);
 }
 
-
-void Memory::load_cartridge(std::vector<uint8_t> rom_file) {
+void Memory::load(const std::vector<uint8_t>& rom_file, MapperType mapper, bool ram_image) {
     // Sometimes a 512 byte header is added to the start of the ROM by dumping software
     // We need to check for this and remove if necessary
     int offset = rom_file.size() % 0x4000 == 512 ? 512 : 0;
 
-    m_cart = std::vector<uint8_t>(rom_file.begin() + offset, rom_file.end());
+    m_cart.assign(rom_file.begin() + offset, rom_file.end());
+
+    // Mapper registers can select any page number, so round the mapped ROM up to a power of two number of pages.
+    // Reads past the end of the cartridge return 0xff, like an unconnected data bus
+    int pages = 1;
+    while (pages * CART_PAGE_SIZE < static_cast<int>(m_cart.size())) {
+        pages *= 2;
+    }
+    m_rom = m_cart;
+    m_rom.resize(pages * CART_PAGE_SIZE, 0xff);
+    m_rom_page_mask = pages - 1;
+
+    if (mapper == MapperType::AUTO) {
+        if (check_codemasters()) {
+            mapper = MapperType::CODEMASTERS;
+        } else if (m_cart.size() <= 0x8000) {
+            mapper = MapperType::NONE;
+        } else {
+            mapper = MapperType::SEGA;
+        }
+    }
+
+    // A new cartridge starts from cleared RAM, nothing left by the previous one carries over
+    m_ram.fill(0);
+    for (auto& bank : m_cart_ram) {
+        bank.fill(0);
+    }
 
-    check_codemasters();
+    m_flat_ram.clear();
+    if (ram_image) {
+        m_flat_ram.assign(0x10000, 0);
+        std::copy_n(m_cart.begin(), std::min<size_t>(m_cart.size(), m_flat_ram.size()), m_flat_ram.begin());
+    }
+
+    // Every physical page starts out with the same, new, generation so that nothing decoded from a previous
+    // cartridge stays valid
+    size_t memory_size = m_rom.size() + RAM_SIZE + sizeof(m_cart_ram) + m_flat_ram.size();
+    int physical_pages = static_cast<int>(memory_size >> MEMORY_PAGE_SHIFT);
+    m_page_generation.assign(physical_pages, ++m_code_generation);
+    m_code_pages.assign(physical_pages, 0);
+
+    if (ram_image) {
+        use_mapper<FlatMapper>(MapperType::NONE);
+    } else {
+        switch (mapper) {
+            case MapperType::SEGA:
+                use_mapper<SegaMapper>(mapper);
+                break;
+            case MapperType::CODEMASTERS:
+                use_mapper<CodemastersMapper>(mapper);
+                break;
+            case MapperType::KOREAN:
+                use_mapper<KoreanMapper>(mapper);
+                break;
+            default:
+                use_mapper<NoMapper>(MapperType::NONE);
+                break;
+        }
+    }
 
     reset();
 }
 
-std::vector<uint8_t> Memory::dump_cartridge_data() {
+template<typename Mapper>
+void Memory::use_mapper(MapperType type) {
+    m_mapper = type;
+    m_write_handler = &Memory::write_mapped<Mapper>;
+    m_reset_handler = &Memory::reset_mapped<Mapper>;
+
+    // Pages holding a mapper register always take the slow write path, whatever they are mapped to
+    m_register_pages.fill(false);
+    for (uint32_t address = 0; address < 0x10000; address++) {
+        if (Mapper::is_register(address)) {
+            m_register_pages[address >> MEMORY_PAGE_SHIFT] = true;
+        }
+    }
+}
+
+const std::vector<uint8_t>& Memory::dump_cartridge_data() const {
     return m_cart;
 }
 
+MapperType Memory::get_mapper() const {
+    return m_mapper;
+}
+
 void Memory::reset() {
+    (this->*m_reset_handler)();
+}
+
+template<typename Mapper>
+void Memory::reset_mapped() {
     // Map the correct ROM banks to slots 0, 1 and 2
-     if(m_codemasters) {
-         m_mem[MAPPER_SLOT0_CONTROL_R] = 0;
-         m_mem[MAPPER_SLOT1_CONTROL_R] = 1;
-         m_mem[MAPPER_SLOT2_CONTROL_R] = 0;
-     } else {
-         m_mem[MAPPER_RAM_CONTROL_R] = 0;
-         m_mem[MAPPER_SLOT0_CONTROL_R] = 0;
-         m_mem[MAPPER_SLOT1_CONTROL_R] = 1;
-         m_mem[MAPPER_SLOT2_CONTROL_R] = 2;
-     }
-}
-
-void Memory::check_codemasters() {
+    m_ram_control = 0;
+    for (int slot = 0; slot < 3; slot++) {
+        m_slot_control[slot] = Mapper::RESET_PAGES[slot];
+    }
+
+    update_page_tables<Mapper>();
+}
+
+bool Memory::check_codemasters() const {
     // https://www.smspower.org/Development/CodemastersHeader
     // To find if this is a Codemasters cartridge, we check if the Words at $7fe6 and $7fe8 sum to 0
     // Both words are stored as Little-Endian
+    if (m_cart.size() < 0x8000) {
+        return false;
+    }
+
     uint16_t checksum = (m_cart[0x7fe7] << 8) | m_cart[0x7fe6];
     uint16_t checksum_neg = (m_cart[0x7fe9] << 8) | m_cart[0x7fe8];
 
-    m_codemasters = (checksum + checksum_neg) == 0x10000;
+    return (checksum + checksum_neg) == 0x10000;
 }
 
-void Memory::write(uint16_t address, uint8_t data) {
-    // https://www.smspower.org/Development/MemoryMap
+void Memory::map_pages(uint16_t base, int size, const uint8_t *read, uint8_t *write) {
+    int first = base >> MEMORY_PAGE_SHIFT;
+    int count = size >> MEMORY_PAGE_SHIFT;
+
+    for (int i = 0; i < count; i++) {
+        m_read_pages[first + i] = read + i * MEMORY_PAGE_SIZE;
+        m_write_pages[first + i] = write != nullptr ? write + i * MEMORY_PAGE_SIZE : nullptr;
 
-    // Addresses larger than our memory space aren't valid
-    if (address > 0xffff) {
+        uint32_t physical = physical_of(read) + i * MEMORY_PAGE_SIZE;
+        m_physical_pages[first + i] = physical;
+        m_watched_pages[first + i] = write != nullptr && m_code_pages[physical >> MEMORY_PAGE_SHIFT];
+        update_direct_write_page(first + i);
+    }
+}
+
+void Memory::update_direct_write_page(int page) {
+    bool direct = !m_watched_pages[page] && !m_register_pages[page];
+    m_direct_write_pages[page] = direct ? m_write_pages[page] : nullptr;
+}
+
+uint32_t Memory::physical_of(const uint8_t *host) const {
+    if (host >= m_rom.data() && host < m_rom.data() + m_rom.size()) {
+        return host - m_rom.data();
+    }
+    if (host >= m_ram.data() && host < m_ram.data() + m_ram.size()) {
+        return m_rom.size() + (host - m_ram.data());
+    }
+    if (host >= m_flat_ram.data() && host < m_flat_ram.data() + m_flat_ram.size()) {
+        return m_rom.size() + RAM_SIZE + sizeof(m_cart_ram) + (host - m_flat_ram.data());
+    }
+
+    return m_rom.size() + RAM_SIZE + (host - m_cart_ram[0].data());
+}
+
+bool Memory::is_rom(uint32_t physical_address) const {
+    return physical_address < m_rom.size();
+}
+
+void Memory::watch_code(uint32_t physical_address) {
+    uint32_t physical_page = physical_address >> MEMORY_PAGE_SHIFT;
+
+    // ROM can't be written, so there is nothing to watch
+    if (is_rom(physical_address) || m_code_pages[physical_page]) {
         return;
     }
 
-    // Addresses lower than 0x8000 are ROM, i.e. slot0 and slot1
-    if (is_slot0(address) || is_slot1(address)) {
+    m_code_pages[physical_page] = 1;
+    update_watched_pages(physical_page);
+}
+
+void Memory::update_watched_pages(uint32_t physical_page) {
+    for (int page = 0; page < MEMORY_PAGE_COUNT; page++) {
+        if ((m_physical_pages[page] >> MEMORY_PAGE_SHIFT) == physical_page) {
+            m_watched_pages[page] = m_write_pages[page] != nullptr && m_code_pages[physical_page];
+            update_direct_write_page(page);
+        }
+    }
+}
+
+void Memory::invalidate_code(uint16_t address) {
+    uint32_t physical_page = m_physical_pages[address >> MEMORY_PAGE_SHIFT] >> MEMORY_PAGE_SHIFT;
+
+    // The page stops being tracked until code is decoded from it again, so that writes to pages that mix code and
+    // data only cost an invalidation the first time
+    m_page_generation[physical_page] = ++m_code_generation;
+    m_code_pages[physical_page] = 0;
+    update_watched_pages(physical_page);
+}
+
+template<typename Mapper>
+void Memory::update_page_tables() {
+    if constexpr (Mapper::FLAT_RAM) {
+        map_pages(0x0000, static_cast<int>(m_flat_ram.size()), m_flat_ram.data(), m_flat_ram.data());
+        m_code_generation++;
         return;
     }
 
+    // https://www.smspower.org/Development/MemoryMap
+    // Cartridge ROM is never written through the page tables, writes to it are either ignored or mapper registers
+    map_pages(SLOT0_BASE, CART_PAGE_SIZE, &m_rom[slotx_page<Mapper>(0) * CART_PAGE_SIZE], nullptr);
+    map_pages(SLOT1_BASE, CART_PAGE_SIZE, &m_rom[slotx_page<Mapper>(1) * CART_PAGE_SIZE], nullptr);
+
+    // In the standard SEGA mapper, the addresses up to 0x03FF are un-paged as they contain the interrupt vectors
+    if constexpr (Mapper::FIXED_FIRST_KB) {
+        map_pages(SLOT0_BASE, MEMORY_PAGE_SIZE, &m_rom[0], nullptr);
+    }
+
     // Slot 2 can either be mapped to ROM or RAM
-    if (is_slot2(address)) {
-        if (is_slot2_ram()) {
-            m_cart_ram[slot2_ram_bank()][address - SLOT2_BASE] = data;
-        } else {
-            return;
+    bool slot2_ram = false;
+    if constexpr (Mapper::HAS_RAM_CONTROL) {
+        slot2_ram = is_slot2_ram();
+    }
+    if (slot2_ram) {
+        uint8_t* cart_ram = m_cart_ram[slot2_ram_bank()].data();
+        map_pages(SLOT2_BASE, CART_PAGE_SIZE, cart_ram, cart_ram);
+    } else {
+        map_pages(SLOT2_BASE, CART_PAGE_SIZE, &m_rom[slotx_page<Mapper>(2) * CART_PAGE_SIZE], nullptr);
+    }
+
+    // RAM and its mirror share the same memory
+    map_pages(RAM_BASE, RAM_SIZE, m_ram.data(), m_ram.data());
+    map_pages(RAM_MIRROR_BASE, RAM_SIZE, m_ram.data(), m_ram.data());
+
+    // Code that is currently running may have been paged out
+    m_code_generation++;
+}
+
+void Memory::write_slow(uint16_t address, uint8_t data) {
+    m_write_count++;
+    (this->*m_write_handler)(address, data);
+}
+
+template<typename Mapper>
+void Memory::write_mapped(uint16_t address, uint8_t data) {
+    // https://www.smspower.org/Development/MemoryMap
+    uint8_t* page = m_write_pages[address >> MEMORY_PAGE_SHIFT];
+    if (page != nullptr) {
+        page[address & (MEMORY_PAGE_SIZE - 1)] = data;
+    }
+
+    if (m_watched_pages[address >> MEMORY_PAGE_SHIFT]) {
+        invalidate_code(address);
+    }
+
+    if (Mapper::is_register(address)) {
+        if (Mapper::HAS_RAM_CONTROL && address == MAPPER_RAM_CONTROL_R) {
+            m_ram_control = data;
+        }
+        for (int slot = 0; slot < 3; slot++) {
+            if (Mapper::SLOT_PAGED[slot] && address == Mapper::SLOT_CONTROL_R[slot]) {
+                m_slot_control[slot] = data;
+            }
         }
+
+        update_page_tables<Mapper>();
     }
+}
 
-    m_mem[address] = data;
+const uint8_t* Memory::read_span(uint16_t address, int count) const {
+    int offset = address & (MEMORY_PAGE_SIZE - 1);
+    if (offset + count > MEMORY_PAGE_SIZE) {
+        return nullptr;
+    }
 
-    // Mirror ram
-    // We're avoiding mirroring the last 4 bytes of RAM in order to not overwrite the mapper control registers
-    if (address >= RAM_BASE && address < (RAM_MIRROR_BASE - 4)) {
-        m_mem[address + RAM_OFFSET] = data;
-    } else if (address >= RAM_MIRROR_BASE) {
-        m_mem[address - RAM_OFFSET] = data;
+    return m_read_pages[address >> MEMORY_PAGE_SHIFT] + offset;
+}
+
+uint8_t* Memory::write_span(uint16_t address, int count) {
+    int page = address >> MEMORY_PAGE_SHIFT;
+    int offset = address & (MEMORY_PAGE_SIZE - 1);
+
+    if (offset + count > MEMORY_PAGE_SIZE || m_direct_write_pages[page] == nullptr) {
+        return nullptr;
     }
+
+    m_write_count += count;
+    return m_direct_write_pages[page] + offset;
 }
 
-bool Memory::is_slot2_ram() {
+bool Memory::is_slot2_ram() const {
     /**
      * RAM Mapper Control Register (0xfffc)
      * https://www.smspower.org/Development/Mappers
@@ -113,14 +313,10 @@ bool Memory::is_slot2_ram() {
         2	RAM bank select
         1-0	Bank shift
      */
-     if(m_codemasters) {
-         return false;
-     }
-
-    return is_bit_set(m_mem[MAPPER_RAM_CONTROL_R], 3);
+    return is_bit_set(m_ram_control, 3);
 }
 
-int Memory::slot2_ram_bank() {
+int Memory::slot2_ram_bank() const {
     /**
      * RAM Mapper Control Register (0xfffc)
      * https://www.smspower.org/Development/Mappers
@@ -132,88 +328,14 @@ int Memory::slot2_ram_bank() {
         2	RAM bank select
         1-0	Bank shift
      */
-    return bit(m_mem[MAPPER_RAM_CONTROL_R], 2);
-}
-
-uint8_t Memory::read(const uint16_t &address) {
-    if (address > 0xffff) {
-        return 0;
-    }
-
-    // In the standard SEGA mapper, the addresses up to 0x03FF are un-paged as they contain the interrupt vectors
-    // The Codemasters mapper does not use this
-    if(!m_codemasters && address >= 0 && address < 0x0400) {
-        return m_cart[address];
-    }
-
-    // Because Cartridge ROM is mapped to Slots 0,1 and maybe 2, we just read the cartridge page directly to save
-    // multiple copy operations every time the mapper changes pages
-    if (address >= 0 && address < SLOT1_BASE) {
-        // Read from SLOT0
-        int page = slotx_page(0);
-        return m_cart[address + (page * CART_PAGE_SIZE)];
-    } else if (address >= SLOT1_BASE && address < SLOT2_BASE) {
-        // Read from SLOT1
-        int page = slotx_page(1);
-        uint16_t offset_address = address + (page * CART_PAGE_SIZE);
-        return  m_cart[offset_address - SLOT1_BASE];
-    } else if (address >= SLOT2_BASE && address < RAM_BASE) {
-        // Read from SLOT2
-        if(is_slot2_ram()) {
-            return m_cart_ram[slot2_ram_bank()][address - SLOT2_BASE];
-        } else {
-            int page = slotx_page(2);
-            uint16_t offset_address = address + (page * CART_PAGE_SIZE);
-            return  m_cart[offset_address - SLOT2_BASE];
-        }
-    }
-
-    // Read from non-mirrored RAM instead of the mapper control registers
-    // In write(), we don't mirror the last 4 bytes because weird things can happen when registers are overwritten
-    if (address >= 0xfffc) {
-        return m_mem[address - RAM_OFFSET];
-    }
-
-    return m_mem[address];
+    return is_bit_set(m_ram_control, 2) ? 1 : 0;
 }
 
-int Memory::slotx_page(int slot) {
+template<typename Mapper>
+int Memory::slotx_page(int slot) const {
     // https://www.smspower.org/Development/Mappers#ROMMapping
-    // The significant bits in the bank selection register used to select the page differ on the size of the cartridge
-    uint8_t sig_bits = m_cart.size() > SLOT2_BASE ? 0x3F : 0x1F;
-
-    // The control registers differ on whether we're using a Codemasters or SEGA mapper
-    if(m_codemasters) {
-        switch (slot) {
-            case 0:
-                return m_mem[SLOT0_BASE] & sig_bits;
-            case 1:
-                return m_mem[SLOT1_BASE] & sig_bits;
-            case 2:
-                return m_mem[SLOT2_BASE] & sig_bits;
-            default:
-                return -1;
-        }
-    } else {
-        switch (slot) {
-            case 0:
-                return m_mem[MAPPER_SLOT0_CONTROL_R] & sig_bits;
-            case 1:
-                return m_mem[MAPPER_SLOT1_CONTROL_R] & sig_bits;
-            case 2:
-                return m_mem[MAPPER_SLOT2_CONTROL_R] & sig_bits;
-            default:
-                return -1;
-        }
-    }
-
-}
-
-uint16_t Memory::read_word(const uint16_t &base_address) {
-    uint16_t hi = read(base_address + 1) << 8;
-    uint16_t lo = read(base_address);
-    uint16_t data = hi | lo;
-
-    return data;
+    // Only as many bits of the bank selection register as are needed to address the whole cartridge are used, which
+    // mirrors smaller cartridges across the whole page range
+    return m_slot_control[slot] & m_rom_page_mask;
 }
 
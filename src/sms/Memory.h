@@ -5,6 +5,8 @@
 #ifndef SOMOS_MEMORY_H
 #define SOMOS_MEMORY_H
 
+#include "Mapper.h"
+
 #include <vector>
 #include <array>
 #include <cstdint>
@@ -15,24 +17,50 @@ constexpr uint16_t SLOT1_BASE = 0x4000;
 constexpr uint16_t SLOT2_BASE = 0x8000;
 constexpr uint16_t RAM_BASE = 0xc000;
 constexpr uint16_t RAM_MIRROR_BASE = 0xe000;
-constexpr uint16_t RAM_OFFSET = RAM_MIRROR_BASE - RAM_BASE;
-
-// Registers memory address
-constexpr uint16_t MAPPER_RAM_CONTROL_R = 0xfffc;
-constexpr uint16_t MAPPER_SLOT0_CONTROL_R = 0xfffd;
-constexpr uint16_t MAPPER_SLOT1_CONTROL_R = 0xfffe;
-constexpr uint16_t MAPPER_SLOT2_CONTROL_R = 0xffff;
+constexpr uint16_t RAM_SIZE = RAM_MIRROR_BASE - RAM_BASE;
 
 constexpr int CART_PAGE_SIZE = 0x4000;
 
+// The CPU address space is split in 1KB pages, the smallest block the mappers handle (the un-paged start of slot 0)
+constexpr int MEMORY_PAGE_SHIFT = 10;
+constexpr int MEMORY_PAGE_SIZE = 1 << MEMORY_PAGE_SHIFT;
+constexpr int MEMORY_PAGE_COUNT = 0x10000 >> MEMORY_PAGE_SHIFT;
+
 class Memory {
 public:
+    Memory();
+
+    // The Z80 reads and writes memory for nearly every instruction, so these are defined inline. Only writes that
+    // reach a mapper register or code that has been decoded leave the fast path
     void write(uint16_t address, uint8_t data);
-    uint8_t read(const uint16_t& address);
-    uint16_t read_word(const uint16_t& base_address);
+    uint8_t read(uint16_t address) const;
+    uint16_t read_word(uint16_t address) const;
 
-    void load_cartridge(std::vector<uint8_t> rom_file);
-    std::vector<uint8_t> dump_cartridge_data();
+    /**
+     * Writes a 16-bit value in little endian, low byte first
+     */
+    void write_word(uint16_t address, uint16_t data);
+
+    /**
+     * Loads a cartridge and sets up the memory map for its mapper. System RAM and cartridge RAM are cleared
+     * @param rom_file The cartridge ROM, with or without the 512 byte dump header
+     * @param mapper The mapper used by the cartridge. AUTO detects Codemasters cartridges from their header, uses no
+     * mapper for cartridges of 32KB or less and the SEGA mapper otherwise. The Korean mapper can not be detected and
+     * has to be requested explicitly
+     */
+    void load_cartridge(const std::vector<uint8_t>& rom_file, MapperType mapper = MapperType::AUTO);
+
+    /**
+     * Copies an image into 64KB of RAM that covers the whole address space, instead of loading a cartridge. There are
+     * no mapper registers and no mirror. Not something the console can do, it lets the CPU be tested on its own
+     * without the memory map getting in the way
+     */
+    void load_ram_image(const std::vector<uint8_t>& image);
+
+    /**
+     * @return The loaded cartridge, without the dump header
+     */
+    const std::vector<uint8_t>& dump_cartridge_data() const;
 
     void reset();
 
@@ -40,28 +68,211 @@ public:
      * Check if the loaded cartridge is a Codemasters game. This is required because Codemasters use their own
      * memory mapper
      */
-    void check_codemasters();
+    bool check_codemasters() const;
+
+    MapperType get_mapper() const;
+
+    /**
+     * Translates a CPU address into a physical address, which identifies the same byte of ROM or RAM no matter how
+     * the mapper is set up. Cartridge ROM comes first, followed by system RAM and then cartridge RAM
+     */
+    uint32_t physical_address(uint16_t address) const;
+
+    /**
+     * @return Whether the physical address is in cartridge ROM, which the running code can't change
+     */
+    bool is_rom(uint32_t physical_address) const;
+
+    /**
+     * Asks for writes to the 1KB physical page containing this address to be tracked. The Z80 uses this for pages of
+     * RAM that it has decoded code from
+     */
+    void watch_code(uint32_t physical_address);
+
+    /**
+     * @return The generation of the physical page containing the address. It changes when a watched page is written
+     * to and when a cartridge is loaded
+     */
+    uint32_t page_generation(uint32_t physical_address) const;
+
+    /**
+     * @return A counter that changes every time the memory map or the contents of a watched page change
+     */
+    uint32_t code_generation() const;
+
+    /**
+     * @return The number of writes made so far, used by the Z80 to check that a loop has no side effects
+     */
+    uint32_t write_count() const;
+
+    /**
+     * Gets direct access to a range of memory for block transfers
+     * @param address The lowest address of the range
+     * @param count The number of bytes
+     * @return Pointer to the first byte, or nullptr if the range isn't in a single page
+     */
+    const uint8_t* read_span(uint16_t address, int count) const;
+
+    /**
+     * Same as read_span, for writing. Also fails for ROM, mapper registers and pages that contain decoded code, as
+     * writes to those have to go through write(). The bytes are counted as written
+     */
+    uint8_t* write_span(uint16_t address, int count);
 private:
-    std::array<uint8_t, 0x10000> m_mem;
+    // System RAM. It is mapped at both RAM_BASE and RAM_MIRROR_BASE, so there is a single copy of every byte
+    std::array<uint8_t, RAM_SIZE> m_ram{};
     std::vector<uint8_t> m_cart;
-    std::array<std::array<uint8_t, 0x4000>, 2> m_cart_ram;
-    bool m_codemasters{false};
+    std::array<std::array<uint8_t, 0x4000>, 2> m_cart_ram{};
+    MapperType m_mapper{MapperType::NONE};
+
+    // Latched values of the mapper control registers. The SEGA registers also write through to RAM, but the mapper
+    // only ever reads these copies
+    uint8_t m_ram_control{0};
+    std::array<uint8_t, 3> m_slot_control{};
+
+    // Implementations specialised on the mapper of the loaded cartridge, chosen once in load_cartridge()
+    void (Memory::*m_write_handler)(uint16_t, uint8_t){nullptr};
+    void (Memory::*m_reset_handler)(){nullptr};
+
+    // Cartridge ROM as it is mapped into the address space, padded to a power of two number of pages so that the
+    // page number written to a mapper register only needs to be masked
+    std::vector<uint8_t> m_rom;
+    int m_rom_page_mask{0};
+
+    // 64KB of RAM covering the whole address space, only allocated by load_ram_image()
+    std::vector<uint8_t> m_flat_ram;
+
+    // Host memory backing each 1KB page of the address space. Write pages are nullptr when the page is read only
+    std::array<const uint8_t*, MEMORY_PAGE_COUNT> m_read_pages{};
+    std::array<uint8_t*, MEMORY_PAGE_COUNT> m_write_pages{};
+
+    // Write pages that can be written to straight away, nullptr when the page is read only, tracked or contains a
+    // mapper register of the current mapper
+    std::array<uint8_t*, MEMORY_PAGE_COUNT> m_direct_write_pages{};
+    std::array<bool, MEMORY_PAGE_COUNT> m_register_pages{};
+
+    // Physical address of each 1KB page of the address space, and whether writes to it have to be tracked
+    std::array<uint32_t, MEMORY_PAGE_COUNT> m_physical_pages{};
+    std::array<bool, MEMORY_PAGE_COUNT> m_watched_pages{};
+
+    // Generation of every 1KB physical page and whether its writes are tracked. Generations are taken from
+    // m_code_generation, so a value is never reused and a page that was changed can't look unchanged
+    std::vector<uint32_t> m_page_generation;
+    std::vector<uint8_t> m_code_pages;
+    uint32_t m_code_generation{0};
+
+    uint32_t m_write_count{0};
+
+    uint32_t physical_of(const uint8_t* host) const;
 
-    bool is_slot2_ram();
+    /**
+     * Loads a cartridge, or a RAM image when ram_image is set, see load_cartridge() and load_ram_image()
+     */
+    void load(const std::vector<uint8_t>& rom_file, MapperType mapper, bool ram_image);
+
+    /**
+     * Writes that don't take the fast path: read only pages, mapper registers and tracked pages
+     */
+    void write_slow(uint16_t address, uint8_t data);
+
+    void update_direct_write_page(int page);
+
+    /**
+     * Recomputes which pages of the address space map the given physical page for writing and need to be tracked
+     */
+    void update_watched_pages(uint32_t physical_page);
+
+    /**
+     * Called when a tracked page is written to
+     */
+    void invalidate_code(uint16_t address);
+
+    template<typename Mapper>
+    void use_mapper(MapperType type);
+
+    template<typename Mapper>
+    void write_mapped(uint16_t address, uint8_t data);
+
+    template<typename Mapper>
+    void reset_mapped();
+
+    /**
+     * Rebuilds the read and write page tables from the mapper control registers. This needs to be called every time
+     * one of the mapper registers is written
+     */
+    template<typename Mapper>
+    void update_page_tables();
+
+    /**
+     * Points the pages in [base, base + size) at consecutive pages of host memory
+     * @param base CPU address of the first page, must be aligned to MEMORY_PAGE_SIZE
+     * @param size Size of the region in bytes, must be a multiple of MEMORY_PAGE_SIZE
+     * @param read Host memory the region is read from
+     * @param write Host memory the region is written to, or nullptr if the region is read only
+     */
+    void map_pages(uint16_t base, int size, const uint8_t* read, uint8_t* write);
+
+    /**
+     * Check if cartridge RAM is mapped to slot2. Only valid for mappers with a RAM control register
+     */
+    bool is_slot2_ram() const;
     /**
      * Finds the current cartridge RAM bank that is assigned to slot2
      * WARNING: This value is junk if slot2 is currently mapped to a ROM page
      * @return 0 or 1 for the RAM bank that is mapped to slot2
      */
-    int slot2_ram_bank();
+    int slot2_ram_bank() const;
 
     /**
      * Get the page number for the cartridge ROM assigned to the given slot
      * @param slot the slot number (options: 0, 1, 2)
      * @return The number of the cartridge ROM page
      */
-    int slotx_page(int slot);
+    template<typename Mapper>
+    int slotx_page(int slot) const;
 };
 
 
+// The block cache looks these up for every block and instruction it runs, so they are defined inline
+inline uint32_t Memory::physical_address(uint16_t address) const {
+    return m_physical_pages[address >> MEMORY_PAGE_SHIFT] + (address & (MEMORY_PAGE_SIZE - 1));
+}
+
+inline uint8_t Memory::read(uint16_t address) const {
+    // Because Cartridge ROM is mapped to Slots 0,1 and maybe 2, the page tables point straight into the cartridge
+    // pages to save multiple copy operations every time the mapper changes pages
+    return m_read_pages[address >> MEMORY_PAGE_SHIFT][address & (MEMORY_PAGE_SIZE - 1)];
+}
+
+inline uint16_t Memory::read_word(uint16_t address) const {
+    return read(address) | (read(address + 1) << 8);
+}
+
+inline void Memory::write(uint16_t address, uint8_t data) {
+    uint8_t* page = m_direct_write_pages[address >> MEMORY_PAGE_SHIFT];
+    if (page != nullptr) {
+        m_write_count++;
+        page[address & (MEMORY_PAGE_SIZE - 1)] = data;
+    } else {
+        write_slow(address, data);
+    }
+}
+
+inline void Memory::write_word(uint16_t address, uint16_t data) {
+    write(address, data & 0xFF);
+    write(address + 1, data >> 8);
+}
+
+inline uint32_t Memory::page_generation(uint32_t physical_address) const {
+    return m_page_generation[physical_address >> MEMORY_PAGE_SHIFT];
+}
+
+inline uint32_t Memory::code_generation() const {
+    return m_code_generation;
+}
+
+inline uint32_t Memory::write_count() const {
+    return m_write_count;
+}
+
 #endif //SOMOS_MEMORY_H
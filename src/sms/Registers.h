@@ -86,5 +86,9 @@ enum FLAGS {
     SIGN_S = 7
 };
 
+constexpr uint8_t flag_mask(FLAGS flag) {
+    return 1 << flag;
+}
+
 
 #endif //SOMOS_REGISTERS_H
@@ -3,18 +3,24 @@
 //
 
 #include "SMS.h"
+#include "Aot.h"
 
 
-SMS::SMS() : m_cpu(&m_memory), m_fps(60) {
+SMS::SMS() : m_cpu(&m_memory, &m_io), m_vdp(&m_cpu) {
+    m_vdp.attach(m_io);
+    m_io.attach_read<&SMS::read_controllers>(PortFunction::IO_PORT_AB, this);
+    m_io.attach_read<&SMS::read_controllers>(PortFunction::IO_PORT_B_MISC, this);
+    reset();
 }
 
-void SMS::load_cartridge(std::vector<uint8_t> rom_file) {
+void SMS::load_cartridge(const std::vector<uint8_t> &rom_file, MapperType mapper) {
     reset();
-    m_memory.load_cartridge(rom_file);
+    m_memory.load_cartridge(rom_file, mapper);
+    m_cpu.set_aot_program(find_aot_program(m_memory.dump_cartridge_data()));
     m_cart_loaded = true;
 }
 
-std::vector<uint8_t> SMS::dump_cartridge_data() {
+const std::vector<uint8_t>& SMS::dump_cartridge_data() const {
     return m_memory.dump_cartridge_data();
 }
 
@@ -25,14 +31,76 @@ bool SMS::cart_loaded() const {
 void SMS::reset() {
     m_memory.reset();
     m_cpu.reset();
+    m_vdp.reset();
+
+    m_scheduler.reset();
+    m_frame = 0;
+    m_line = 0;
+    m_vdp.start_line(m_line);
+    m_scheduler.schedule(EventType::LINE, CYCLES_PER_LINE);
+}
+
+void SMS::press_pause() {
+    m_cpu.trigger_nmi();
+}
+
+uint64_t SMS::get_clock() const {
+    return m_scheduler.now();
+}
+
+int SMS::get_line() const {
+    return m_line;
+}
+
+const Framebuffer& SMS::get_framebuffer() const {
+    return m_vdp.get_framebuffer();
+}
+
+const std::array<uint8_t, CRAM_SIZE>& SMS::get_cram() const {
+    return m_vdp.get_cram();
 }
 
 void SMS::update() {
-    unsigned long int cpu_cycles_this_frame = CPU_CLOCK / m_fps;
-    unsigned long int cpu_cycles = 0;
+    m_frame++;
+    m_scheduler.schedule(EventType::FRAME_END, m_frame * CYCLES_PER_FRAME);
 
-    while(cpu_cycles < cpu_cycles_this_frame) {
-        m_cpu.step();
-        cpu_cycles += m_cpu.get_cycles();
+    bool frame_done = false;
+    while (!frame_done) {
+        // The CPU can overshoot the deadline by part of an instruction, the clock keeps the exact count
+        uint64_t deadline = m_scheduler.next_deadline();
+        if (deadline > m_scheduler.now()) {
+            m_scheduler.advance(m_cpu.run(deadline - m_scheduler.now()));
+        }
+
+        Event event{};
+        while (m_scheduler.pop_due(event)) {
+            frame_done |= event.type == EventType::FRAME_END;
+            handle_event(event);
+        }
     }
 }
+
+void SMS::handle_event(const Event &event) {
+    switch (event.type) {
+        case EventType::FRAME_END:
+            break;
+        case EventType::LINE:
+            // Scheduled from the cycle the line was due rather than the current one, so lines never drift
+            m_vdp.end_line();
+            m_line = (m_line + 1) % LINES_PER_FRAME;
+            m_vdp.start_line(m_line);
+            m_scheduler.schedule(EventType::LINE, event.cycle + CYCLES_PER_LINE);
+            if (m_line == ACTIVE_LINES) {
+                m_scheduler.schedule(EventType::VBLANK, event.cycle);
+            }
+            break;
+        case EventType::VBLANK:
+            m_vdp.start_vblank();
+            break;
+    }
+}
+
+uint8_t SMS::read_controllers(uint8_t) {
+    // The inputs are active low, nothing is pressed yet
+    return 0xFF;
+}
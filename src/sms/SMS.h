@@ -5,7 +5,10 @@
 #ifndef SOMOS_SMS_H
 #define SOMOS_SMS_H
 
+#include "IoBus.h"
 #include "Memory.h"
+#include "Scheduler.h"
+#include "Vdp.h"
 #include "Z80.h"
 
 #include <vector>
@@ -13,20 +16,73 @@
 
 constexpr unsigned long CPU_CLOCK = 3579545;
 
+// NTSC video timing, in CPU cycles and lines
+// https://www.smspower.org/Development/Timing
+constexpr unsigned long CYCLES_PER_LINE = 228;
+constexpr int LINES_PER_FRAME = 262;
+constexpr unsigned long CYCLES_PER_FRAME = LINES_PER_FRAME * CYCLES_PER_LINE;
+constexpr int ACTIVE_LINES = 192;
+
 class SMS {
 public:
     SMS();
 
-    void load_cartridge(std::vector<uint8_t> rom_file);
-    std::vector<uint8_t> dump_cartridge_data();
+    /**
+     * Loads a cartridge. If a translation of it was built into the emulator (see Aot.h) the CPU runs it
+     */
+    void load_cartridge(const std::vector<uint8_t>& rom_file, MapperType mapper = MapperType::AUTO);
+    const std::vector<uint8_t>& dump_cartridge_data() const;
     bool cart_loaded() const;
 
+    /**
+     * Runs the system for one frame. The CPU only stops for the events in the scheduler. Frames end when the VDP
+     * wraps back to line 0, at exact multiples of CYCLES_PER_FRAME, so any overshoot is taken off the next frame and
+     * the framebuffer always holds a whole frame
+     */
     void update();
     void reset();
+
+    /**
+     * Presses the pause button, which is wired to the non-maskable interrupt
+     */
+    void press_pause();
+
+    /**
+     * @return The master clock, in CPU cycles since the last reset
+     */
+    uint64_t get_clock() const;
+
+    /**
+     * @return The scanline being drawn
+     */
+    int get_line() const;
+
+    /**
+     * @return The last frame the VDP drew, as CRAM entries (see Vdp::to_rgb). It is updated in place, line by line
+     */
+    const Framebuffer& get_framebuffer() const;
+
+    /**
+     * @return The current palette
+     */
+    const std::array<uint8_t, CRAM_SIZE>& get_cram() const;
 private:
     Memory m_memory;
+    IoBus m_io;
     Z80 m_cpu;
-    int m_fps;
+    Vdp m_vdp;
+    Scheduler m_scheduler;
+
+    // Frames run since the last reset and the current scanline
+    uint64_t m_frame{0};
+    int m_line{0};
+
+    void handle_event(const Event& event);
+
+    /**
+     * Port handlers of the devices that are part of the console itself
+     */
+    uint8_t read_controllers(uint8_t port);
 
     bool m_cart_loaded{false};
 };
@@ -0,0 +1,99 @@
+/**
+ * SCHEDULER
+ *
+ * Keeps the master clock of the system and the deadlines of the events that the components are waiting for
+ */
+
+#include "Scheduler.h"
+
+#include <limits>
+#include <utility>
+
+static bool before(const Event& a, const Event& b) {
+    return a.cycle < b.cycle || (a.cycle == b.cycle && a.type < b.type);
+}
+
+uint64_t Scheduler::now() const {
+    return m_now;
+}
+
+void Scheduler::advance(uint64_t cycles) {
+    m_now += cycles;
+}
+
+void Scheduler::schedule(EventType type, uint64_t cycle) {
+    cancel(type);
+
+    m_heap[m_size] = Event{cycle, type};
+    m_size++;
+    sift_up(m_size - 1);
+}
+
+void Scheduler::cancel(EventType type) {
+    for (int i = 0; i < m_size; i++) {
+        if (m_heap[i].type == type) {
+            m_size--;
+            if (i != m_size) {
+                // The last event takes the place of the cancelled one and can belong either above or below it
+                m_heap[i] = m_heap[m_size];
+                sift_up(i);
+                sift_down(i);
+            }
+            return;
+        }
+    }
+}
+
+uint64_t Scheduler::next_deadline() const {
+    return m_size > 0 ? m_heap[0].cycle : std::numeric_limits<uint64_t>::max();
+}
+
+bool Scheduler::pop_due(Event &event) {
+    if (m_size == 0 || m_heap[0].cycle > m_now) {
+        return false;
+    }
+
+    event = m_heap[0];
+    m_size--;
+    m_heap[0] = m_heap[m_size];
+    sift_down(0);
+
+    return true;
+}
+
+void Scheduler::reset() {
+    m_now = 0;
+    m_size = 0;
+}
+
+void Scheduler::sift_up(int index) {
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!before(m_heap[index], m_heap[parent])) {
+            break;
+        }
+        std::swap(m_heap[index], m_heap[parent]);
+        index = parent;
+    }
+}
+
+void Scheduler::sift_down(int index) {
+    while (true) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+
+        if (left < m_size && before(m_heap[left], m_heap[smallest])) {
+            smallest = left;
+        }
+        if (right < m_size && before(m_heap[right], m_heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+
+        std::swap(m_heap[index], m_heap[smallest]);
+        index = smallest;
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * SCHEDULER
+ *
+ * Keeps the master clock of the system and the deadlines of the events that the components are waiting for. The CPU
+ * runs uninterrupted up to the next deadline, so the rest of the system only gets control when something is due
+ */
+
+#ifndef SOMOS_SCHEDULER_H
+#define SOMOS_SCHEDULER_H
+
+#include <array>
+#include <cstdint>
+
+enum class EventType : uint8_t {
+    // End of the frame started by SMS::update
+    FRAME_END,
+    // Start of a new scanline
+    LINE,
+    // The VDP reached the first line of the vertical blanking period
+    VBLANK,
+};
+
+// Number of event types. Each type can only be scheduled once, so this is also the capacity of the queue
+constexpr int EVENT_TYPE_COUNT = 3;
+
+struct Event {
+    uint64_t cycle;
+    EventType type;
+};
+
+class Scheduler {
+public:
+    /**
+     * @return The master clock, in CPU cycles since the last reset
+     */
+    uint64_t now() const;
+
+    /**
+     * Moves the clock forwards, e.g. after the CPU has run
+     * @param cycles The number of cycles that have passed
+     */
+    void advance(uint64_t cycles);
+
+    /**
+     * Schedules an event, replacing any pending event of the same type
+     * @param type The type of event
+     * @param cycle Absolute cycle at which the event is due
+     */
+    void schedule(EventType type, uint64_t cycle);
+
+    /**
+     * Removes the pending event of this type, if there is one
+     */
+    void cancel(EventType type);
+
+    /**
+     * @return The cycle of the earliest pending event, or UINT64_MAX if there is none
+     */
+    uint64_t next_deadline() const;
+
+    /**
+     * Removes the earliest event if it is due
+     * @param event Set to the event that is due
+     * @return Whether an event was due
+     */
+    bool pop_due(Event& event);
+
+    /**
+     * Sets the clock to 0 and removes every pending event
+     */
+    void reset();
+
+private:
+    uint64_t m_now{0};
+
+    // Binary min-heap on the cycle of the events. Ties are broken by type so that the order is deterministic
+    std::array<Event, EVENT_TYPE_COUNT> m_heap{};
+    int m_size{0};
+
+    void sift_up(int index);
+
+    void sift_down(int index);
+};
+
+#endif //SOMOS_SCHEDULER_H
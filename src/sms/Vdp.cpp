@@ -0,0 +1,453 @@
+/**
+ * VDP
+ *
+ * Video display processor of the SMS, in mode 4
+ */
+
+#include "Vdp.h"
+#include "Z80.h"
+
+#include <algorithm>
+
+// FNV-1a, over whole values rather than bytes
+constexpr uint64_t FINGERPRINT_BASIS = 0xCBF29CE484222325;
+constexpr uint64_t FINGERPRINT_PRIME = 0x100000001B3;
+
+static uint64_t fingerprint(uint64_t hash, uint64_t value) {
+    return (hash ^ value) * FINGERPRINT_PRIME;
+}
+
+Vdp::Vdp(Z80* cpu) : m_cpu(cpu), m_compose(get_line_compositor(best_compositor_kernel())) {
+}
+
+void Vdp::reset() {
+    m_vram.fill(0);
+    m_cram.fill(0);
+    m_registers.fill(0);
+    m_address = 0;
+    m_code = 0;
+    m_control_latch = 0;
+    m_control_pending = false;
+    m_read_buffer = 0;
+    m_status = 0;
+    m_line_interrupt = false;
+    m_line_counter = 0;
+    m_line = 0;
+    m_vertical_scroll = 0;
+    m_framebuffer.fill(0);
+    // Blank VRAM decodes to colour 0 everywhere
+    for (int tile = 0; tile < TILE_COUNT; tile++) {
+        m_tiles[tile].fill(0);
+        m_flipped_tiles[tile].fill(0);
+    }
+    m_dirty_tiles.fill(0);
+    m_sprite_lists_dirty.fill(true);
+    m_tile_versions.fill(0);
+    m_cram_version = 0;
+    m_line_drawn.fill(false);
+    m_rendered_lines = 0;
+    update_irq();
+}
+
+void Vdp::attach(IoBus& io) {
+    // Reading the data port moves on to the next address. Reading the control port clears the status flags, but
+    // nothing sets them again before the next line, so a loop polling it is still idle
+    io.attach_read<&Vdp::read_data>(PortFunction::VDP_DATA, this, true);
+    io.attach_write<&Vdp::write_data>(PortFunction::VDP_DATA, this);
+    io.attach_read<&Vdp::read_control>(PortFunction::VDP_CONTROL, this);
+    io.attach_write<&Vdp::write_control>(PortFunction::VDP_CONTROL, this);
+    io.attach_read<&Vdp::read_v_counter>(PortFunction::V_COUNTER, this);
+    io.attach_read<&Vdp::read_h_counter>(PortFunction::H_COUNTER, this);
+}
+
+void Vdp::start_line(int line) {
+    m_line = line;
+    if (line == 0) {
+        m_vertical_scroll = m_registers[9];
+    }
+
+    // The line counter counts down on every active line and the one after them, and is reloaded on every other line.
+    // Going past 0 reloads it and raises the line interrupt
+    if (line <= SCREEN_HEIGHT) {
+        if (m_line_counter == 0) {
+            m_line_counter = m_registers[10];
+            m_line_interrupt = true;
+            update_irq();
+        } else {
+            m_line_counter--;
+        }
+    } else {
+        m_line_counter = m_registers[10];
+    }
+}
+
+void Vdp::end_line() {
+    if (m_line < SCREEN_HEIGHT) {
+        render_line(m_line);
+    }
+}
+
+void Vdp::start_vblank() {
+    m_status |= VDP_STATUS_FRAME_INTERRUPT;
+    update_irq();
+}
+
+const Framebuffer& Vdp::get_framebuffer() const {
+    return m_framebuffer;
+}
+
+const std::array<uint8_t, CRAM_SIZE>& Vdp::get_cram() const {
+    return m_cram;
+}
+
+uint64_t Vdp::rendered_line_count() const {
+    return m_rendered_lines;
+}
+
+uint32_t Vdp::to_rgb(uint8_t color) {
+    // Each 2 bit channel is spread over 8 bits, so 3 is full intensity
+    uint32_t red = (color & 0x03) * 0x55;
+    uint32_t green = ((color >> 2) & 0x03) * 0x55;
+    uint32_t blue = ((color >> 4) & 0x03) * 0x55;
+
+    return (red << 16) | (green << 8) | blue;
+}
+
+uint8_t Vdp::read_data(uint8_t) {
+    // Reads come from a buffer that is refilled from the next address, so the data is one read behind
+    m_control_pending = false;
+    uint8_t value = m_read_buffer;
+    m_read_buffer = m_vram[m_address];
+    m_address = (m_address + 1) & (VRAM_SIZE - 1);
+
+    return value;
+}
+
+void Vdp::write_data(uint8_t, uint8_t value) {
+    m_control_pending = false;
+    if (m_code == 3) {
+        if (m_cram[m_address & (CRAM_SIZE - 1)] != value) {
+            m_cram[m_address & (CRAM_SIZE - 1)] = value;
+            m_cram_version++;
+        }
+    } else if (m_vram[m_address] != value) {
+        if (m_address >= sprite_table() && m_address < sprite_table() + SPRITE_COUNT) {
+            uint8_t y = m_vram[m_address];
+            if (y == SPRITE_TERMINATOR || value == SPRITE_TERMINATOR) {
+                // Moving the terminator shows or hides every sprite after it
+                m_sprite_lists_dirty.fill(true);
+            } else {
+                invalidate_sprite_lines(y);
+                invalidate_sprite_lines(value);
+            }
+        }
+        m_vram[m_address] = value;
+        int tile = m_address >> 5;
+        m_dirty_tiles[tile >> 6] |= uint64_t{1} << (tile & 63);
+        m_tile_versions[tile]++;
+    }
+    m_read_buffer = value;
+    m_address = (m_address + 1) & (VRAM_SIZE - 1);
+}
+
+uint8_t Vdp::read_control(uint8_t) {
+    // Reading the status clears it, along with the pending interrupts
+    uint8_t status = m_status;
+    m_status = 0;
+    m_line_interrupt = false;
+    m_control_pending = false;
+    update_irq();
+
+    return status;
+}
+
+void Vdp::write_control(uint8_t, uint8_t value) {
+    if (!m_control_pending) {
+        // The first byte goes straight into the low byte of the address
+        m_control_latch = value;
+        m_control_pending = true;
+        m_address = (m_address & 0x3F00) | value;
+        return;
+    }
+
+    m_control_pending = false;
+    m_code = value >> 6;
+    m_address = ((value & 0x3F) << 8) | m_control_latch;
+
+    switch (m_code) {
+        case 0:
+            // VRAM read, the buffer is filled straight away
+            m_read_buffer = m_vram[m_address];
+            m_address = (m_address + 1) & (VRAM_SIZE - 1);
+            break;
+        case 2:
+            if ((value & 0x0F) < VDP_REGISTER_COUNT) {
+                int reg = value & 0x0F;
+                // The sprite size and zoom bits of register 1, and the sprite table address
+                bool sprites_changed = ((m_registers[reg] ^ m_control_latch) & (reg == 1 ? 0x03 : 0xFF)) != 0;
+                if (sprites_changed && (reg == 1 || reg == 5)) {
+                    m_sprite_lists_dirty.fill(true);
+                }
+                m_registers[reg] = m_control_latch;
+                update_irq();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+uint8_t Vdp::read_v_counter(uint8_t) {
+    // The NTSC counter runs from 0x00 to 0xDA, then jumps back to 0xD5 so that the last line reads 0xFF
+    return m_line <= 0xDA ? m_line : m_line - 6;
+}
+
+uint8_t Vdp::read_h_counter(uint8_t) {
+    // The H counter is only latched through the controller ports' TH lines, which nothing drives yet
+    return 0;
+}
+
+void Vdp::update_irq() {
+    bool frame = (m_status & VDP_STATUS_FRAME_INTERRUPT) && (m_registers[1] & 0x20);
+    bool line = m_line_interrupt && (m_registers[0] & 0x10);
+
+    if (m_cpu != nullptr) {
+        m_cpu->set_irq_line(frame || line);
+    }
+}
+
+void Vdp::render_line(int line) {
+    uint8_t* out = &m_framebuffer[line * SCREEN_WIDTH];
+    uint8_t backdrop = m_cram[16 + (m_registers[7] & 0x0F)];
+
+    // Blanked display
+    if (!(m_registers[1] & 0x40)) {
+        std::fill(out, out + SCREEN_WIDTH, backdrop);
+        m_line_drawn[line] = false;
+        return;
+    }
+
+    // Nothing the line shows has changed since it was drawn
+    uint64_t hash = line_fingerprint(line);
+    if (m_line_drawn[line] && m_line_fingerprints[line] == hash) {
+        if (m_sprite_lists[line].overflow) {
+            m_status |= VDP_STATUS_SPRITE_OVERFLOW;
+        }
+        if (m_line_collisions[line]) {
+            m_status |= VDP_STATUS_SPRITE_COLLISION;
+        }
+        return;
+    }
+
+    update_tiles();
+    render_background(line);
+    render_sprites(line);
+    m_compose(m_background_line.data(), m_priority_line.data(), m_sprite_line.data(), m_cram.data(), out);
+
+    // Register 0 bit 5 hides the leftmost column, which is commonly used to hide the tiles scrolling in
+    if (m_registers[0] & 0x20) {
+        std::fill(out, out + 8, backdrop);
+    }
+
+    m_line_fingerprints[line] = hash;
+    m_line_drawn[line] = true;
+    m_rendered_lines++;
+}
+
+uint64_t Vdp::line_fingerprint(int line) {
+    uint64_t hash = FINGERPRINT_BASIS;
+    // Registers 0 to 8, everything but the vertical scroll, which is latched, and the line counter
+    for (int reg = 0; reg <= 8; reg++) {
+        hash = fingerprint(hash, m_registers[reg]);
+    }
+    hash = fingerprint(hash, m_vertical_scroll);
+    hash = fingerprint(hash, m_cram_version);
+
+    // The name table row of the line, and the unscrolled one when the right columns don't scroll
+    uint16_t name_table = (m_registers[2] & 0x0E) << 10;
+    int rows[2] = {((line + m_vertical_scroll) % 224) >> 3, line >> 3};
+    int row_count = (m_registers[0] & 0x80) ? 2 : 1;
+    for (int r = 0; r < row_count; r++) {
+        const uint8_t* entries = &m_vram[name_table + rows[r] * 64];
+        for (int column = 0; column < 32; column++) {
+            uint16_t entry = entries[column * 2] | (entries[column * 2 + 1] << 8);
+            hash = fingerprint(hash, (uint64_t{m_tile_versions[entry & 0x1FF]} << 16) | entry);
+        }
+    }
+
+    if (m_sprite_lists_dirty[line]) {
+        build_sprite_list(line);
+        m_sprite_lists_dirty[line] = false;
+    }
+    const SpriteList& list = m_sprite_lists[line];
+    uint16_t sat = sprite_table();
+    int pattern_base = (m_registers[6] & 0x04) ? 256 : 0;
+    hash = fingerprint(hash, list.count);
+    for (int n = 0; n < list.count; n++) {
+        int i = list.sprites[n];
+        uint8_t tile = m_vram[sat + 0x81 + i * 2];
+        // Both tiles of the pair, in case the sprites are 8x16
+        uint64_t versions = (uint64_t{m_tile_versions[pattern_base + (tile & 0xFE)]} << 32) |
+                            m_tile_versions[pattern_base + (tile | 0x01)];
+        hash = fingerprint(hash, (m_vram[sat + i] << 16) | (m_vram[sat + 0x80 + i * 2] << 8) | tile);
+        hash = fingerprint(hash, versions);
+    }
+
+    return hash;
+}
+
+void Vdp::render_background(int line) {
+    uint16_t name_table = (m_registers[2] & 0x0E) << 10;
+    // Register 0 bit 6 stops the top two rows from scrolling horizontally, bit 7 the right 8 columns vertically
+    int horizontal_scroll = (m_registers[0] & 0x40) && line < 16 ? 0 : m_registers[8];
+
+    int x = 0;
+    while (x < SCREEN_WIDTH) {
+        int map_x = (x - horizontal_scroll) & (SCREEN_WIDTH - 1);
+        int column = map_x >> 3;
+        int first = map_x & 7;
+        int count = std::min(8 - first, SCREEN_WIDTH - x);
+
+        int vertical_scroll = (m_registers[0] & 0x80) && (x >> 3) >= 24 ? 0 : m_vertical_scroll;
+        // The name table is 28 rows high and wraps around
+        int y = (line + vertical_scroll) % 224;
+
+        uint16_t address = name_table + ((y >> 3) * 32 + column) * 2;
+        uint16_t entry = m_vram[address] | (m_vram[address + 1] << 8);
+        int tile = entry & 0x1FF;
+        bool flip_x = entry & 0x200;
+        bool flip_y = entry & 0x400;
+        uint8_t palette = (entry & 0x800) ? 16 : 0;
+        // Colour 0 of a tile is always behind the sprites
+        uint8_t in_front = (entry & 0x1000) ? 0xFF : 0;
+
+        const uint8_t* pixels = tile_row(tile, flip_y ? 7 - (y & 7) : y & 7, flip_x);
+        for (int i = first; i < first + count; i++, x++) {
+            m_background_line[x] = palette | pixels[i];
+            m_priority_line[x] = pixels[i] != 0 ? in_front : 0;
+        }
+    }
+}
+
+void Vdp::render_sprites(int line) {
+    uint16_t sat = sprite_table();
+    int height = sprite_height();
+    int zoom = (m_registers[1] & 0x01) ? 2 : 1;
+    int pattern_base = (m_registers[6] & 0x04) ? 256 : 0;
+    int shift = (m_registers[0] & 0x08) ? 8 : 0;
+
+    // The list was brought up to date by line_fingerprint
+    const SpriteList& list = m_sprite_lists[line];
+    if (list.overflow) {
+        m_status |= VDP_STATUS_SPRITE_OVERFLOW;
+    }
+
+    // Sprites earlier in the table are in front, so a later one only collides where the layer is already drawn
+    m_sprite_line.fill(0);
+    m_line_collisions[line] = false;
+
+    for (int n = 0; n < list.count; n++) {
+        int i = list.sprites[n];
+        int row = ((line - m_vram[sat + i] - 1) & 0xFF) / zoom;
+        int x = m_vram[sat + 0x80 + i * 2] - shift;
+        int tile = m_vram[sat + 0x81 + i * 2];
+        if (height > 8 * zoom) {
+            tile = (tile & 0xFE) + (row >> 3);
+        }
+
+        const uint8_t* pixels = tile_row(pattern_base + tile, row & 7, false);
+        for (int pixel = 0; pixel < 8 * zoom; pixel++) {
+            int screen_x = x + pixel;
+            uint8_t color = pixels[pixel / zoom];
+            if (screen_x < 0 || screen_x >= SCREEN_WIDTH || color == 0) {
+                continue;
+            }
+
+            if (m_sprite_line[screen_x] != 0) {
+                m_status |= VDP_STATUS_SPRITE_COLLISION;
+                m_line_collisions[line] = true;
+            } else {
+                m_sprite_line[screen_x] = color;
+            }
+        }
+    }
+}
+
+void Vdp::build_sprite_list(int line) {
+    uint16_t sat = sprite_table();
+    int height = sprite_height();
+    SpriteList& list = m_sprite_lists[line];
+    list.count = 0;
+    list.overflow = false;
+
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        uint8_t y = m_vram[sat + i];
+        if (y == SPRITE_TERMINATOR) {
+            break;
+        }
+
+        // Sprites start on the line after their Y coordinate, and wrap around from the bottom of the screen
+        if (((line - y - 1) & 0xFF) >= height) {
+            continue;
+        }
+        if (list.count == SPRITES_PER_LINE) {
+            list.overflow = true;
+            break;
+        }
+        list.sprites[list.count++] = i;
+    }
+}
+
+void Vdp::invalidate_sprite_lines(uint8_t y) {
+    int height = sprite_height();
+    for (int row = 0; row < height; row++) {
+        int line = (y + 1 + row) & 0xFF;
+        if (line < SCREEN_HEIGHT) {
+            m_sprite_lists_dirty[line] = true;
+        }
+    }
+}
+
+uint16_t Vdp::sprite_table() const {
+    return (m_registers[5] & 0x7E) << 7;
+}
+
+int Vdp::sprite_height() const {
+    int height = (m_registers[1] & 0x02) ? 16 : 8;
+    return (m_registers[1] & 0x01) ? height * 2 : height;
+}
+
+void Vdp::update_tiles() {
+    // Whole words are skipped, so a line with nothing new to decode only checks 8 of them
+    for (int word = 0; word < static_cast<int>(m_dirty_tiles.size()); word++) {
+        uint64_t dirty = m_dirty_tiles[word];
+        for (int bit = 0; dirty != 0; bit++, dirty >>= 1) {
+            if (dirty & 1) {
+                decode_tile(word * 64 + bit);
+            }
+        }
+        m_dirty_tiles[word] = 0;
+    }
+}
+
+void Vdp::decode_tile(int tile) {
+    // Every tile is 32 bytes, 4 per row: one byte of each bitplane, with the leftmost pixel in bit 7
+    const uint8_t* planes = &m_vram[tile * 32];
+    DecodedTile& decoded = m_tiles[tile];
+    DecodedTile& flipped = m_flipped_tiles[tile];
+
+    for (int row = 0; row < 8; row++, planes += 4) {
+        for (int x = 0; x < 8; x++) {
+            int bit = 7 - x;
+            uint8_t color = ((planes[0] >> bit) & 1) | (((planes[1] >> bit) & 1) << 1) |
+                            (((planes[2] >> bit) & 1) << 2) | (((planes[3] >> bit) & 1) << 3);
+            decoded[row * 8 + x] = color;
+            flipped[row * 8 + 7 - x] = color;
+        }
+    }
+}
+
+const uint8_t* Vdp::tile_row(int tile, int row, bool flip_x) const {
+    const DecodedTile& decoded = flip_x ? m_flipped_tiles[tile] : m_tiles[tile];
+    return &decoded[row * 8];
+}
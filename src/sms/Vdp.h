@@ -0,0 +1,212 @@
+/**
+ * VDP
+ *
+ * Video display processor of the SMS, in mode 4. The CPU reaches VRAM, CRAM and the registers through the data and
+ * control ports. Lines are rendered one at a time, as the scheduler reaches their end, into a framebuffer of CRAM
+ * entries that lives as long as the VDP. The palette is looked up as each line is drawn, so changes to CRAM in the
+ * middle of a frame show up from the next line
+ * https://www.smspower.org/Development/VDPRegisters
+ */
+
+#ifndef SOMOS_VDP_H
+#define SOMOS_VDP_H
+
+#include "IoBus.h"
+#include "LineCompositor.h"
+
+#include <array>
+#include <cstdint>
+
+class Z80;
+
+constexpr int SCREEN_WIDTH = 256;
+constexpr int SCREEN_HEIGHT = 192;
+
+constexpr int VRAM_SIZE = 0x4000;
+constexpr int CRAM_SIZE = 32;
+constexpr int VDP_REGISTER_COUNT = 11;
+// Every 32 bytes of VRAM are a tile, so both the background and the sprites can use all 512
+constexpr int TILE_COUNT = VRAM_SIZE / 32;
+
+// Status register bits
+constexpr uint8_t VDP_STATUS_FRAME_INTERRUPT = 0x80;
+constexpr uint8_t VDP_STATUS_SPRITE_OVERFLOW = 0x40;
+constexpr uint8_t VDP_STATUS_SPRITE_COLLISION = 0x20;
+
+// Sprites a line can show, the ones after them are dropped and set the overflow flag
+constexpr int SPRITES_PER_LINE = 8;
+constexpr int SPRITE_COUNT = 64;
+// A Y coordinate of 0xD0 ends the sprite attribute table in the 192 line mode
+constexpr uint8_t SPRITE_TERMINATOR = 0xD0;
+
+using Framebuffer = std::array<uint8_t, SCREEN_WIDTH * SCREEN_HEIGHT>;
+
+class Vdp {
+public:
+    /**
+     * @param cpu The CPU whose interrupt line the VDP drives, can be nullptr
+     */
+    explicit Vdp(Z80* cpu = nullptr);
+
+    void reset();
+
+    /**
+     * Attaches the data, control and counter ports to the bus
+     */
+    void attach(IoBus& io);
+
+    /**
+     * Called by the SMS when a line starts, the VDP uses it for the V counter and the line interrupt counter
+     */
+    void start_line(int line);
+
+    /**
+     * Renders the current line, if it is in the active display. Called by the SMS at the end of every line
+     */
+    void end_line();
+
+    /**
+     * Sets the frame interrupt flag. Called by the SMS when the first line of the vertical blanking period starts
+     */
+    void start_vblank();
+
+    const Framebuffer& get_framebuffer() const;
+
+    const std::array<uint8_t, CRAM_SIZE>& get_cram() const;
+
+    /**
+     * @return The number of lines drawn since the last reset, not counting the ones that were left as they were because
+     * nothing they show had changed
+     */
+    uint64_t rendered_line_count() const;
+
+    /**
+     * Converts a CRAM entry (--BBGGRR), as found in the framebuffer, to 0xRRGGBB
+     */
+    static uint32_t to_rgb(uint8_t color);
+
+    // Port handlers
+    uint8_t read_data(uint8_t port);
+    void write_data(uint8_t port, uint8_t value);
+    uint8_t read_control(uint8_t port);
+    void write_control(uint8_t port, uint8_t value);
+    uint8_t read_v_counter(uint8_t port);
+    uint8_t read_h_counter(uint8_t port);
+
+private:
+    Z80* m_cpu;
+
+    std::array<uint8_t, VRAM_SIZE> m_vram{};
+    std::array<uint8_t, CRAM_SIZE> m_cram{};
+    std::array<uint8_t, VDP_REGISTER_COUNT> m_registers{};
+
+    // Access through the ports. A control write is two bytes, the first one is latched until the second arrives
+    uint16_t m_address{0};
+    uint8_t m_code{0};
+    uint8_t m_control_latch{0};
+    bool m_control_pending{false};
+    uint8_t m_read_buffer{0};
+
+    uint8_t m_status{0};
+    bool m_line_interrupt{false};
+    uint8_t m_line_counter{0};
+
+    int m_line{0};
+    // The vertical scroll register only takes effect at the start of a frame
+    uint8_t m_vertical_scroll{0};
+
+    Framebuffer m_framebuffer{};
+
+    // Tiles decoded to one colour (0-15) per byte, row by row, and the same tiles flipped horizontally. VRAM writes only
+    // mark the tiles they touch in the dirty bitmap, and those are decoded again before the next line is rendered
+    using DecodedTile = std::array<uint8_t, 64>;
+    std::array<DecodedTile, TILE_COUNT> m_tiles{};
+    std::array<DecodedTile, TILE_COUNT> m_flipped_tiles{};
+    std::array<uint64_t, TILE_COUNT / 64> m_dirty_tiles{};
+
+    // Layers of the line being rendered, in the format of the compositor
+    std::array<uint8_t, SCREEN_WIDTH> m_background_line{};
+    std::array<uint8_t, SCREEN_WIDTH> m_priority_line{};
+    std::array<uint8_t, SCREEN_WIDTH> m_sprite_line{};
+    LineCompositor m_compose;
+
+    // Sprites shown on each line, in the order of the table, and whether the line had more than it can show
+    struct SpriteList {
+        uint8_t count;
+        bool overflow;
+        std::array<uint8_t, SPRITES_PER_LINE> sprites;
+    };
+    std::array<SpriteList, SCREEN_HEIGHT> m_sprite_lists{};
+    // Lines whose list is out of date. A write to a Y coordinate only affects the lines of the sprite before and after
+    // it, the terminator and the sprite size and table registers affect them all
+    std::array<bool, SCREEN_HEIGHT> m_sprite_lists_dirty{};
+
+    // Every tile and CRAM count their changes, so that a line can tell whether what it shows has changed from a few
+    // numbers rather than by comparing pixels
+    std::array<uint32_t, TILE_COUNT> m_tile_versions{};
+    uint32_t m_cram_version{0};
+
+    // Fingerprint of everything each line was last drawn from, see line_fingerprint. A line with the same fingerprint
+    // is left as it is in the framebuffer, only its sprite flags are raised again
+    std::array<uint64_t, SCREEN_HEIGHT> m_line_fingerprints{};
+    std::array<bool, SCREEN_HEIGHT> m_line_drawn{};
+    std::array<bool, SCREEN_HEIGHT> m_line_collisions{};
+    uint64_t m_rendered_lines{0};
+
+    /**
+     * Sets the CPU's interrupt line from the pending interrupts and their enable bits
+     */
+    void update_irq();
+
+    void render_line(int line);
+
+    /**
+     * Renders the background layer of a line, and the pixels where it covers the sprites
+     */
+    void render_background(int line);
+
+    /**
+     * Hashes the registers, the name table entries and sprites the line uses, the versions of their tiles and the
+     * version of CRAM. Builds the sprite list of the line if it is out of date
+     */
+    uint64_t line_fingerprint(int line);
+
+    /**
+     * Renders the sprite layer of a line, and sets the overflow and collision flags
+     */
+    void render_sprites(int line);
+
+    /**
+     * Finds the sprites shown on a line
+     */
+    void build_sprite_list(int line);
+
+    /**
+     * Marks the lines covered by a sprite at a Y coordinate as needing their list rebuilt
+     */
+    void invalidate_sprite_lines(uint8_t y);
+
+    uint16_t sprite_table() const;
+
+    /**
+     * @return The height of the sprites on screen, in lines
+     */
+    int sprite_height() const;
+
+    /**
+     * Decodes the tiles in the dirty bitmap
+     */
+    void update_tiles();
+
+    /**
+     * Decodes the 4 bitplanes of a tile into both of its cache entries
+     */
+    void decode_tile(int tile);
+
+    /**
+     * @return The 8 colours of a row of a decoded tile
+     */
+    const uint8_t* tile_row(int tile, int row, bool flip_x) const;
+};
+
+#endif //SOMOS_VDP_H
@@ -3,540 +3,44 @@
 //
 
 #include "Z80.h"
-#include "bit_utils.h"
+#include "Z80_Opcodes.h"
+#include "Aot.h"
 
-Z80::Z80(Memory* mem) : m_mem(mem), m_reg(), m_shadow(), m_cycles(0) {
-    setup_opcode_table(m_opcode_table);
-}
+// The threaded interpreter relies on the labels as values extension, which is only available on GCC and Clang
+#if defined(SOMOS_THREADED_INTERPRETER) && (defined(__GNUC__) || defined(__clang__))
+#define SOMOS_Z80_THREADED 1
+#else
+#define SOMOS_Z80_THREADED 0
+#endif
 
-void Z80::setup_opcode_table(std::vector<Opcodes> &table) {
-    // https://www.smspower.org/Development/InstructionSet
-    // https://clrhome.org/table/
-    std::vector<Opcodes> opcodes = {
-            {"nop",        1, [&]() { nop(); }},                                 // 0x00
-            {"ld bc, nn",  3, [&]() { load_16bit(m_reg.BC); }},                  // 0x01
-            {"ld (bc), a", 1, [&]() { write_A_value(m_reg.BC); }},         // 0x02
-            {"inc bc",     1, [&]() { inc_16bit(m_reg.BC); }},         // 0x03
-            {"inc b",      1, [&]() { inc_8bit(m_reg.B); }},         // 0x04
-            {"dec b",      1, [&]() { dec_8bit(m_reg.B); }},         // 0x05
-            {"ld b, n",    2, [&]() { load_8bit(m_reg.B); }},         // 0x06
-            {"rlca",       1, [&]() { rlca(); }},         // 0x07
-            {"ex af, af'", 1, [&]() { ex_16bit_registers(m_reg.AF, m_shadow.AF); }},         // 0x08
-            {"add hl, bc", 1, [&]() { add_HL(m_reg.BC); }},         // 0x09
-            {"ld a, (bc)", 1, [&]() { load_8bit_reg_ptr(m_reg.A, m_reg.BC); }},         // 0x0A
-            {"dec bc",     1, [&]() { dec_16bit(m_reg.BC); }},         // 0x0B
-            {"inc c",      1, [&]() { inc_8bit(m_reg.C); }},         // 0x0C
-            {"dec c",      1, [&]() { dec_8bit(m_reg.C); }},         // 0x0D
-            {"ld c, n",    2, [&]() { load_8bit(m_reg.C); }},         // 0x0E
-            {"rrca",       1, [&]() { rrca(); }},         // 0x0F
-            {"djnz d",     2, [&]() { djnz(); }},         // 0x10
-            {"",           0, [&]() { not_implemented(); }},         // 0x11
-            {"",           0, [&]() { not_implemented(); }},         // 0x12
-            {"",           0, [&]() { not_implemented(); }},         // 0x13
-            {"",           0, [&]() { not_implemented(); }},         // 0x14
-            {"",           0, [&]() { not_implemented(); }},         // 0x15
-            {"",           0, [&]() { not_implemented(); }},         // 0x16
-            {"",           0, [&]() { not_implemented(); }},         // 0x17
-            {"",           0, [&]() { not_implemented(); }},         // 0x18
-            {"",           0, [&]() { not_implemented(); }},         // 0x19
-            {"",           0, [&]() { not_implemented(); }},         // 0x1A
-            {"",           0, [&]() { not_implemented(); }},         // 0x1B
-            {"",           0, [&]() { not_implemented(); }},         // 0x1C
-            {"",           0, [&]() { not_implemented(); }},         // 0x1D
-            {"",           0, [&]() { not_implemented(); }},         // 0x1E
-            {"",           0, [&]() { not_implemented(); }},         // 0x1F
-            {"",           0, [&]() { not_implemented(); }},         // 0x20
-            {"",           0, [&]() { not_implemented(); }},         // 0x21
-            {"",           0, [&]() { not_implemented(); }},         // 0x22
-            {"",           0, [&]() { not_implemented(); }},         // 0x23
-            {"",           0, [&]() { not_implemented(); }},         // 0x24
-            {"",           0, [&]() { not_implemented(); }},         // 0x25
-            {"",           0, [&]() { not_implemented(); }},         // 0x26
-            {"",           0, [&]() { not_implemented(); }},         // 0x27
-            {"",           0, [&]() { not_implemented(); }},         // 0x28
-            {"",           0, [&]() { not_implemented(); }},         // 0x29
-            {"",           0, [&]() { not_implemented(); }},         // 0x2A
-            {"",           0, [&]() { not_implemented(); }},         // 0x2B
-            {"",           0, [&]() { not_implemented(); }},         // 0x2C
-            {"",           0, [&]() { not_implemented(); }},         // 0x2D
-            {"",           0, [&]() { not_implemented(); }},         // 0x2E
-            {"",           0, [&]() { not_implemented(); }},         // 0x2F
-            {"",           0, [&]() { not_implemented(); }},         // 0x30
-            {"",           0, [&]() { not_implemented(); }},         // 0x31
-            {"",           0, [&]() { not_implemented(); }},         // 0x32
-            {"",           0, [&]() { not_implemented(); }},         // 0x33
-            {"",           0, [&]() { not_implemented(); }},         // 0x34
-            {"",           0, [&]() { not_implemented(); }},         // 0x35
-            {"",           0, [&]() { not_implemented(); }},         // 0x36
-            {"",           0, [&]() { not_implemented(); }},         // 0x37
-            {"",           0, [&]() { not_implemented(); }},         // 0x38
-            {"",           0, [&]() { not_implemented(); }},         // 0x39
-            {"",           0, [&]() { not_implemented(); }},         // 0x3A
-            {"",           0, [&]() { not_implemented(); }},         // 0x3B
-            {"",           0, [&]() { not_implemented(); }},         // 0x3C
-            {"",           0, [&]() { not_implemented(); }},         // 0x3D
-            {"",           0, [&]() { not_implemented(); }},         // 0x3E
-            {"",           0, [&]() { not_implemented(); }},         // 0x3F
-            {"",           0, [&]() { not_implemented(); }},         // 0x40
-            {"",           0, [&]() { not_implemented(); }},         // 0x41
-            {"",           0, [&]() { not_implemented(); }},         // 0x42
-            {"",           0, [&]() { not_implemented(); }},         // 0x43
-            {"",           0, [&]() { not_implemented(); }},         // 0x44
-            {"",           0, [&]() { not_implemented(); }},         // 0x45
-            {"",           0, [&]() { not_implemented(); }},         // 0x46
-            {"",           0, [&]() { not_implemented(); }},         // 0x47
-            {"",           0, [&]() { not_implemented(); }},         // 0x48
-            {"",           0, [&]() { not_implemented(); }},         // 0x49
-            {"",           0, [&]() { not_implemented(); }},         // 0x4A
-            {"",           0, [&]() { not_implemented(); }},         // 0x4B
-            {"",           0, [&]() { not_implemented(); }},         // 0x4C
-            {"",           0, [&]() { not_implemented(); }},         // 0x4D
-            {"",           0, [&]() { not_implemented(); }},         // 0x4E
-            {"",           0, [&]() { not_implemented(); }},         // 0x4F
-            {"",           0, [&]() { not_implemented(); }},         // 0x50
-            {"",           0, [&]() { not_implemented(); }},         // 0x51
-            {"",           0, [&]() { not_implemented(); }},         // 0x52
-            {"",           0, [&]() { not_implemented(); }},         // 0x53
-            {"",           0, [&]() { not_implemented(); }},         // 0x54
-            {"",           0, [&]() { not_implemented(); }},         // 0x55
-            {"",           0, [&]() { not_implemented(); }},         // 0x56
-            {"",           0, [&]() { not_implemented(); }},         // 0x57
-            {"",           0, [&]() { not_implemented(); }},         // 0x58
-            {"",           0, [&]() { not_implemented(); }},         // 0x59
-            {"",           0, [&]() { not_implemented(); }},         // 0x5A
-            {"",           0, [&]() { not_implemented(); }},         // 0x5B
-            {"",           0, [&]() { not_implemented(); }},         // 0x5C
-            {"",           0, [&]() { not_implemented(); }},         // 0x5D
-            {"",           0, [&]() { not_implemented(); }},         // 0x5E
-            {"",           0, [&]() { not_implemented(); }},         // 0x5F
-            {"",           0, [&]() { not_implemented(); }},         // 0x60
-            {"",           0, [&]() { not_implemented(); }},         // 0x61
-            {"",           0, [&]() { not_implemented(); }},         // 0x62
-            {"",           0, [&]() { not_implemented(); }},         // 0x63
-            {"",           0, [&]() { not_implemented(); }},         // 0x64
-            {"",           0, [&]() { not_implemented(); }},         // 0x65
-            {"",           0, [&]() { not_implemented(); }},         // 0x66
-            {"",           0, [&]() { not_implemented(); }},         // 0x67
-            {"",           0, [&]() { not_implemented(); }},         // 0x68
-            {"",           0, [&]() { not_implemented(); }},         // 0x69
-            {"",           0, [&]() { not_implemented(); }},         // 0x6A
-            {"",           0, [&]() { not_implemented(); }},         // 0x6B
-            {"",           0, [&]() { not_implemented(); }},         // 0x6C
-            {"",           0, [&]() { not_implemented(); }},         // 0x6D
-            {"",           0, [&]() { not_implemented(); }},         // 0x6E
-            {"",           0, [&]() { not_implemented(); }},         // 0x6F
-            {"",           0, [&]() { not_implemented(); }},         // 0x70
-            {"",           0, [&]() { not_implemented(); }},         // 0x71
-            {"",           0, [&]() { not_implemented(); }},         // 0x72
-            {"",           0, [&]() { not_implemented(); }},         // 0x73
-            {"",           0, [&]() { not_implemented(); }},         // 0x74
-            {"",           0, [&]() { not_implemented(); }},         // 0x75
-            {"",           0, [&]() { not_implemented(); }},         // 0x76
-            {"",           0, [&]() { not_implemented(); }},         // 0x77
-            {"",           0, [&]() { not_implemented(); }},         // 0x78
-            {"",           0, [&]() { not_implemented(); }},         // 0x79
-            {"",           0, [&]() { not_implemented(); }},         // 0x7A
-            {"",           0, [&]() { not_implemented(); }},         // 0x7B
-            {"",           0, [&]() { not_implemented(); }},         // 0x7C
-            {"",           0, [&]() { not_implemented(); }},         // 0x7D
-            {"",           0, [&]() { not_implemented(); }},         // 0x7E
-            {"",           0, [&]() { not_implemented(); }},         // 0x7F
-            {"",           0, [&]() { not_implemented(); }},         // 0x80
-            {"",           0, [&]() { not_implemented(); }},         // 0x81
-            {"",           0, [&]() { not_implemented(); }},         // 0x82
-            {"",           0, [&]() { not_implemented(); }},         // 0x83
-            {"",           0, [&]() { not_implemented(); }},         // 0x84
-            {"",           0, [&]() { not_implemented(); }},         // 0x85
-            {"",           0, [&]() { not_implemented(); }},         // 0x86
-            {"",           0, [&]() { not_implemented(); }},         // 0x87
-            {"",           0, [&]() { not_implemented(); }},         // 0x88
-            {"",           0, [&]() { not_implemented(); }},         // 0x89
-            {"",           0, [&]() { not_implemented(); }},         // 0x8A
-            {"",           0, [&]() { not_implemented(); }},         // 0x8B
-            {"",           0, [&]() { not_implemented(); }},         // 0x8C
-            {"",           0, [&]() { not_implemented(); }},         // 0x8D
-            {"",           0, [&]() { not_implemented(); }},         // 0x8E
-            {"",           0, [&]() { not_implemented(); }},         // 0x8F
-            {"",           0, [&]() { not_implemented(); }},         // 0x90
-            {"",           0, [&]() { not_implemented(); }},         // 0x91
-            {"",           0, [&]() { not_implemented(); }},         // 0x92
-            {"",           0, [&]() { not_implemented(); }},         // 0x93
-            {"",           0, [&]() { not_implemented(); }},         // 0x94
-            {"",           0, [&]() { not_implemented(); }},         // 0x95
-            {"",           0, [&]() { not_implemented(); }},         // 0x96
-            {"",           0, [&]() { not_implemented(); }},         // 0x97
-            {"",           0, [&]() { not_implemented(); }},         // 0x98
-            {"",           0, [&]() { not_implemented(); }},         // 0x99
-            {"",           0, [&]() { not_implemented(); }},         // 0x9A
-            {"",           0, [&]() { not_implemented(); }},         // 0x9B
-            {"",           0, [&]() { not_implemented(); }},         // 0x9C
-            {"",           0, [&]() { not_implemented(); }},         // 0x9D
-            {"",           0, [&]() { not_implemented(); }},         // 0x9E
-            {"",           0, [&]() { not_implemented(); }},         // 0x9F
-            {"",           0, [&]() { not_implemented(); }},         // 0xA0
-            {"",           0, [&]() { not_implemented(); }},         // 0xA1
-            {"",           0, [&]() { not_implemented(); }},         // 0xA2
-            {"",           0, [&]() { not_implemented(); }},         // 0xA3
-            {"",           0, [&]() { not_implemented(); }},         // 0xA4
-            {"",           0, [&]() { not_implemented(); }},         // 0xA5
-            {"",           0, [&]() { not_implemented(); }},         // 0xA6
-            {"",           0, [&]() { not_implemented(); }},         // 0xA7
-            {"",           0, [&]() { not_implemented(); }},         // 0xA8
-            {"",           0, [&]() { not_implemented(); }},         // 0xA9
-            {"",           0, [&]() { not_implemented(); }},         // 0xAA
-            {"",           0, [&]() { not_implemented(); }},         // 0xAB
-            {"",           0, [&]() { not_implemented(); }},         // 0xAC
-            {"",           0, [&]() { not_implemented(); }},         // 0xAD
-            {"",           0, [&]() { not_implemented(); }},         // 0xAE
-            {"",           0, [&]() { not_implemented(); }},         // 0xAF
-            {"",           0, [&]() { not_implemented(); }},         // 0xB0
-            {"",           0, [&]() { not_implemented(); }},         // 0xB1
-            {"",           0, [&]() { not_implemented(); }},         // 0xB2
-            {"",           0, [&]() { not_implemented(); }},         // 0xB3
-            {"",           0, [&]() { not_implemented(); }},         // 0xB4
-            {"",           0, [&]() { not_implemented(); }},         // 0xB5
-            {"",           0, [&]() { not_implemented(); }},         // 0xB6
-            {"",           0, [&]() { not_implemented(); }},         // 0xB7
-            {"",           0, [&]() { not_implemented(); }},         // 0xB8
-            {"",           0, [&]() { not_implemented(); }},         // 0xB9
-            {"",           0, [&]() { not_implemented(); }},         // 0xBA
-            {"",           0, [&]() { not_implemented(); }},         // 0xBB
-            {"",           0, [&]() { not_implemented(); }},         // 0xBC
-            {"",           0, [&]() { not_implemented(); }},         // 0xBD
-            {"",           0, [&]() { not_implemented(); }},         // 0xBE
-            {"",           0, [&]() { not_implemented(); }},         // 0xBF
-            {"",           0, [&]() { not_implemented(); }},         // 0xC0
-            {"",           0, [&]() { not_implemented(); }},         // 0xC1
-            {"",           0, [&]() { not_implemented(); }},         // 0xC2
-            {"",           0, [&]() { not_implemented(); }},         // 0xC3
-            {"",           0, [&]() { not_implemented(); }},         // 0xC4
-            {"",           0, [&]() { not_implemented(); }},         // 0xC5
-            {"",           0, [&]() { not_implemented(); }},         // 0xC6
-            {"",           0, [&]() { not_implemented(); }},         // 0xC7
-            {"",           0, [&]() { not_implemented(); }},         // 0xC8
-            {"",           0, [&]() { not_implemented(); }},         // 0xC9
-            {"",           0, [&]() { not_implemented(); }},         // 0xCA
-            {"",           0, [&]() { not_implemented(); }},         // 0xCB
-            {"",           0, [&]() { not_implemented(); }},         // 0xCC
-            {"",           0, [&]() { not_implemented(); }},         // 0xCD
-            {"",           0, [&]() { not_implemented(); }},         // 0xCE
-            {"",           0, [&]() { not_implemented(); }},         // 0xCF
-            {"",           0, [&]() { not_implemented(); }},         // 0xD0
-            {"",           0, [&]() { not_implemented(); }},         // 0xD1
-            {"",           0, [&]() { not_implemented(); }},         // 0xD2
-            {"",           0, [&]() { not_implemented(); }},         // 0xD3
-            {"",           0, [&]() { not_implemented(); }},         // 0xD4
-            {"",           0, [&]() { not_implemented(); }},         // 0xD5
-            {"",           0, [&]() { not_implemented(); }},         // 0xD6
-            {"",           0, [&]() { not_implemented(); }},         // 0xD7
-            {"",           0, [&]() { not_implemented(); }},         // 0xD8
-            {"",           0, [&]() { not_implemented(); }},         // 0xD9
-            {"",           0, [&]() { not_implemented(); }},         // 0xDA
-            {"",           0, [&]() { not_implemented(); }},         // 0xDB
-            {"",           0, [&]() { not_implemented(); }},         // 0xDC
-            {"",           0, [&]() { not_implemented(); }},         // 0xDD
-            {"",           0, [&]() { not_implemented(); }},         // 0xDE
-            {"",           0, [&]() { not_implemented(); }},         // 0xDF
-            {"",           0, [&]() { not_implemented(); }},         // 0xE0
-            {"",           0, [&]() { not_implemented(); }},         // 0xE1
-            {"",           0, [&]() { not_implemented(); }},         // 0xE2
-            {"",           0, [&]() { not_implemented(); }},         // 0xE3
-            {"",           0, [&]() { not_implemented(); }},         // 0xE4
-            {"",           0, [&]() { not_implemented(); }},         // 0xE5
-            {"",           0, [&]() { not_implemented(); }},         // 0xE6
-            {"",           0, [&]() { not_implemented(); }},         // 0xE7
-            {"",           0, [&]() { not_implemented(); }},         // 0xE8
-            {"",           0, [&]() { not_implemented(); }},         // 0xE9
-            {"",           0, [&]() { not_implemented(); }},         // 0xEA
-            {"",           0, [&]() { not_implemented(); }},         // 0xEB
-            {"",           0, [&]() { not_implemented(); }},         // 0xEC
-            {"",           0, [&]() { not_implemented(); }},         // 0xED
-            {"",           0, [&]() { not_implemented(); }},         // 0xEE
-            {"",           0, [&]() { not_implemented(); }},         // 0xEF
-            {"",           0, [&]() { not_implemented(); }},         // 0xF0
-            {"",           0, [&]() { not_implemented(); }},         // 0xF1
-            {"",           0, [&]() { not_implemented(); }},         // 0xF2
-            {"",           0, [&]() { not_implemented(); }},         // 0xF3
-            {"",           0, [&]() { not_implemented(); }},         // 0xF4
-            {"",           0, [&]() { not_implemented(); }},         // 0xF5
-            {"",           0, [&]() { not_implemented(); }},         // 0xF6
-            {"",           0, [&]() { not_implemented(); }},         // 0xF7
-            {"",           0, [&]() { not_implemented(); }},         // 0xF8
-            {"",           0, [&]() { not_implemented(); }},         // 0xF9
-            {"",           0, [&]() { not_implemented(); }},         // 0xFA
-            {"",           0, [&]() { not_implemented(); }},         // 0xFB
-            {"",           0, [&]() { not_implemented(); }},         // 0xFC
-            {"",           0, [&]() { not_implemented(); }},         // 0xFD
-            {"",           0, [&]() { not_implemented(); }},         // 0xFE
-            {"",           0, [&]() { not_implemented(); }},         // 0xFF
-    };
-    table = opcodes;
-}
+// The JIT translates the blocks of the block cache
+#if defined(SOMOS_BLOCK_CACHE) || SOMOS_Z80_JIT
+#define SOMOS_Z80_BLOCK_CACHE 1
+#else
+#define SOMOS_Z80_BLOCK_CACHE 0
+#endif
 
-void Z80::setup_opcode_table_cb(std::vector<Opcodes> &table) {
-    // https://www.smspower.org/Development/InstructionSet
-    // https://clrhome.org/table/
-    std::vector<Opcodes> opcodes = {
-            {"", 1, [&]() { not_implemented(); }},         // 0x00
-            {"", 0, [&]() { not_implemented(); }},         // 0x01
-            {"", 0, [&]() { not_implemented(); }},         // 0x02
-            {"", 0, [&]() { not_implemented(); }},         // 0x03
-            {"", 0, [&]() { not_implemented(); }},         // 0x04
-            {"", 0, [&]() { not_implemented(); }},         // 0x05
-            {"", 0, [&]() { not_implemented(); }},         // 0x06
-            {"", 0, [&]() { not_implemented(); }},         // 0x07
-            {"", 0, [&]() { not_implemented(); }},         // 0x08
-            {"", 0, [&]() { not_implemented(); }},         // 0x09
-            {"", 0, [&]() { not_implemented(); }},         // 0x0A
-            {"", 0, [&]() { not_implemented(); }},         // 0x0B
-            {"", 0, [&]() { not_implemented(); }},         // 0x0C
-            {"", 0, [&]() { not_implemented(); }},         // 0x0D
-            {"", 0, [&]() { not_implemented(); }},         // 0x0E
-            {"", 0, [&]() { not_implemented(); }},         // 0x0F
-            {"", 0, [&]() { not_implemented(); }},         // 0x10
-            {"", 0, [&]() { not_implemented(); }},         // 0x11
-            {"", 0, [&]() { not_implemented(); }},         // 0x12
-            {"", 0, [&]() { not_implemented(); }},         // 0x13
-            {"", 0, [&]() { not_implemented(); }},         // 0x14
-            {"", 0, [&]() { not_implemented(); }},         // 0x15
-            {"", 0, [&]() { not_implemented(); }},         // 0x16
-            {"", 0, [&]() { not_implemented(); }},         // 0x17
-            {"", 0, [&]() { not_implemented(); }},         // 0x18
-            {"", 0, [&]() { not_implemented(); }},         // 0x19
-            {"", 0, [&]() { not_implemented(); }},         // 0x1A
-            {"", 0, [&]() { not_implemented(); }},         // 0x1B
-            {"", 0, [&]() { not_implemented(); }},         // 0x1C
-            {"", 0, [&]() { not_implemented(); }},         // 0x1D
-            {"", 0, [&]() { not_implemented(); }},         // 0x1E
-            {"", 0, [&]() { not_implemented(); }},         // 0x1F
-            {"", 0, [&]() { not_implemented(); }},         // 0x20
-            {"", 0, [&]() { not_implemented(); }},         // 0x21
-            {"", 0, [&]() { not_implemented(); }},         // 0x22
-            {"", 0, [&]() { not_implemented(); }},         // 0x23
-            {"", 0, [&]() { not_implemented(); }},         // 0x24
-            {"", 0, [&]() { not_implemented(); }},         // 0x25
-            {"", 0, [&]() { not_implemented(); }},         // 0x26
-            {"", 0, [&]() { not_implemented(); }},         // 0x27
-            {"", 0, [&]() { not_implemented(); }},         // 0x28
-            {"", 0, [&]() { not_implemented(); }},         // 0x29
-            {"", 0, [&]() { not_implemented(); }},         // 0x2A
-            {"", 0, [&]() { not_implemented(); }},         // 0x2B
-            {"", 0, [&]() { not_implemented(); }},         // 0x2C
-            {"", 0, [&]() { not_implemented(); }},         // 0x2D
-            {"", 0, [&]() { not_implemented(); }},         // 0x2E
-            {"", 0, [&]() { not_implemented(); }},         // 0x2F
-            {"", 0, [&]() { not_implemented(); }},         // 0x30
-            {"", 0, [&]() { not_implemented(); }},         // 0x31
-            {"", 0, [&]() { not_implemented(); }},         // 0x32
-            {"", 0, [&]() { not_implemented(); }},         // 0x33
-            {"", 0, [&]() { not_implemented(); }},         // 0x34
-            {"", 0, [&]() { not_implemented(); }},         // 0x35
-            {"", 0, [&]() { not_implemented(); }},         // 0x36
-            {"", 0, [&]() { not_implemented(); }},         // 0x37
-            {"", 0, [&]() { not_implemented(); }},         // 0x38
-            {"", 0, [&]() { not_implemented(); }},         // 0x39
-            {"", 0, [&]() { not_implemented(); }},         // 0x3A
-            {"", 0, [&]() { not_implemented(); }},         // 0x3B
-            {"", 0, [&]() { not_implemented(); }},         // 0x3C
-            {"", 0, [&]() { not_implemented(); }},         // 0x3D
-            {"", 0, [&]() { not_implemented(); }},         // 0x3E
-            {"", 0, [&]() { not_implemented(); }},         // 0x3F
-            {"", 0, [&]() { not_implemented(); }},         // 0x40
-            {"", 0, [&]() { not_implemented(); }},         // 0x41
-            {"", 0, [&]() { not_implemented(); }},         // 0x42
-            {"", 0, [&]() { not_implemented(); }},         // 0x43
-            {"", 0, [&]() { not_implemented(); }},         // 0x44
-            {"", 0, [&]() { not_implemented(); }},         // 0x45
-            {"", 0, [&]() { not_implemented(); }},         // 0x46
-            {"", 0, [&]() { not_implemented(); }},         // 0x47
-            {"", 0, [&]() { not_implemented(); }},         // 0x48
-            {"", 0, [&]() { not_implemented(); }},         // 0x49
-            {"", 0, [&]() { not_implemented(); }},         // 0x4A
-            {"", 0, [&]() { not_implemented(); }},         // 0x4B
-            {"", 0, [&]() { not_implemented(); }},         // 0x4C
-            {"", 0, [&]() { not_implemented(); }},         // 0x4D
-            {"", 0, [&]() { not_implemented(); }},         // 0x4E
-            {"", 0, [&]() { not_implemented(); }},         // 0x4F
-            {"", 0, [&]() { not_implemented(); }},         // 0x50
-            {"", 0, [&]() { not_implemented(); }},         // 0x51
-            {"", 0, [&]() { not_implemented(); }},         // 0x52
-            {"", 0, [&]() { not_implemented(); }},         // 0x53
-            {"", 0, [&]() { not_implemented(); }},         // 0x54
-            {"", 0, [&]() { not_implemented(); }},         // 0x55
-            {"", 0, [&]() { not_implemented(); }},         // 0x56
-            {"", 0, [&]() { not_implemented(); }},         // 0x57
-            {"", 0, [&]() { not_implemented(); }},         // 0x58
-            {"", 0, [&]() { not_implemented(); }},         // 0x59
-            {"", 0, [&]() { not_implemented(); }},         // 0x5A
-            {"", 0, [&]() { not_implemented(); }},         // 0x5B
-            {"", 0, [&]() { not_implemented(); }},         // 0x5C
-            {"", 0, [&]() { not_implemented(); }},         // 0x5D
-            {"", 0, [&]() { not_implemented(); }},         // 0x5E
-            {"", 0, [&]() { not_implemented(); }},         // 0x5F
-            {"", 0, [&]() { not_implemented(); }},         // 0x60
-            {"", 0, [&]() { not_implemented(); }},         // 0x61
-            {"", 0, [&]() { not_implemented(); }},         // 0x62
-            {"", 0, [&]() { not_implemented(); }},         // 0x63
-            {"", 0, [&]() { not_implemented(); }},         // 0x64
-            {"", 0, [&]() { not_implemented(); }},         // 0x65
-            {"", 0, [&]() { not_implemented(); }},         // 0x66
-            {"", 0, [&]() { not_implemented(); }},         // 0x67
-            {"", 0, [&]() { not_implemented(); }},         // 0x68
-            {"", 0, [&]() { not_implemented(); }},         // 0x69
-            {"", 0, [&]() { not_implemented(); }},         // 0x6A
-            {"", 0, [&]() { not_implemented(); }},         // 0x6B
-            {"", 0, [&]() { not_implemented(); }},         // 0x6C
-            {"", 0, [&]() { not_implemented(); }},         // 0x6D
-            {"", 0, [&]() { not_implemented(); }},         // 0x6E
-            {"", 0, [&]() { not_implemented(); }},         // 0x6F
-            {"", 0, [&]() { not_implemented(); }},         // 0x70
-            {"", 0, [&]() { not_implemented(); }},         // 0x71
-            {"", 0, [&]() { not_implemented(); }},         // 0x72
-            {"", 0, [&]() { not_implemented(); }},         // 0x73
-            {"", 0, [&]() { not_implemented(); }},         // 0x74
-            {"", 0, [&]() { not_implemented(); }},         // 0x75
-            {"", 0, [&]() { not_implemented(); }},         // 0x76
-            {"", 0, [&]() { not_implemented(); }},         // 0x77
-            {"", 0, [&]() { not_implemented(); }},         // 0x78
-            {"", 0, [&]() { not_implemented(); }},         // 0x79
-            {"", 0, [&]() { not_implemented(); }},         // 0x7A
-            {"", 0, [&]() { not_implemented(); }},         // 0x7B
-            {"", 0, [&]() { not_implemented(); }},         // 0x7C
-            {"", 0, [&]() { not_implemented(); }},         // 0x7D
-            {"", 0, [&]() { not_implemented(); }},         // 0x7E
-            {"", 0, [&]() { not_implemented(); }},         // 0x7F
-            {"", 0, [&]() { not_implemented(); }},         // 0x80
-            {"", 0, [&]() { not_implemented(); }},         // 0x81
-            {"", 0, [&]() { not_implemented(); }},         // 0x82
-            {"", 0, [&]() { not_implemented(); }},         // 0x83
-            {"", 0, [&]() { not_implemented(); }},         // 0x84
-            {"", 0, [&]() { not_implemented(); }},         // 0x85
-            {"", 0, [&]() { not_implemented(); }},         // 0x86
-            {"", 0, [&]() { not_implemented(); }},         // 0x87
-            {"", 0, [&]() { not_implemented(); }},         // 0x88
-            {"", 0, [&]() { not_implemented(); }},         // 0x89
-            {"", 0, [&]() { not_implemented(); }},         // 0x8A
-            {"", 0, [&]() { not_implemented(); }},         // 0x8B
-            {"", 0, [&]() { not_implemented(); }},         // 0x8C
-            {"", 0, [&]() { not_implemented(); }},         // 0x8D
-            {"", 0, [&]() { not_implemented(); }},         // 0x8E
-            {"", 0, [&]() { not_implemented(); }},         // 0x8F
-            {"", 0, [&]() { not_implemented(); }},         // 0x90
-            {"", 0, [&]() { not_implemented(); }},         // 0x91
-            {"", 0, [&]() { not_implemented(); }},         // 0x92
-            {"", 0, [&]() { not_implemented(); }},         // 0x93
-            {"", 0, [&]() { not_implemented(); }},         // 0x94
-            {"", 0, [&]() { not_implemented(); }},         // 0x95
-            {"", 0, [&]() { not_implemented(); }},         // 0x96
-            {"", 0, [&]() { not_implemented(); }},         // 0x97
-            {"", 0, [&]() { not_implemented(); }},         // 0x98
-            {"", 0, [&]() { not_implemented(); }},         // 0x99
-            {"", 0, [&]() { not_implemented(); }},         // 0x9A
-            {"", 0, [&]() { not_implemented(); }},         // 0x9B
-            {"", 0, [&]() { not_implemented(); }},         // 0x9C
-            {"", 0, [&]() { not_implemented(); }},         // 0x9D
-            {"", 0, [&]() { not_implemented(); }},         // 0x9E
-            {"", 0, [&]() { not_implemented(); }},         // 0x9F
-            {"", 0, [&]() { not_implemented(); }},         // 0xA0
-            {"", 0, [&]() { not_implemented(); }},         // 0xA1
-            {"", 0, [&]() { not_implemented(); }},         // 0xA2
-            {"", 0, [&]() { not_implemented(); }},         // 0xA3
-            {"", 0, [&]() { not_implemented(); }},         // 0xA4
-            {"", 0, [&]() { not_implemented(); }},         // 0xA5
-            {"", 0, [&]() { not_implemented(); }},         // 0xA6
-            {"", 0, [&]() { not_implemented(); }},         // 0xA7
-            {"", 0, [&]() { not_implemented(); }},         // 0xA8
-            {"", 0, [&]() { not_implemented(); }},         // 0xA9
-            {"", 0, [&]() { not_implemented(); }},         // 0xAA
-            {"", 0, [&]() { not_implemented(); }},         // 0xAB
-            {"", 0, [&]() { not_implemented(); }},         // 0xAC
-            {"", 0, [&]() { not_implemented(); }},         // 0xAD
-            {"", 0, [&]() { not_implemented(); }},         // 0xAE
-            {"", 0, [&]() { not_implemented(); }},         // 0xAF
-            {"", 0, [&]() { not_implemented(); }},         // 0xB0
-            {"", 0, [&]() { not_implemented(); }},         // 0xB1
-            {"", 0, [&]() { not_implemented(); }},         // 0xB2
-            {"", 0, [&]() { not_implemented(); }},         // 0xB3
-            {"", 0, [&]() { not_implemented(); }},         // 0xB4
-            {"", 0, [&]() { not_implemented(); }},         // 0xB5
-            {"", 0, [&]() { not_implemented(); }},         // 0xB6
-            {"", 0, [&]() { not_implemented(); }},         // 0xB7
-            {"", 0, [&]() { not_implemented(); }},         // 0xB8
-            {"", 0, [&]() { not_implemented(); }},         // 0xB9
-            {"", 0, [&]() { not_implemented(); }},         // 0xBA
-            {"", 0, [&]() { not_implemented(); }},         // 0xBB
-            {"", 0, [&]() { not_implemented(); }},         // 0xBC
-            {"", 0, [&]() { not_implemented(); }},         // 0xBD
-            {"", 0, [&]() { not_implemented(); }},         // 0xBE
-            {"", 0, [&]() { not_implemented(); }},         // 0xBF
-            {"", 0, [&]() { not_implemented(); }},         // 0xC0
-            {"", 0, [&]() { not_implemented(); }},         // 0xC1
-            {"", 0, [&]() { not_implemented(); }},         // 0xC2
-            {"", 0, [&]() { not_implemented(); }},         // 0xC3
-            {"", 0, [&]() { not_implemented(); }},         // 0xC4
-            {"", 0, [&]() { not_implemented(); }},         // 0xC5
-            {"", 0, [&]() { not_implemented(); }},         // 0xC6
-            {"", 0, [&]() { not_implemented(); }},         // 0xC7
-            {"", 0, [&]() { not_implemented(); }},         // 0xC8
-            {"", 0, [&]() { not_implemented(); }},         // 0xC9
-            {"", 0, [&]() { not_implemented(); }},         // 0xCA
-            {"", 0, [&]() { not_implemented(); }},         // 0xCB
-            {"", 0, [&]() { not_implemented(); }},         // 0xCC
-            {"", 0, [&]() { not_implemented(); }},         // 0xCD
-            {"", 0, [&]() { not_implemented(); }},         // 0xCE
-            {"", 0, [&]() { not_implemented(); }},         // 0xCF
-            {"", 0, [&]() { not_implemented(); }},         // 0xD0
-            {"", 0, [&]() { not_implemented(); }},         // 0xD1
-            {"", 0, [&]() { not_implemented(); }},         // 0xD2
-            {"", 0, [&]() { not_implemented(); }},         // 0xD3
-            {"", 0, [&]() { not_implemented(); }},         // 0xD4
-            {"", 0, [&]() { not_implemented(); }},         // 0xD5
-            {"", 0, [&]() { not_implemented(); }},         // 0xD6
-            {"", 0, [&]() { not_implemented(); }},         // 0xD7
-            {"", 0, [&]() { not_implemented(); }},         // 0xD8
-            {"", 0, [&]() { not_implemented(); }},         // 0xD9
-            {"", 0, [&]() { not_implemented(); }},         // 0xDA
-            {"", 0, [&]() { not_implemented(); }},         // 0xDB
-            {"", 0, [&]() { not_implemented(); }},         // 0xDC
-            {"", 0, [&]() { not_implemented(); }},         // 0xDD
-            {"", 0, [&]() { not_implemented(); }},         // 0xDE
-            {"", 0, [&]() { not_implemented(); }},         // 0xDF
-            {"", 0, [&]() { not_implemented(); }},         // 0xE0
-            {"", 0, [&]() { not_implemented(); }},         // 0xE1
-            {"", 0, [&]() { not_implemented(); }},         // 0xE2
-            {"", 0, [&]() { not_implemented(); }},         // 0xE3
-            {"", 0, [&]() { not_implemented(); }},         // 0xE4
-            {"", 0, [&]() { not_implemented(); }},         // 0xE5
-            {"", 0, [&]() { not_implemented(); }},         // 0xE6
-            {"", 0, [&]() { not_implemented(); }},         // 0xE7
-            {"", 0, [&]() { not_implemented(); }},         // 0xE8
-            {"", 0, [&]() { not_implemented(); }},         // 0xE9
-            {"", 0, [&]() { not_implemented(); }},         // 0xEA
-            {"", 0, [&]() { not_implemented(); }},         // 0xEB
-            {"", 0, [&]() { not_implemented(); }},         // 0xEC
-            {"", 0, [&]() { not_implemented(); }},         // 0xED
-            {"", 0, [&]() { not_implemented(); }},         // 0xEE
-            {"", 0, [&]() { not_implemented(); }},         // 0xEF
-            {"", 0, [&]() { not_implemented(); }},         // 0xF0
-            {"", 0, [&]() { not_implemented(); }},         // 0xF1
-            {"", 0, [&]() { not_implemented(); }},         // 0xF2
-            {"", 0, [&]() { not_implemented(); }},         // 0xF3
-            {"", 0, [&]() { not_implemented(); }},         // 0xF4
-            {"", 0, [&]() { not_implemented(); }},         // 0xF5
-            {"", 0, [&]() { not_implemented(); }},         // 0xF6
-            {"", 0, [&]() { not_implemented(); }},         // 0xF7
-            {"", 0, [&]() { not_implemented(); }},         // 0xF8
-            {"", 0, [&]() { not_implemented(); }},         // 0xF9
-            {"", 0, [&]() { not_implemented(); }},         // 0xFA
-            {"", 0, [&]() { not_implemented(); }},         // 0xFB
-            {"", 0, [&]() { not_implemented(); }},         // 0xFC
-            {"", 0, [&]() { not_implemented(); }},         // 0xFD
-            {"", 0, [&]() { not_implemented(); }},         // 0xFE
-            {"", 0, [&]() { not_implemented(); }},         // 0xFF
-    };
-    table = opcodes;
+Z80::Z80(Memory* mem, IoBus* io) : m_mem(mem), m_io(io), m_reg(), m_shadow(), m_cycles(0), m_lazy_flags(), m_instruction_count(0), m_halted(false), m_idle_loop(), m_run_cycles(0), m_run_deadline(0), m_run_budget(0), m_block_code_generation(0), m_iff1(false), m_iff2(false), m_interrupt_mode(0), m_pending_interrupts(0), m_ei_instruction(0) {
+    if (m_io == nullptr) {
+        // Nothing is ever attached to it, so it can be shared
+        static IoBus unconnected;
+        m_io = &unconnected;
+    }
+
+#if SOMOS_Z80_BLOCK_CACHE
+    // Allocated once up front so that running never allocates. No block matches a generation of 0
+    m_blocks.resize(BLOCK_CACHE_SIZE, DecodedBlock{0, 0, 0, {}, 0, nullptr});
+#endif
 }
 
+static constexpr OpcodeInfo opcode_info_table[] = {
+#define OPCODE(code, mnemonic, size, handler) {mnemonic, size},
+        Z80_OPCODE_TABLE(OPCODE)
+        Z80_PREFIXED_OPCODE_TABLE(OPCODE)
+#undef OPCODE
+};
+static_assert(sizeof(opcode_info_table) / sizeof(OpcodeInfo) == OPCODE_COUNT, "Opcode tables must have 256 entries");
+
 static void reset_registers(Registers &reg) {
     reg.AF = 0;
     reg.BC = 0;
@@ -554,33 +58,367 @@ void Z80::reset() {
     reset_registers(m_reg);
     reset_registers(m_shadow);
     m_cycles = 0;
+    m_lazy_flags = {};
+    m_instruction_count = 0;
+    m_halted = false;
+    m_iff1 = false;
+    m_iff2 = false;
+    m_interrupt_mode = 0;
+    m_pending_interrupts = 0;
+    m_ei_instruction = 0;
+    m_idle_loop = {};
+    m_run_cycles = 0;
+    m_run_deadline = 0;
+    m_run_budget = 0;
 }
 
 bool Z80::is_flag_set(FLAGS flag) const {
-    return m_reg.F & (1 << flag);
+    return evaluate_flags() & flag_mask(flag);
 }
 
 void Z80::step() {
+    m_run_cycles = 0;
+    m_run_deadline = 0;
+    m_run_budget = 0;
+    m_idle_loop.valid = false;
+
+    // An interrupt is taken instead of the next instruction
+    if (m_pending_interrupts != 0 && take_interrupt()) {
+        return;
+    }
+
     uint8_t opcode = m_mem->read(m_reg.PC);
     execute_opcode(opcode);
 }
 
 void Z80::execute_opcode(uint8_t opcode) {
-    increment_refresh_r();
+    m_instruction_count++;
     m_cycles = 0;
 
-    Opcodes instruction = m_opcode_table.at(opcode);
-    instruction.execute();
+    switch (opcode) {
+#define OPCODE(code, mnemonic, size, handler)   \
+        case code:                              \
+            op<code>();                         \
+            break;
+        Z80_OPCODE_TABLE(OPCODE)
+#undef OPCODE
+    }
+}
+
+unsigned long Z80::run(unsigned long cycle_budget) {
+    m_run_cycles = 0;
+    m_run_budget = cycle_budget;
+    // Cycles recorded by an earlier run are from a different count
+    m_idle_loop.valid = false;
 
-    m_reg.PC += instruction.size;
+    // Interrupts are only looked at here, between the runs of the execution loop. Whatever makes an interrupt ready to
+    // be taken while the CPU is running also moves the deadline to stop the loop, so the loop never checks for them
+    while (m_run_cycles < m_run_budget) {
+        m_run_deadline = m_run_budget;
+        if (m_pending_interrupts != 0 && take_interrupt()) {
+            m_run_cycles += m_cycles;
+        }
+        run_until_deadline();
+    }
+
+    return m_run_cycles;
 }
 
-void Z80::increment_refresh_r() {
-    if ((m_reg.R & 0x7F) == 0x7F) {
-        m_reg.R = m_reg.R & 0x80;
+void Z80::run_until_deadline() {
+    // A cartridge that was translated ahead of time runs from its translation, whatever the interpreter
+    if (!m_aot_blocks.empty()) {
+        run_aot();
+        return;
+    }
+
+#if SOMOS_Z80_BLOCK_CACHE
+    while (m_run_cycles < m_run_deadline) {
+        run_block();
+    }
+#elif SOMOS_Z80_THREADED
+    // Threaded interpreter: every handler ends by fetching the next opcode and jumping straight to its label, so there
+    // is one indirect branch per opcode instead of a single shared one at the top of a loop
+    static void* const dispatch_table[] = {
+#define OPCODE(code, mnemonic, size, handler) &&opcode_##code,
+            Z80_OPCODE_TABLE(OPCODE)
+#undef OPCODE
+    };
+
+#define DISPATCH()                                  \
+    if (m_run_cycles >= m_run_deadline) {           \
+        return;                                     \
+    }                                               \
+    m_instruction_count++;                          \
+    m_cycles = 0;                                   \
+    goto *dispatch_table[m_mem->read(m_reg.PC)];
+
+    DISPATCH();
+
+#define OPCODE(code, mnemonic, size, handler)       \
+    opcode_##code:                                  \
+        op<code>();                                 \
+        m_run_cycles += m_cycles;                   \
+        DISPATCH();
+    Z80_OPCODE_TABLE(OPCODE)
+#undef OPCODE
+#undef DISPATCH
+#else
+    while (m_run_cycles < m_run_deadline) {
+        execute_opcode(m_mem->read(m_reg.PC));
+        m_run_cycles += m_cycles;
+    }
+#endif
+}
+
+#if SOMOS_Z80_BLOCK_CACHE
+void Z80::run_block() {
+    uint32_t physical = m_mem->physical_address(m_reg.PC);
+    // Banks are 16KB apart, fold the bank number in so the same address in different banks doesn't collide
+    DecodedBlock& block = m_blocks[(physical ^ (physical >> 14)) & (BLOCK_CACHE_SIZE - 1)];
+
+    if (block.physical != physical || block.generation != m_mem->page_generation(physical)) {
+        decode_block(block, physical);
+    }
+
+    if (block.length == 0) {
+        execute_opcode(m_mem->read(m_reg.PC));
+        m_run_cycles += m_cycles;
+        return;
+    }
+
+    m_block_code_generation = m_mem->code_generation();
+
+#if SOMOS_Z80_JIT
+    if (block.countdown > 0 && --block.countdown == 0) {
+        translate_block(block);
+    }
+    if (block.native != nullptr) {
+        block.native(*this);
+        return;
+    }
+#endif
+
+    for (int i = 0; i < block.length; i++) {
+        if (!block.steps[i](*this)) {
+            return;
+        }
+    }
+}
+
+void Z80::decode_block(DecodedBlock &block, uint32_t physical) {
+    static constexpr BlockStep step_table[] = {
+#define OPCODE(code, mnemonic, size, handler) [](Z80& cpu) { return cpu.block_step<code>(); },
+            Z80_OPCODE_TABLE(OPCODE)
+            Z80_PREFIXED_OPCODE_TABLE(OPCODE)
+#undef OPCODE
+    };
+
+    // Code in RAM has to be decoded again after it is written to
+    m_mem->watch_code(physical);
+
+    block.physical = physical;
+    block.generation = m_mem->page_generation(physical);
+    block.length = 0;
+    // Only ROM blocks are translated, so that translations never have to be thrown away because the code changed
+    block.countdown = m_mem->is_rom(physical) ? JIT_THRESHOLD : 0;
+    block.native = nullptr;
+
+    int page_offset = physical & (MEMORY_PAGE_SIZE - 1);
+    uint16_t pc = m_reg.PC;
+    while (block.length < BLOCK_MAX_OPCODES) {
+        // Prefixed instructions are decoded into a step of their own, so they don't go through prefix()
+        uint16_t opcode = decode_opcode(m_mem, pc);
+        int size = opcode_info_table[opcode].size;
+
+        // Operands are read by the handlers, so the whole instruction has to be on this page to be covered by its
+        // generation
+        if (size == 0 || page_offset + size > MEMORY_PAGE_SIZE) {
+            break;
+        }
+
+        block.steps[block.length] = step_table[opcode];
+        block.length++;
+        page_offset += size;
+        pc += size;
+    }
+}
+
+#endif
+
+void Z80::run_aot() {
+    while (m_run_cycles < m_run_deadline) {
+        // Cartridge ROM comes first in the physical address space, so anything past the table isn't translated
+        uint32_t physical = m_mem->physical_address(m_reg.PC);
+        NativeBlock block = physical < m_aot_blocks.size() ? m_aot_blocks[physical] : nullptr;
+
+        if (block != nullptr) {
+            m_block_code_generation = m_mem->code_generation();
+            block(*this);
+        } else {
+            execute_opcode(m_mem->read(m_reg.PC));
+            m_run_cycles += m_cycles;
+        }
+    }
+}
+
+void Z80::set_aot_program(const AotProgram *program) {
+    m_aot_blocks.clear();
+    if (program == nullptr) {
+        return;
+    }
+
+    // Indexed by physical address, so that finding the block at the PC is a single load
+    m_aot_blocks.resize(program->rom_size, nullptr);
+    for (int i = 0; i < program->block_count; i++) {
+        m_aot_blocks[program->blocks[i].physical] = program->blocks[i].run;
+    }
+}
+
+void Z80::set_deadline(unsigned long cycle) {
+    // An earlier stop asked for by an interrupt is kept, run() carries on to the new deadline after taking it
+    m_run_deadline = m_run_deadline < m_run_budget ? std::min(m_run_deadline, cycle) : cycle;
+    m_run_budget = cycle;
+}
+
+void Z80::set_irq_line(bool asserted) {
+    if (!asserted) {
+        m_pending_interrupts &= ~INTERRUPT_IRQ;
+        return;
+    }
+
+    m_pending_interrupts |= INTERRUPT_IRQ;
+    // Devices raise the line from their port handlers while the CPU is running. Stop after the current instruction
+    // so that run() takes the interrupt straight away
+    if (m_iff1) {
+        m_run_deadline = 0;
+    }
+}
+
+void Z80::trigger_nmi() {
+    m_pending_interrupts |= INTERRUPT_NMI;
+    m_run_deadline = 0;
+}
+
+bool Z80::take_interrupt() {
+    if (m_pending_interrupts & INTERRUPT_NMI) {
+        m_pending_interrupts &= ~INTERRUPT_NMI;
+        m_iff1 = false;
+        enter_interrupt(0x0066);
+        m_cycles = 11;
+        return true;
+    }
+
+    if (!m_iff1) {
+        return false;
+    }
+    // Interrupts are held off until the instruction after ei has run, stop the execution loop right after it
+    if (m_instruction_count == m_ei_instruction) {
+        m_run_deadline = std::min(m_run_deadline, m_run_cycles + 1);
+        return false;
+    }
+
+    m_iff1 = false;
+    m_iff2 = false;
+    if (m_interrupt_mode == 2) {
+        enter_interrupt(m_mem->read_word((m_reg.I << 8) | 0xFF));
+        m_cycles = 19;
     } else {
-        m_reg.R++;
+        // In mode 0 the CPU executes the 0xFF that the idle data bus holds, which is rst 0x38 like mode 1
+        enter_interrupt(0x0038);
+        m_cycles = 13;
+    }
+
+    return true;
+}
+
+void Z80::enter_interrupt(uint16_t address) {
+    // A halted CPU carries on after the halt when the interrupt returns
+    if (m_halted) {
+        m_halted = false;
+        m_reg.PC++;
+    }
+
+    // The acknowledge is an opcode fetch, so R moves on
+    m_instruction_count++;
+    push_16bit(m_reg.PC);
+    m_reg.PC = address;
+    m_idle_loop.valid = false;
+}
+
+unsigned long Z80::get_run_cycles() const {
+    return m_run_cycles;
+}
+
+const OpcodeInfo& Z80::opcode_info(uint16_t opcode) {
+    return opcode_info_table[opcode];
+}
+
+uint16_t Z80::decode_opcode(Memory *mem, uint16_t address) {
+    uint8_t opcode = mem->read(address);
+
+    switch (opcode) {
+        case 0xCB:
+            return OPCODE_TABLE_CB | mem->read(address + 1);
+        case 0xED:
+            return OPCODE_TABLE_ED | mem->read(address + 1);
+        case 0xDD:
+        case 0xFD: {
+            uint8_t next = mem->read(address + 1);
+            // dd cb d xx, the opcode comes after the displacement
+            if (next == 0xCB) {
+                return (opcode == 0xDD ? OPCODE_TABLE_DDCB : OPCODE_TABLE_FDCB) | mem->read(address + 3);
+            }
+            return (opcode == 0xDD ? OPCODE_TABLE_DD : OPCODE_TABLE_FD) | next;
+        }
+        default:
+            return opcode;
+    }
+}
+
+void Z80::prefix() {
+    // Flattened table of every prefixed opcode, so that any of them is a single lookup away
+    static constexpr void (Z80::*prefixed_table[])() = {
+#define OPCODE(code, mnemonic, size, handler) &Z80::op<code>,
+            Z80_PREFIXED_OPCODE_TABLE(OPCODE)
+#undef OPCODE
+    };
+
+    (this->*prefixed_table[decode_opcode(m_mem, m_reg.PC) - OPCODE_TABLE_CB])();
+}
+
+uint8_t Z80::refresh_r() const {
+    return (m_reg.R & 0x80) | ((m_reg.R + m_instruction_count) & 0x7F);
+}
+
+void Z80::idle_branch(uint16_t target) {
+    unsigned long cycle = m_run_cycles + m_cycles;
+
+    Registers reg = m_reg;
+    reg.F = evaluate_flags();
+    reg.PC = target;
+    reg.R = 0;
+
+    if (m_idle_loop.valid && m_idle_loop.target == target && m_idle_loop.writes == m_mem->write_count() &&
+        m_idle_loop.port_side_effects == m_io->side_effect_count() &&
+        std::memcmp(&m_idle_loop.reg, &reg, sizeof(reg)) == 0 &&
+        std::memcmp(&m_idle_loop.shadow, &m_shadow, sizeof(m_shadow)) == 0) {
+        unsigned long period = cycle - m_idle_loop.cycle;
+        uint64_t instructions = m_instruction_count - m_idle_loop.instructions;
+
+        if (cycle < m_run_deadline) {
+            unsigned long iterations = (m_run_deadline - cycle + period - 1) / period;
+            m_run_cycles += iterations * period;
+            m_instruction_count += iterations * instructions;
+        }
+        return;
     }
+
+    m_idle_loop = {true, target, reg, m_shadow, m_mem->write_count(), m_io->side_effect_count(), cycle,
+                   m_instruction_count};
+}
+
+bool Z80::is_halted() const {
+    return m_halted;
 }
 
 int Z80::get_cycles() const {
@@ -588,14 +426,58 @@ int Z80::get_cycles() const {
 }
 
 Registers Z80::get_registers() const {
-  return m_reg;
+  Registers reg = m_reg;
+  reg.F = evaluate_flags();
+  reg.R = refresh_r();
+
+  return reg;
+}
+
+uint8_t Z80::evaluate_flags() const {
+    // Flag reference: http://www.z80.info/z80sflag.htm
+    uint8_t f = m_lazy_flags.preserved;
+    uint16_t operand = m_lazy_flags.operand;
+    uint16_t result = m_lazy_flags.result;
+
+    switch (m_lazy_flags.op) {
+        case FlagOp::NONE:
+            return m_reg.F;
+        case FlagOp::INC8:
+            return f | INC8_FLAGS[result];
+        case FlagOp::DEC8:
+            return f | DEC8_FLAGS[result];
+        case FlagOp::ADD8:
+            return f | ADD8_FLAGS[(operand << 8) | result];
+        case FlagOp::SUB8:
+            return f | SUB8_FLAGS[(operand << 8) | result];
+        case FlagOp::CP8: {
+            uint8_t value = operand - result;
+            return f | (SUB8_FLAGS[(operand << 8) | result] & ~FLAGS_53) | (value & FLAGS_53);
+        }
+        case FlagOp::AND8:
+            return f | SZ53P_FLAGS[result] | flag_mask(FLAGS::HALF_CARRY_H);
+        case FlagOp::LOGIC8:
+            return f | SZ53P_FLAGS[result];
+        case FlagOp::ADD16: {
+            // The carry out of bit 11 is the difference between the sum of the inputs and the result
+            uint16_t added = result - operand;
+            f |= ((operand ^ added ^ result) & 0x1000) ? flag_mask(FLAGS::HALF_CARRY_H) : 0;
+            f |= result < operand ? flag_mask(FLAGS::CARRY_C) : 0;
+            f |= (result >> 8) & FLAGS_53;
+            return f;
+        }
+    }
+
+    return m_reg.F;
 }
 
 void Z80::flag_set(FLAGS flag) {
+    resolve_flags();
     bit_set(m_reg.F, flag);
 }
 
 void Z80::flag_reset(FLAGS flag) {
+    resolve_flags();
     bit_reset(m_reg.F, flag);
 }
 
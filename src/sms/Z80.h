@@ -5,38 +5,232 @@
 #ifndef SOMOS_Z80_H
 #define SOMOS_Z80_H
 
+#include "IoBus.h"
+#include "Jit.h"
 #include "Memory.h"
 #include "Registers.h"
+#include "Z80_FlagTables.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
-#include <string>
-#include <functional>
+#include <cstring>
 #include <vector>
 
-struct Opcodes {
-    std::string mnemonic;
+/**
+ * Static description of an opcode. This is only used for disassembly and debugging, the execution path never reads it
+ */
+struct OpcodeInfo {
+    const char* mnemonic;
     int size;
-    std::function<void(void)> execute;
+};
+
+/**
+ * The last operation that changed the flags. F is only built from it when something reads the flags
+ */
+enum class FlagOp : uint8_t {
+    // m_reg.F is up to date
+    NONE,
+    INC8,
+    DEC8,
+    ADD8,
+    SUB8,
+    CP8,
+    AND8,
+    // or, xor
+    LOGIC8,
+    ADD16,
+};
+
+struct LazyFlags {
+    FlagOp op;
+    // Mask of the F bits that the operation changes
+    uint8_t affected;
+    // Value of the F bits that the operation does not change
+    uint8_t preserved;
+    uint16_t operand;
+    uint16_t result;
+};
+
+/**
+ * 8-bit operand of an instruction, in the order of the r field of the opcode: bits 0-2 for the source and 3-5 for the
+ * destination. https://www.smspower.org/Development/InstructionSet
+ */
+enum class Operand8 : uint8_t {
+    B,
+    C,
+    D,
+    E,
+    H,
+    L,
+    // Memory at the address in HL
+    HL_PTR,
+    A,
+    // The byte after the opcode
+    N,
+    // Halves of the index registers, which replace H and L after a 0xDD or 0xFD prefix
+    IXH,
+    IXL,
+    IYH,
+    IYL,
+    // Memory at the index register plus the signed displacement after the opcode, which replaces (hl). In the 0xDD 0xCB
+    // and 0xFD 0xCB tables the displacement comes before the opcode
+    IX_D,
+    IY_D,
+};
+
+/**
+ * Operation of the rotate and shift instructions, in the order of their opcodes in the 0xCB table
+ */
+enum class Rotation : uint8_t {
+    RLC,
+    RRC,
+    RL,
+    RR,
+    SLA,
+    SRA,
+    // Undocumented, shifts left and sets bit 0
+    SLL,
+    SRL,
+};
+
+// Prefixed opcodes are numbered after the un-prefixed ones, 256 per table, so that every instruction has an index in
+// a single table. The 0xDD 0xCB and 0xFD 0xCB tables are indexed by the last byte, which comes after the displacement
+constexpr uint16_t OPCODE_TABLE_CB = 0x100;
+constexpr uint16_t OPCODE_TABLE_DD = 0x200;
+constexpr uint16_t OPCODE_TABLE_ED = 0x300;
+constexpr uint16_t OPCODE_TABLE_FD = 0x400;
+constexpr uint16_t OPCODE_TABLE_DDCB = 0x500;
+constexpr uint16_t OPCODE_TABLE_FDCB = 0x600;
+constexpr uint16_t OPCODE_COUNT = 0x700;
+
+// Flags changed by 8-bit increments and decrements, carry is left as it was
+constexpr uint8_t INC_DEC_FLAGS = static_cast<uint8_t>(~flag_mask(FLAGS::CARRY_C));
+
+struct AotProgram;
+
+// Maximum number of instructions in a decoded block and number of blocks kept by the block cache
+constexpr int BLOCK_MAX_OPCODES = 16;
+constexpr int BLOCK_CACHE_SIZE = 1024;
+// Number of times a ROM block has to run before the JIT translates it
+constexpr int JIT_THRESHOLD = 32;
+
+/**
+ * Machine state at the target of the last backwards branch. If a loop comes back to exactly the same state without
+ * writing anything or reading a port that changes state, it is idle until something outside the CPU changes
+ */
+struct IdleLoop {
+    bool valid;
+    uint16_t target;
+    // Registers with F resolved and R cleared, as R is the only register an idle loop changes
+    Registers reg;
+    Registers shadow;
+    uint32_t writes;
+    uint32_t port_side_effects;
+    unsigned long cycle;
+    uint64_t instructions;
 };
 
 class Z80 {
 public:
     Z80() = delete;
 
-    explicit Z80(Memory* mem);
+    /**
+     * @param mem The memory the CPU runs from
+     * @param io The devices on the I/O ports. Without one, every port is unconnected
+     */
+    explicit Z80(Memory* mem, IoBus* io = nullptr);
 
+    /**
+     * Executes a single instruction, or takes a pending interrupt instead. Idle loops and halt are never
+     * fast-forwarded, as there is no deadline
+     */
     void step();
 
+    /**
+     * Executes instructions in a tight loop until cycle_budget cycles have passed or the deadline set through
+     * set_deadline() is reached, whichever comes first. The last instruction is always completed, so the returned
+     * value can be larger than the budget.
+     * When the library is built with SOMOS_JIT on x86-64 hot blocks from cartridge ROM are translated to native code
+     * (see Z80_Jit.cpp) and the rest run from the block cache. When it is built with SOMOS_BLOCK_CACHE it runs from
+     * the block cache, which is slower than the threaded interpreter and is what the JIT builds on. Otherwise, when it
+     * is built with SOMOS_THREADED_INTERPRETER on GCC or Clang this uses a computed goto interpreter, and if not it
+     * loops over step().
+     * Interrupts are checked before the first instruction and whenever something makes one ready to be taken, never
+     * between ordinary instructions
+     * @param cycle_budget The number of cycles to run for
+     * @return The number of cycles that were actually executed, including any overshoot
+     */
+    unsigned long run(unsigned long cycle_budget);
+
+    /**
+     * Moves the point at which the current call to run() returns. Meant to be called by devices while the CPU is
+     * running, e.g. when a write schedules an event that must happen before the end of the budget
+     * @param cycle Deadline, in cycles since the start of the current run()
+     */
+    void set_deadline(unsigned long cycle);
+
+    /**
+     * @return The number of cycles executed so far by the current (or last) call to run()
+     */
+    unsigned long get_run_cycles() const;
+
+    /**
+     * Sets the level of the maskable interrupt line. While it is asserted the CPU takes the interrupt as soon as
+     * interrupts are enabled, in mode 0, 1 or 2. Devices can call this while the CPU is running
+     */
+    void set_irq_line(bool asserted);
+
+    /**
+     * Requests a non-maskable interrupt, e.g. from the pause button. It is taken before the next instruction
+     */
+    void trigger_nmi();
+
     void reset();
 
     bool is_flag_set(FLAGS flag) const;
 
+    /**
+     * @return Whether the CPU is waiting for an interrupt after executing halt
+     */
+    bool is_halted() const;
+
     int get_cycles() const;
   
     Registers get_registers() const;
 
     void set_pc(uint16_t value);
 
+    /**
+     * Get the mnemonic and size of an opcode. The entries of the prefixes themselves have a size of 0, use
+     * decode_opcode to get the instruction they start
+     * @param opcode The opcode byte, or the index of a prefixed opcode (see OPCODE_TABLE_CB)
+     * @return The opcode's entry in the opcode tables
+     */
+    static const OpcodeInfo& opcode_info(uint16_t opcode);
+
+    /**
+     * Reads the instruction at an address, following any prefixes
+     * @return The index of the opcode in the opcode tables
+     */
+    static uint16_t decode_opcode(Memory* mem, uint16_t address);
+
+    /**
+     * Runs the loaded cartridge from its ahead of time translation, see Aot.h. Whenever the PC reaches the start of a
+     * translated block, run() calls it instead of interpreting. This doesn't depend on the interpreter the library was
+     * built with
+     * @param program The translation of the loaded cartridge, or nullptr to stop using one
+     */
+    void set_aot_program(const AotProgram* program);
+
+    /**
+     * Executes an opcode as part of an ahead of time translated block. Defined in Z80_Opcodes.h, which the generated
+     * code includes so that the whole instruction is inlined into the block
+     * @return Whether the block can carry on with the next instruction
+     */
+    template<uint16_t Opcode>
+    static bool aot_step(Z80& cpu);
+
     // Flags
     void flag_set(FLAGS flag);
 
@@ -49,30 +243,199 @@ public:
      */
     void flag_sr(FLAGS flag, bool set);   
 private:
+    /**
+     * A straight-line run of instructions whose opcodes were looked up once. Only the step of each instruction is
+     * kept: the handlers still read their operands from memory and count their own cycles, so running a block saves
+     * the opcode fetch and nothing else. Blocks never cross a 1KB memory page and are keyed by physical address, so
+     * they stay valid when the mapper pages their bank out and back in
+     */
+    struct DecodedBlock {
+        // Physical address of the first instruction and generation of its page when the block was decoded
+        uint32_t physical;
+        uint32_t generation;
+        int length;
+        // The step of every instruction. Instruction sizes aren't stored, each step has its own as a constant
+        std::array<BlockStep, BLOCK_MAX_OPCODES> steps;
+        // Runs left before the block is translated, which stays at 0 for blocks outside cartridge ROM, and its
+        // translation once it is hot
+        int countdown;
+        NativeBlock native;
+    };
+
     Memory* m_mem;
+    IoBus* m_io;
     Registers m_reg;
     Registers m_shadow;
-    std::vector<Opcodes> m_opcode_table;
-    std::vector<Opcodes> m_opcode_table_cb;
-    std::vector<Opcodes> m_opcode_table_dd;
-    std::vector<Opcodes> m_opcode_table_ddcb;
-    std::vector<Opcodes> m_opcode_table_ed;
-    std::vector<Opcodes> m_opcode_table_fd;
-    std::vector<Opcodes> m_opcode_table_fdcb;
 
     // How many cycles it took to execute the last opcode
     int m_cycles;
 
-    void setup_opcode_table(std::vector<Opcodes> &table);
+    // Flags of the last ALU operation that haven't been written to m_reg.F yet
+    LazyFlags m_lazy_flags;
+
+    // Instructions executed since the last reset. It never wraps, so it also tells apart any two points of the
+    // execution. The visible R register is m_reg.R advanced by this count
+    uint64_t m_instruction_count;
+
+    // Set by halt until an interrupt wakes the CPU up
+    bool m_halted;
+
+    IdleLoop m_idle_loop;
+
+    // Cycles executed by the current run() and the cycle at which it has to return
+    unsigned long m_run_cycles;
+    unsigned long m_run_deadline;
+    // Where run() has to return. The execution loop stops before it, at m_run_deadline, to take interrupts
+    unsigned long m_run_budget;
+
+    // Direct mapped cache of decoded blocks, indexed by a hash of their physical address
+    std::vector<DecodedBlock> m_blocks;
 
-    void setup_opcode_table_cb(std::vector<Opcodes> &table);
+    // Memory code generation when the current block started. A block is left as soon as it changes
+    uint32_t m_block_code_generation;
+
+    JitCodeBuffer m_jit;
+
+    // Block of the ahead of time translated program starting at every physical address of the cartridge ROM, nullptr
+    // where there is none. Empty when no program is in use
+    std::vector<NativeBlock> m_aot_blocks;
+
+    // Interrupt enable flip-flops
+    bool m_iff1;
+    bool m_iff2;
+
+    uint8_t m_interrupt_mode;
+
+    // Bits of m_pending_interrupts
+    static constexpr uint8_t INTERRUPT_IRQ = 0x01;
+    static constexpr uint8_t INTERRUPT_NMI = 0x02;
+
+    // Interrupt requests that haven't been taken yet. The IRQ bit follows the level of the line, the NMI bit is
+    // cleared when the interrupt is taken
+    uint8_t m_pending_interrupts;
+
+    // m_instruction_count right after the last ei. Interrupts wait while it hasn't changed
+    uint64_t m_ei_instruction;
 
     void execute_opcode(uint8_t opcode);
 
     /**
-     * Increments the refresh register by 1. Once the lower 7 bits of the register are 1, they are all reset to 0
+     * Executes instructions until m_run_deadline, with the interpreter the library was built with
+     */
+    void run_until_deadline();
+
+    /**
+     * Takes the pending interrupt with the highest priority, if interrupts are enabled
+     * @return Whether an interrupt was taken, m_cycles is set to its length if so
+     */
+    bool take_interrupt();
+
+    /**
+     * Wakes the CPU up from halt, pushes the PC and jumps to the interrupt routine
+     */
+    void enter_interrupt(uint16_t address);
+
+    /**
+     * Executes an opcode and moves the PC past it. There is one specialisation for every entry of the opcode tables,
+     * which the switch, the threaded interpreter and the decoded blocks all share
+     */
+    template<uint16_t Opcode>
+    void op();
+
+    /**
+     * Executes an opcode as part of a block, including the instruction and cycle accounting
+     * @return Whether the next instruction of the block can run: the opcode didn't jump, the run deadline hasn't been
+     * reached and the memory map and the block's code haven't changed
+     */
+    template<uint16_t Opcode>
+    bool block_step();
+
+    /**
+     * Executes the decoded block at the PC, decoding it first if it isn't cached. Leaves the block early if one of its
+     * steps asks to
+     */
+    void run_block();
+
+    /**
+     * Decodes the instructions starting at the PC into a block. Stops at the end of the memory page, after
+     * BLOCK_MAX_OPCODES instructions or before an opcode that isn't implemented, so the block can be empty
+     */
+    void decode_block(DecodedBlock& block, uint32_t physical);
+
+    /**
+     * Translates a hot ROM block to native code. If the code buffer is full, every translation is discarded first.
+     * The PC has to be at the start of the block
      */
-    void increment_refresh_r();
+    void translate_block(DecodedBlock& block);
+
+    // Emits the native code of a block, see Z80_Jit.cpp
+    struct BlockTranslator;
+
+    /**
+     * Executes instructions until m_run_deadline, running the blocks of the ahead of time translated program wherever
+     * the PC reaches one and the switch interpreter everywhere else
+     */
+    void run_aot();
+
+    /**
+     * Builds the value of F, including any pending lazy flags, without changing the CPU state
+     */
+    uint8_t evaluate_flags() const;
+
+    /**
+     * Writes any pending lazy flags to m_reg.F. Must be called before F is read or modified directly
+     */
+    void resolve_flags();
+
+    /**
+     * Records an ALU operation so its flags can be built later
+     * @param op The operation
+     * @param affected Mask of the F bits that the operation changes, all others keep their current value
+     * @param operand The value of the destination before the operation
+     * @param result The value of the destination after the operation
+     */
+    void set_lazy_flags(FlagOp op, uint8_t affected, uint16_t operand, uint16_t result);
+
+    /**
+     * Gets the value of the refresh register. The lower 7 bits are incremented by every instruction and wrap around
+     * without touching bit 7
+     */
+    uint8_t refresh_r() const;
+
+    /**
+     * Called by taken backwards branches. If the loop came back to the same state as the last time it reached the
+     * target and nothing was written in between, every iteration until the run deadline is the same, so they are
+     * skipped at once. The cycles and the R register end up as if they had been executed
+     * @param target The address being jumped to
+     */
+    void idle_branch(uint16_t target);
+
+    /**
+     * Reads an 8-bit operand. The operand is known at compile time, so this is a plain register or memory access
+     */
+    template<Operand8 Operand>
+    uint8_t read_operand8();
+
+    template<Operand8 Operand>
+    void write_operand8(uint8_t value);
+
+    /**
+     * @return The cycles an operand adds to the register form of an instruction, for the memory access of (hl) and n
+     */
+    template<Operand8 Operand>
+    static constexpr int operand8_cycles();
+
+    /**
+     * @return The cycles of the prefix and the displacement, for the operands that need an index register
+     */
+    template<Operand8 Operand>
+    static constexpr int index_cycles();
+
+    /**
+     * @return Whether the operand is in memory
+     */
+    template<Operand8 Operand>
+    static constexpr bool is_memory_operand();
 
     // Opcode Instructions
     // Reference: https://clrhome.org/table/#%20
@@ -90,12 +453,95 @@ private:
     void load_16bit(uint16_t &reg);
 
     /**
-     * Loads the value in the next byte from the PC into a 8-bit register
+     * Loads an 8-bit operand into another
      * Used for opcodes with the format
+     *      ld r, r
+     *      ld r, (hl)
+     *      ld (hl), r
      *      ld r, n
-     * @param reg 8-bit register
+     *      ld (hl), n
+     * @tparam Dst The operand that is written
+     * @tparam Src The operand that is read
+     */
+    template<Operand8 Dst, Operand8 Src>
+    void load_8bit();
+
+    /**
+     * Loads the byte after the displacement into memory at an index register plus the displacement
+     * Used for opcodes with the format
+     *      ld (ix+d), n
+     *      ld (iy+d), n
+     * @tparam Dst (ix+d) or (iy+d)
+     */
+    template<Operand8 Dst>
+    void load_8bit_indexed_n();
+
+    /**
+     * Loads the value at the address in the next 2 bytes from the PC into a 16-bit register
+     * Used for opcodes with the format
+     *      ld rr, (nn)
+     * @param reg 16-bit register
+     */
+    void load_16bit_address(uint16_t &reg);
+
+    /**
+     * Writes a 16-bit register to the address in the next 2 bytes from the PC
+     * Used for opcodes with the format
+     *      ld (nn), rr
+     * @param reg 16-bit register
+     */
+    void write_16bit_address(uint16_t reg);
+
+    /**
+     * Loads the value at the address in the next 2 bytes from the PC into A
+     * Used for opcodes with the format
+     *      ld a, (nn)
+     */
+    void load_A_address();
+
+    /**
+     * Writes A to the address in the next 2 bytes from the PC
+     * Used for opcodes with the format
+     *      ld (nn), a
      */
-    void load_8bit(uint8_t &reg);
+    void write_A_address();
+
+    /**
+     * Copies a 16-bit register into SP
+     * Used for opcodes with the format
+     *      ld sp, hl
+     *      ld sp, ix
+     *      ld sp, iy
+     * @param reg 16-bit register
+     */
+    void load_SP(uint16_t reg);
+
+    /**
+     * Loads A into the interrupt vector register
+     * Used for opcodes with the format
+     *      ld i, a
+     */
+    void load_I_A();
+
+    /**
+     * Loads A into the refresh register
+     * Used for opcodes with the format
+     *      ld r, a
+     */
+    void load_R_A();
+
+    /**
+     * Loads the interrupt vector or the refresh register into A
+     * Used for opcodes with the format
+     *      ld a, i
+     *      ld a, r
+     * Flags affected:
+     *      SZ53: As defined
+     *      HN: Reset
+     *      P/V: Copy of IFF2
+     * @param value The value of the register
+     */
+    void load_A_IR(uint8_t value);
 
     /**
      * Loads into the 8-bit register the value at the address pointed to by the 16-bit register
@@ -123,15 +569,17 @@ private:
     void inc_16bit(uint16_t &reg);
 
     /**
-     * Increments the 8-bit register by 1
+     * Increments an 8-bit operand by 1
      * Used for opcodes with the format
      *      inc r
+     *      inc (hl)
      * Flags affected:
      *      NHZS: As defined
      *      P/V: Detects overflow
-     * @param reg 8-bit register
+     * @tparam Operand 8-bit register or (hl)
      */
-    void inc_8bit(uint8_t &reg);
+    template<Operand8 Operand>
+    void inc_8bit();
 
     /**
      * Decrements the 16-bit register by 1
@@ -142,15 +590,17 @@ private:
     void dec_16bit(uint16_t &reg);
 
     /**
-     * Decrements the 8-bit register by 1
+     * Decrements an 8-bit operand by 1
      * Used for opcodes with the format
      *      dec r
+     *      dec (hl)
      * Flags affected:
      *      NHZS: As defined
      *      P/V: Detects overflow
-     * @param reg 8-bit register
+     * @tparam Operand 8-bit register or (hl)
      */
-    void dec_8bit(uint8_t &reg);
+    template<Operand8 Operand>
+    void dec_8bit();
 
     /**
      * The contents of A are rotated left one bit position.
@@ -174,6 +624,68 @@ private:
      */
     void rrca();
 
+    /**
+     * The contents of A are rotated left one bit position through the carry flag.
+     * The contents of bit 7 are copied to the carry flag and the previous carry to bit 0.
+     * Used for opcodes with the format:
+     *      rla
+     * Flags affected:
+     *      NH: Reset
+     *      C: As defined
+     */
+    void rla();
+
+    /**
+     * The contents of A are rotated right one bit position through the carry flag.
+     * The contents of bit 0 are copied to the carry flag and the previous carry to bit 7.
+     * Used for opcodes with the format:
+     *      rra
+     * Flags affected:
+     *      NH: Reset
+     *      C: As defined
+     */
+    void rra();
+
+    /**
+     * Adjusts A to a binary coded decimal after an addition or subtraction of two BCD values
+     * Used for opcodes with the format:
+     *      daa
+     * Flags affected:
+     *      SZHPC: As defined
+     *      N: Not affected
+     */
+    void daa();
+
+    /**
+     * Inverts all the bits of A
+     * Used for opcodes with the format:
+     *      cpl
+     * Flags affected:
+     *      HN: Set
+     */
+    void cpl();
+
+    /**
+     * Sets the carry flag
+     * Used for opcodes with the format:
+     *      scf
+     * Flags affected:
+     *      C: Set
+     *      HN: Reset
+     */
+    void scf();
+
+    /**
+     * Inverts the carry flag
+     * Used for opcodes with the format:
+     *      ccf
+     * Flags affected:
+     *      C: Inverted
+     *      H: Previous carry
+     *      N: Reset
+     */
+    void ccf();
+
     /**
      * Exchanges the values between two 16-bit registers
      * Used for opcodes with the format:
@@ -184,24 +696,724 @@ private:
     void ex_16bit_registers(uint16_t &reg1, uint16_t &reg2);
 
     /**
-     * Adds the value of a register to HL
+     * Exchanges AF with the shadow AF. Any pending lazy flags are written to F first
+     * Used for opcodes with the format:
+     *      ex af, af'
+     */
+    void ex_af();
+
+    /**
+     * Exchanges BC, DE and HL with their shadow registers
+     * Used for opcodes with the format:
+     *      exx
+     */
+    void exx();
+
+    /**
+     * Exchanges a 16-bit register with the value at the top of the stack
+     * Used for opcodes with the format:
+     *      ex (sp), hl
+     *      ex (sp), ix
+     *      ex (sp), iy
+     * @param reg 16-bit register
+     */
+    void ex_SP(uint16_t &reg);
+
+    /**
+     * Adds a value to a 16-bit register
      * Used for opcodes with the format:
      *      add hl, rr
+     *      add ix, rr
+     *      add iy, rr
      * Flags affected:
      *      CNH: As defined
      * @param reg 16-bit register
+     * @param value The value to add
+     */
+    void add_16bit(uint16_t &reg, uint16_t value);
+
+    /**
+     * Adds a value and the carry flag to HL
+     * Used for opcodes with the format:
+     *      adc hl, rr
+     * Flags affected:
+     *      SZHVNC: As defined
+     * @param value The value to add
+     */
+    void adc_HL(uint16_t value);
+
+    /**
+     * Subtracts a value and the carry flag from HL
+     * Used for opcodes with the format:
+     *      sbc hl, rr
+     * Flags affected:
+     *      SZHVNC: As defined
+     * @param value The value to subtract
+     */
+    void sbc_HL(uint16_t value);
+
+    /**
+     * Negates A
+     * Used for opcodes with the format:
+     *      neg
+     * Flags affected:
+     *      SZHVNC: As defined, as in 0 - A
      */
-    void add_HL(uint16_t reg);
+    void neg();
+
+    /**
+     * Rotates the 3 digits in the lower half of A and (HL) one digit left
+     * Used for opcodes with the format:
+     *      rld
+     * Flags affected:
+     *      SZ53P: As defined
+     *      HN: Reset
+     */
+    void rld();
+
+    /**
+     * Rotates the 3 digits in the lower half of A and (HL) one digit right
+     * Used for opcodes with the format:
+     *      rrd
+     * Flags affected:
+     *      SZ53P: As defined
+     *      HN: Reset
+     */
+    void rrd();
+
+    /**
+     * Rotates or shifts an 8-bit operand
+     * Used for opcodes with the format:
+     *      rlc r, rrc r, rl r, rr r, sla r, sra r, sll r, srl r
+     *      the same with (hl), (ix+d) or (iy+d)
+     * Flags affected:
+     *      SZ53P: As defined
+     *      HN: Reset
+     *      C: The bit that was shifted out
+     * @tparam Op The rotation or shift
+     * @tparam Operand 8-bit register, (hl), (ix+d) or (iy+d)
+     * @tparam Copy The register the result is also copied to by the undocumented (ix+d) and (iy+d) forms
+     */
+    template<Rotation Op, Operand8 Operand, Operand8 Copy = Operand>
+    void rotate();
+
+    /**
+     * Tests a bit of an 8-bit operand
+     * Used for opcodes with the format:
+     *      bit b, r
+     *      bit b, (hl)
+     * Flags affected:
+     *      ZP: Set if the bit is 0
+     *      S: Set if bit 7 is tested and set
+     *      H: Set
+     *      N: Reset
+     *      53: Copied from the operand
+     * @tparam Bit The bit to test
+     * @tparam Operand 8-bit register, (hl), (ix+d) or (iy+d)
+     */
+    template<int Bit, Operand8 Operand>
+    void test_bit();
+
+    /**
+     * Resets or sets a bit of an 8-bit operand
+     * Used for opcodes with the format:
+     *      res b, r
+     *      set b, r
+     *      the same with (hl), (ix+d) or (iy+d)
+     * @tparam Bit The bit to change
+     * @tparam Set Whether the bit is set or reset
+     * @tparam Operand 8-bit register, (hl), (ix+d) or (iy+d)
+     * @tparam Copy The register the result is also copied to by the undocumented (ix+d) and (iy+d) forms
+     */
+    template<int Bit, bool Set, Operand8 Operand, Operand8 Copy = Operand>
+    void change_bit();
+
+    /**
+     * Adds a value to A
+     * Used for opcodes with the format:
+     *      add a, r
+     *      add a, (hl)
+     *      add a, n
+     * Flags affected:
+     *      SZHVNC: As defined
+     * @param value The value to add
+     * @param cycles The number of cycles the opcode takes
+     */
+    void add_A(uint8_t value, int cycles = 4);
+
+    /**
+     * Same as add_A, for the operand of the instruction
+     * @tparam Src 8-bit register, (hl) or n
+     */
+    template<Operand8 Src>
+    void add_A();
+
+    /**
+     * Adds a value and the carry flag to A
+     * Used for opcodes with the format:
+     *      adc a, r
+     *      adc a, (hl)
+     *      adc a, n
+     * Flags affected:
+     *      SZHVNC: As defined
+     * @param value The value to add
+     * @param cycles The number of cycles the opcode takes
+     */
+    void adc_A(uint8_t value, int cycles = 4);
+
+    /**
+     * Same as adc_A, for the operand of the instruction
+     * @tparam Src 8-bit register, (hl) or n
+     */
+    template<Operand8 Src>
+    void adc_A();
+
+    /**
+     * Subtracts a value from A
+     * Used for opcodes with the format:
+     *      sub r
+     *      sub (hl)
+     *      sub n
+     * Flags affected:
+     *      SZHVNC: As defined
+     * @param value The value to subtract
+     * @param cycles The number of cycles the opcode takes
+     */
+    void sub_A(uint8_t value, int cycles = 4);
+
+    /**
+     * Same as sub_A, for the operand of the instruction
+     * @tparam Src 8-bit register, (hl) or n
+     */
+    template<Operand8 Src>
+    void sub_A();
+
+    /**
+     * Subtracts a value and the carry flag from A
+     * Used for opcodes with the format:
+     *      sbc a, r
+     *      sbc a, (hl)
+     *      sbc a, n
+     * Flags affected:
+     *      SZHVNC: As defined
+     * @param value The value to subtract
+     * @param cycles The number of cycles the opcode takes
+     */
+    void sbc_A(uint8_t value, int cycles = 4);
+
+    /**
+     * Same as sbc_A, for the operand of the instruction
+     * @tparam Src 8-bit register, (hl) or n
+     */
+    template<Operand8 Src>
+    void sbc_A();
+
+    /**
+     * Bitwise AND of A and a value, stored in A
+     * Used for opcodes with the format:
+     *      and r
+     *      and (hl)
+     *      and n
+     * Flags affected:
+     *      SZP: As defined
+     *      H: Set
+     *      NC: Reset
+     * @param value The value to AND with A
+     * @param cycles The number of cycles the opcode takes
+     */
+    void and_A(uint8_t value, int cycles = 4);
+
+    /**
+     * Same as and_A, for the operand of the instruction
+     * @tparam Src 8-bit register, (hl) or n
+     */
+    template<Operand8 Src>
+    void and_A();
+
+    /**
+     * Bitwise XOR of A and a value, stored in A
+     * Used for opcodes with the format:
+     *      xor r
+     *      xor (hl)
+     *      xor n
+     * Flags affected:
+     *      SZP: As defined
+     *      HNC: Reset
+     * @param value The value to XOR with A
+     * @param cycles The number of cycles the opcode takes
+     */
+    void xor_A(uint8_t value, int cycles = 4);
+
+    /**
+     * Same as xor_A, for the operand of the instruction
+     * @tparam Src 8-bit register, (hl) or n
+     */
+    template<Operand8 Src>
+    void xor_A();
+
+    /**
+     * Bitwise OR of A and a value, stored in A
+     * Used for opcodes with the format:
+     *      or r
+     *      or (hl)
+     *      or n
+     * Flags affected:
+     *      SZP: As defined
+     *      HNC: Reset
+     * @param value The value to OR with A
+     * @param cycles The number of cycles the opcode takes
+     */
+    void or_A(uint8_t value, int cycles = 4);
+
+    /**
+     * Same as or_A, for the operand of the instruction
+     * @tparam Src 8-bit register, (hl) or n
+     */
+    template<Operand8 Src>
+    void or_A();
+
+    /**
+     * Subtracts a value from A without storing the result
+     * Used for opcodes with the format:
+     *      cp r
+     *      cp (hl)
+     *      cp n
+     * Flags affected:
+     *      SZHVNC: As defined
+     *      53: Copied from the value instead of the result
+     * @param value The value to compare A with
+     * @param cycles The number of cycles the opcode takes
+     */
+    void cp_A(uint8_t value, int cycles = 4);
+
+    /**
+     * Same as cp_A, for the operand of the instruction
+     * @tparam Src 8-bit register, (hl) or n
+     */
+    template<Operand8 Src>
+    void cp_A();
 
     /**
      * Decrements the B register and jumps the PC forwards or 
      * backwards by the amount described in the next byte. 
-     * The jump is measured from the start of the opcode instruction.
+     * The jump is measured from the start of the next instruction.
      * Used for opcodes with the format:
      *      djnz label
      */
     void djnz(); 
+
+    /**
+     * Jumps the PC forwards or backwards by the amount described in the next byte if the condition is true.
+     * The jump is measured from the start of the next instruction.
+     * Used for opcodes with the format:
+     *      jr d
+     *      jr cc, d
+     * @param condition Whether the jump is taken
+     */
+    void jump_relative(bool condition);
+
+    /**
+     * Jumps to the address in the next 2 bytes if the condition is true
+     * Used for opcodes with the format:
+     *      jp nn
+     *      jp cc, nn
+     * @param condition Whether the jump is taken
+     */
+    void jump(bool condition);
+
+    /**
+     * Jumps to the address in a 16-bit register
+     * Used for opcodes with the format:
+     *      jp (hl)
+     *      jp (ix)
+     *      jp (iy)
+     * @param reg 16-bit register
+     */
+    void jump_register(uint16_t reg);
+
+    /**
+     * Returns from an interrupt routine, restoring IFF1 from IFF2
+     * Used for opcodes with the format:
+     *      reti
+     *      retn
+     */
+    void return_from_interrupt();
+
+    /**
+     * Selects how the CPU responds to maskable interrupts
+     * Used for opcodes with the format:
+     *      im 0, im 1, im 2
+     * @param mode The interrupt mode
+     */
+    void set_interrupt_mode(uint8_t mode);
+
+    /**
+     * Pushes the address of the next instruction and jumps to the address in the next 2 bytes if the condition is true
+     * Used for opcodes with the format:
+     *      call nn
+     *      call cc, nn
+     * @param condition Whether the call is made
+     */
+    void call(bool condition);
+
+    /**
+     * Pops the PC from the stack if the condition is true
+     * Used for opcodes with the format:
+     *      ret
+     *      ret cc
+     * @param condition Whether the return is taken
+     * @param cycles The number of cycles the opcode takes when the return is taken
+     */
+    void ret(bool condition, int cycles = 11);
+
+    /**
+     * Pushes the address of the next instruction and jumps to one of the restart addresses in page 0
+     * Used for opcodes with the format:
+     *      rst p
+     * @param address The restart address, a multiple of 8
+     */
+    void rst(uint16_t address);
+
+    /**
+     * Pushes a 16-bit value onto the stack
+     * Used for opcodes with the format:
+     *      push rr
+     * @param value The value to push
+     */
+    void push_16bit(uint16_t value);
+
+    /**
+     * Pops the value at the top of the stack into a 16-bit register
+     * Used for opcodes with the format:
+     *      pop rr
+     * @param reg 16-bit register
+     */
+    void pop_16bit(uint16_t &reg);
+
+    /**
+     * Pushes AF onto the stack. Any pending lazy flags are written to F first
+     * Used for opcodes with the format:
+     *      push af
+     */
+    void push_af();
+
+    /**
+     * Pops AF from the stack, replacing any pending lazy flags
+     * Used for opcodes with the format:
+     *      pop af
+     */
+    void pop_af();
+
+    /**
+     * Disables or enables the maskable interrupts
+     * Used for opcodes with the format:
+     *      di
+     *      ei
+     * @param enable Whether interrupts are enabled
+     */
+    void set_interrupts(bool enable);
+
+    /**
+     * Suspends the CPU until an interrupt. It keeps executing nops in the meantime, which move R on, so the PC stays
+     * on the halt. As nothing can happen before the run deadline, all the nops up to it are executed at once
+     * Used for opcodes with the format:
+     *      halt
+     */
+    void halt();
+
+    /**
+     * Executes a prefixed instruction, with a single lookup of its opcode in the prefixed opcode table
+     * Used for opcodes with the format:
+     *      cb xx, dd xx, ed xx, fd xx, dd cb d xx, fd cb d xx
+     */
+    void prefix();
+
+    /**
+     * Opcodes missing from the 0xED table do nothing
+     * Used for opcodes with the format:
+     *      ed xx
+     */
+    void invalid_ed();
+
+    /**
+     * Compares A with the byte at (HL), then moves HL in the given direction and decrements BC.
+     * The repeating forms go on until BC is 0 or A matches
+     * Used for opcodes with the format:
+     *      cpi, cpd, cpir, cpdr
+     * Flags affected:
+     *      SZH: As in cp (hl)
+     *      N: Set
+     *      P/V: Set if BC is not 0
+     *      53: Copied from bits 3 and 1 of A minus the byte minus H
+     * @param direction 1 to increment HL, -1 to decrement it
+     * @param repeat Whether to repeat until BC is 0 or A matches
+     */
+    void block_compare(int direction, bool repeat);
+
+    /**
+     * Copies the byte at (HL) to (DE), then moves HL and DE in the given direction and decrements BC.
+     * The repeating forms go on until BC is 0. All the iterations that fit before the run deadline are executed at
+     * once, copying through the page tables where possible
+     * Used for opcodes with the format:
+     *      ldi, ldd, ldir, lddr
+     * Flags affected:
+     *      HN: Reset
+     *      P/V: Set if BC is not 0
+     *      53: Copied from bits 3 and 1 of A plus the copied byte
+     * @param direction 1 to increment HL and DE, -1 to decrement them
+     * @param repeat Whether to repeat until BC is 0
+     */
+    void block_load(int direction, bool repeat);
+
+    /**
+     * Copies count bytes from src to dest one at a time, in the given direction, like count iterations of ldi or ldd
+     * @return The last byte copied
+     */
+    uint8_t block_transfer(uint16_t dest, uint16_t src, unsigned long count, int direction);
+
+    /**
+     * Writes A to the port given by the byte after the opcode
+     * Used for opcodes with the format:
+     *      out (n), a
+     */
+    void output_n();
+
+    /**
+     * Reads A from the port given by the byte after the opcode
+     * Used for opcodes with the format:
+     *      in a, (n)
+     * Flags affected:
+     *      None
+     */
+    void input_n();
+
+    /**
+     * Reads the port in C
+     * Used for opcodes with the format:
+     *      in r, (c), in (c)
+     * Flags affected:
+     *      SZ53P: As defined
+     *      HN: Reset
+     * @return The value read
+     */
+    uint8_t input_c();
+
+    /**
+     * Writes to the port in C
+     * Used for opcodes with the format:
+     *      out (c), r, out (c), 0
+     */
+    void output_c(uint8_t value);
+
+    /**
+     * Reads the port in C into (HL), then moves HL in the given direction and decrements B.
+     * The repeating forms go on until B is 0. All the iterations that fit before the run deadline are executed at once
+     * Used for opcodes with the format:
+     *      ini, ind, inir, indr
+     * Flags affected:
+     *      See block_io_flags
+     * @param direction 1 to increment HL, -1 to decrement it
+     * @param repeat Whether to repeat until B is 0
+     */
+    void block_input(int direction, bool repeat);
+
+    /**
+     * Decrements B, then writes the byte at (HL) to the port in C and moves HL in the given direction.
+     * The repeating forms go on until B is 0. All the iterations that fit before the run deadline are executed at once
+     * Used for opcodes with the format:
+     *      outi, outd, otir, otdr
+     * Flags affected:
+     *      See block_io_flags
+     * @param direction 1 to increment HL, -1 to decrement it
+     * @param repeat Whether to repeat until B is 0
+     */
+    void block_output(int direction, bool repeat);
+
+    /**
+     * Sets the flags of the block I/O instructions
+     * Flags affected:
+     *      SZ53: As defined for B
+     *      N: Bit 7 of the transferred byte
+     *      HC: Set if sum overflows 8 bits
+     *      P: Parity of the low 3 bits of sum xor B
+     * @param value The transferred byte
+     * @param sum The byte plus C plus or minus 1 for the inputs, and plus L for the outputs
+     */
+    void block_io_flags(uint8_t value, unsigned int sum);
 };
 
+template<Operand8 Operand>
+inline uint8_t Z80::read_operand8() {
+    if constexpr (Operand == Operand8::B) return m_reg.B;
+    if constexpr (Operand == Operand8::C) return m_reg.C;
+    if constexpr (Operand == Operand8::D) return m_reg.D;
+    if constexpr (Operand == Operand8::E) return m_reg.E;
+    if constexpr (Operand == Operand8::H) return m_reg.H;
+    if constexpr (Operand == Operand8::L) return m_reg.L;
+    if constexpr (Operand == Operand8::HL_PTR) return m_mem->read(m_reg.HL);
+    if constexpr (Operand == Operand8::A) return m_reg.A;
+    if constexpr (Operand == Operand8::N) return m_mem->read(m_reg.PC + 1);
+    if constexpr (Operand == Operand8::IXH) return m_reg.IXH;
+    if constexpr (Operand == Operand8::IXL) return m_reg.IXL;
+    if constexpr (Operand == Operand8::IYH) return m_reg.IYH;
+    if constexpr (Operand == Operand8::IYL) return m_reg.IYL;
+    // The PC is past the prefix, so the displacement is the byte after the opcode (or after 0xCB)
+    if constexpr (Operand == Operand8::IX_D) return m_mem->read(m_reg.IX + (int8_t) m_mem->read(m_reg.PC + 1));
+    if constexpr (Operand == Operand8::IY_D) return m_mem->read(m_reg.IY + (int8_t) m_mem->read(m_reg.PC + 1));
+}
+
+template<Operand8 Operand>
+inline void Z80::write_operand8(uint8_t value) {
+    static_assert(Operand != Operand8::N, "An immediate can't be written to");
+
+    if constexpr (Operand == Operand8::B) m_reg.B = value;
+    if constexpr (Operand == Operand8::C) m_reg.C = value;
+    if constexpr (Operand == Operand8::D) m_reg.D = value;
+    if constexpr (Operand == Operand8::E) m_reg.E = value;
+    if constexpr (Operand == Operand8::H) m_reg.H = value;
+    if constexpr (Operand == Operand8::L) m_reg.L = value;
+    if constexpr (Operand == Operand8::HL_PTR) m_mem->write(m_reg.HL, value);
+    if constexpr (Operand == Operand8::A) m_reg.A = value;
+    if constexpr (Operand == Operand8::IXH) m_reg.IXH = value;
+    if constexpr (Operand == Operand8::IXL) m_reg.IXL = value;
+    if constexpr (Operand == Operand8::IYH) m_reg.IYH = value;
+    if constexpr (Operand == Operand8::IYL) m_reg.IYL = value;
+    if constexpr (Operand == Operand8::IX_D) m_mem->write(m_reg.IX + (int8_t) m_mem->read(m_reg.PC + 1), value);
+    if constexpr (Operand == Operand8::IY_D) m_mem->write(m_reg.IY + (int8_t) m_mem->read(m_reg.PC + 1), value);
+}
+
+template<Operand8 Operand>
+constexpr bool Z80::is_memory_operand() {
+    return Operand == Operand8::HL_PTR || Operand == Operand8::IX_D || Operand == Operand8::IY_D;
+}
+
+template<Operand8 Operand>
+constexpr int Z80::operand8_cycles() {
+    return (is_memory_operand<Operand>() || Operand == Operand8::N) ? 3 : 0;
+}
+
+template<Operand8 Operand>
+constexpr int Z80::index_cycles() {
+    // The prefix is fetched like an opcode (4 cycles) and adding the displacement takes another 8
+    if constexpr (Operand == Operand8::IX_D || Operand == Operand8::IY_D) return 12;
+    if constexpr (Operand == Operand8::IXH || Operand == Operand8::IXL ||
+                  Operand == Operand8::IYH || Operand == Operand8::IYL) return 4;
+    return 0;
+}
+
+template<Operand8 Dst, Operand8 Src>
+inline void Z80::load_8bit() {
+    write_operand8<Dst>(read_operand8<Src>());
+    // Both operands can be halves of the same index register, which only has one prefix
+    m_cycles = 4 + operand8_cycles<Dst>() + operand8_cycles<Src>() + std::max(index_cycles<Dst>(), index_cycles<Src>());
+}
+
+template<Operand8 Dst>
+inline void Z80::load_8bit_indexed_n() {
+    write_operand8<Dst>(m_mem->read(m_reg.PC + 2));
+    // The displacement is added while n is read
+    m_cycles = 19;
+}
+
+template<Operand8 Operand>
+inline void Z80::inc_8bit() {
+    uint8_t operand = read_operand8<Operand>();
+    uint8_t result = operand + 1;
+    write_operand8<Operand>(result);
+
+    set_lazy_flags(FlagOp::INC8, INC_DEC_FLAGS, operand, result);
+    // Memory is read and written back
+    m_cycles = 4 + 2 * operand8_cycles<Operand>() + (is_memory_operand<Operand>() ? 1 : 0) + index_cycles<Operand>();
+}
+
+template<Operand8 Operand>
+inline void Z80::dec_8bit() {
+    uint8_t operand = read_operand8<Operand>();
+    uint8_t result = operand - 1;
+    write_operand8<Operand>(result);
+
+    set_lazy_flags(FlagOp::DEC8, INC_DEC_FLAGS, operand, result);
+    m_cycles = 4 + 2 * operand8_cycles<Operand>() + (is_memory_operand<Operand>() ? 1 : 0) + index_cycles<Operand>();
+}
+
+#define Z80_ALU_OPERAND8(name)                                                                      \
+    template<Operand8 Src>                                                                          \
+    inline void Z80::name() {                                                                       \
+        name(read_operand8<Src>(), 4 + operand8_cycles<Src>() + index_cycles<Src>());               \
+    }
+Z80_ALU_OPERAND8(add_A)
+Z80_ALU_OPERAND8(adc_A)
+Z80_ALU_OPERAND8(sub_A)
+Z80_ALU_OPERAND8(sbc_A)
+Z80_ALU_OPERAND8(and_A)
+Z80_ALU_OPERAND8(xor_A)
+Z80_ALU_OPERAND8(or_A)
+Z80_ALU_OPERAND8(cp_A)
+#undef Z80_ALU_OPERAND8
+
+// Cycles of the instructions in the 0xCB tables: 8 for registers, 15 for (hl) and 23 for (ix+d) and (iy+d)
+template<Operand8 Operand>
+constexpr int cb_cycles() {
+    return Operand == Operand8::HL_PTR ? 15 : (Operand == Operand8::IX_D || Operand == Operand8::IY_D) ? 23 : 8;
+}
+
+template<Rotation Op, Operand8 Operand, Operand8 Copy>
+inline void Z80::rotate() {
+    uint8_t value = read_operand8<Operand>();
+    uint8_t result = 0;
+    bool carry = false;
+
+    if constexpr (Op == Rotation::RLC || Op == Rotation::RL || Op == Rotation::SLA || Op == Rotation::SLL) {
+        carry = value & 0x80;
+        result = value << 1;
+        if constexpr (Op == Rotation::RLC) result |= carry ? 0x01 : 0;
+        if constexpr (Op == Rotation::RL) result |= is_flag_set(FLAGS::CARRY_C) ? 0x01 : 0;
+        if constexpr (Op == Rotation::SLL) result |= 0x01;
+    } else {
+        carry = value & 0x01;
+        result = value >> 1;
+        if constexpr (Op == Rotation::RRC) result |= carry ? 0x80 : 0;
+        if constexpr (Op == Rotation::RR) result |= is_flag_set(FLAGS::CARRY_C) ? 0x80 : 0;
+        if constexpr (Op == Rotation::SRA) result |= value & 0x80;
+    }
+
+    write_operand8<Operand>(result);
+    if constexpr (Copy != Operand) {
+        write_operand8<Copy>(result);
+    }
+
+    m_lazy_flags.op = FlagOp::NONE;
+    m_reg.F = SZ53P_FLAGS[result] | (carry ? flag_mask(FLAGS::CARRY_C) : 0);
+    m_cycles = cb_cycles<Operand>();
+}
+
+template<int Bit, Operand8 Operand>
+inline void Z80::test_bit() {
+    uint8_t value = read_operand8<Operand>();
+    bool set = value & (1 << Bit);
+
+    resolve_flags();
+    m_reg.F = (m_reg.F & flag_mask(FLAGS::CARRY_C)) | flag_mask(FLAGS::HALF_CARRY_H) | (value & FLAGS_53);
+    m_reg.F |= set ? 0 : flag_mask(FLAGS::ZERO_Z) | flag_mask(FLAGS::PARITY_P);
+    m_reg.F |= (Bit == 7 && set) ? flag_mask(FLAGS::SIGN_S) : 0;
+    // Nothing is written back
+    m_cycles = cb_cycles<Operand>() - (is_memory_operand<Operand>() ? 3 : 0);
+}
+
+template<int Bit, bool Set, Operand8 Operand, Operand8 Copy>
+inline void Z80::change_bit() {
+    uint8_t result = read_operand8<Operand>();
+    if constexpr (Set) {
+        result |= 1 << Bit;
+    } else {
+        result &= ~(1 << Bit);
+    }
+
+    write_operand8<Operand>(result);
+    if constexpr (Copy != Operand) {
+        write_operand8<Copy>(result);
+    }
+    m_cycles = cb_cycles<Operand>();
+}
 
 #endif //SOMOS_Z80_H
@@ -0,0 +1,137 @@
+/**
+ * Z80 FLAG TABLES
+ *
+ * Precomputed values of F for the 8-bit ALU operations, including the undocumented copies of bits 3 and 5 of the
+ * result. They are generated at compile time and shared by every Z80 instance.
+ * Flag reference: http://www.z80.info/z80sflag.htm
+ *
+ * Tables indexed by (operand, result) use the index (operand << 8) | result, where operand is the value of the
+ * destination (usually A) before the operation.
+ */
+
+#ifndef SOMOS_Z80_FLAGTABLES_H
+#define SOMOS_Z80_FLAGTABLES_H
+
+#include "Registers.h"
+
+#include <array>
+#include <cstdint>
+
+constexpr uint8_t FLAGS_53 = flag_mask(FLAGS::COPY_5) | flag_mask(FLAGS::COPY_3);
+
+namespace flag_tables {
+    constexpr uint8_t sz53(uint8_t result) {
+        uint8_t f = result & (flag_mask(FLAGS::SIGN_S) | FLAGS_53);
+        if (result == 0) {
+            f |= flag_mask(FLAGS::ZERO_Z);
+        }
+        return f;
+    }
+
+    constexpr uint8_t parity(uint8_t result) {
+        int bits = 0;
+        for (int i = 0; i < 8; i++) {
+            bits += (result >> i) & 1;
+        }
+        return (bits % 2 == 0) ? flag_mask(FLAGS::PARITY_P) : 0;
+    }
+
+    constexpr std::array<uint8_t, 0x100> make_sz53p() {
+        std::array<uint8_t, 0x100> table{};
+        for (int r = 0; r < 0x100; r++) {
+            table[r] = sz53(r) | parity(r);
+        }
+        return table;
+    }
+
+    constexpr std::array<uint8_t, 0x100> make_inc8() {
+        std::array<uint8_t, 0x100> table{};
+        for (int r = 0; r < 0x100; r++) {
+            uint8_t f = sz53(r);
+            // The lower nibble overflowed
+            if ((r & 0xF) == 0x0) {
+                f |= flag_mask(FLAGS::HALF_CARRY_H);
+            }
+            // 0x7F (127) + 1 overflows to 0x80 (-128)
+            if (r == 0x80) {
+                f |= flag_mask(FLAGS::OVERFLOW_V);
+            }
+            table[r] = f;
+        }
+        return table;
+    }
+
+    constexpr std::array<uint8_t, 0x100> make_dec8() {
+        std::array<uint8_t, 0x100> table{};
+        for (int r = 0; r < 0x100; r++) {
+            uint8_t f = sz53(r) | flag_mask(FLAGS::SUBTRACT_N);
+            // The lower nibble borrowed
+            if ((r & 0xF) == 0xF) {
+                f |= flag_mask(FLAGS::HALF_CARRY_H);
+            }
+            // 0x80 (-128) - 1 overflows to 0x7F (127)
+            if (r == 0x7F) {
+                f |= flag_mask(FLAGS::OVERFLOW_V);
+            }
+            table[r] = f;
+        }
+        return table;
+    }
+
+    constexpr std::array<uint8_t, 0x10000> make_add8() {
+        std::array<uint8_t, 0x10000> table{};
+        for (int a = 0; a < 0x100; a++) {
+            for (int r = 0; r < 0x100; r++) {
+                uint8_t b = r - a;
+                uint8_t f = sz53(r);
+                if ((a ^ b ^ r) & 0x10) {
+                    f |= flag_mask(FLAGS::HALF_CARRY_H);
+                }
+                // Both inputs have the same sign and the result doesn't
+                if ((~(a ^ b) & (a ^ r)) & 0x80) {
+                    f |= flag_mask(FLAGS::OVERFLOW_V);
+                }
+                if (r < a) {
+                    f |= flag_mask(FLAGS::CARRY_C);
+                }
+                table[(a << 8) | r] = f;
+            }
+        }
+        return table;
+    }
+
+    constexpr std::array<uint8_t, 0x10000> make_sub8() {
+        std::array<uint8_t, 0x10000> table{};
+        for (int a = 0; a < 0x100; a++) {
+            for (int r = 0; r < 0x100; r++) {
+                uint8_t b = a - r;
+                uint8_t f = sz53(r) | flag_mask(FLAGS::SUBTRACT_N);
+                if ((a ^ b ^ r) & 0x10) {
+                    f |= flag_mask(FLAGS::HALF_CARRY_H);
+                }
+                // The inputs have different signs and the sign of the result differs from the minuend
+                if (((a ^ b) & (a ^ r)) & 0x80) {
+                    f |= flag_mask(FLAGS::OVERFLOW_V);
+                }
+                if (r > a) {
+                    f |= flag_mask(FLAGS::CARRY_C);
+                }
+                table[(a << 8) | r] = f;
+            }
+        }
+        return table;
+    }
+}
+
+// S, Z, 5, 3 and parity of a result, used by the logic operations (or, xor) and rotations
+inline constexpr std::array<uint8_t, 0x100> SZ53P_FLAGS = flag_tables::make_sz53p();
+
+// Indexed by result
+inline constexpr std::array<uint8_t, 0x100> INC8_FLAGS = flag_tables::make_inc8();
+inline constexpr std::array<uint8_t, 0x100> DEC8_FLAGS = flag_tables::make_dec8();
+
+// Indexed by (operand, result). Compare uses the subtraction table with bits 3 and 5 taken from the compared value
+inline constexpr std::array<uint8_t, 0x10000> ADD8_FLAGS = flag_tables::make_add8();
+inline constexpr std::array<uint8_t, 0x10000> SUB8_FLAGS = flag_tables::make_sub8();
+
+#endif //SOMOS_Z80_FLAGTABLES_H
@@ -0,0 +1,504 @@
+/**
+ * Z80 JIT
+ *
+ * Translation of hot blocks from cartridge ROM to x86-64. The register loads, the 8-bit arithmetic and logic on
+ * registers and immediates, the 16-bit increments and decrements and the forward relative branches become native
+ * code that works on the registers in the Z80 object and writes F directly, so the flags are never lazy while native
+ * code runs. Every other instruction calls its step, as the block cache would. That includes the backward branches,
+ * which have to look for idle loops.
+ *
+ * Native code keeps the Z80 in rbx, the cycles of the current run in r12, the run deadline in r13 and the address the
+ * block started at in r14. The cycles are added and checked against the deadline after every instruction, but
+ * m_run_cycles, the instruction count and the PC are only stored when the block is left or a step is called
+ */
+
+#include "Z80.h"
+#include "Z80_Opcodes.h"
+
+#if SOMOS_Z80_JIT
+
+// Upper bound of the code emitted for a block: no instruction takes more than 160 bytes
+constexpr size_t JIT_MAX_BLOCK_SIZE = 256 + BLOCK_MAX_OPCODES * 160;
+
+// x86-64 register numbers
+enum X86Register : uint8_t {
+    EAX = 0,
+    ECX = 1,
+    EDX = 2,
+};
+
+// Second byte of the x86-64 conditional jumps with a 32-bit displacement
+enum X86Condition : uint8_t {
+    BELOW = 0x82,
+    ZERO = 0x84,
+    NOT_ZERO = 0x85,
+};
+
+struct Z80::BlockTranslator {
+    Z80& cpu;
+    JitCodeBuffer& code;
+    size_t epilogue{0};
+    // Instructions run by native code since the count was last stored
+    int pending_instructions{0};
+    // Whether m_lazy_flags is known to be empty, so that native code can use m_reg.F
+    bool flags_resolved{false};
+
+    NativeBlock translate(const DecodedBlock& block) {
+        // The epilogue comes first so that every exit is a backward jump to a known position
+        epilogue = code.position();
+        code.emit({0x48, 0x83, 0xC4, 0x08});    // add rsp, 8
+        code.emit({0x41, 0x5E});                // pop r14
+        code.emit({0x41, 0x5D});                // pop r13
+        code.emit({0x41, 0x5C});                // pop r12
+        code.emit({0x5B});                      // pop rbx
+        code.emit({0xC3});                      // ret
+
+        // System V calling convention: the Z80 arrives in rdi. rbx and r12-r14 have to be preserved for the caller
+        // and are preserved by the steps. The pushes and the padding align the stack to 16 bytes for the calls
+        size_t entry = code.position();
+        code.emit({0x53});                      // push rbx
+        code.emit({0x41, 0x54});                // push r12
+        code.emit({0x41, 0x55});                // push r13
+        code.emit({0x41, 0x56});                // push r14
+        code.emit({0x48, 0x83, 0xEC, 0x08});    // sub rsp, 8
+        code.emit({0x48, 0x89, 0xFB});          // mov rbx, rdi
+        load_run_state();
+        code.emit({0x44, 0x0F, 0xB7});          // movzx r14d, word [PC]
+        field(6, &cpu.m_reg.PC);
+
+        uint16_t pc = cpu.m_reg.PC;
+        int offset = 0;
+        for (int i = 0; i < block.length; i++) {
+            uint16_t opcode = decode_opcode(cpu.m_mem, pc);
+            int size = opcode_info(opcode).size;
+            bool last = i == block.length - 1;
+
+            if (!translate_native(opcode, pc, offset + size, last)) {
+                call_step(block.steps[i], offset, last);
+            }
+
+            pc += size;
+            offset += size;
+        }
+
+        return code.finish(entry);
+    }
+
+    /**
+     * Emits an instruction as native code
+     * @param next Offset of the next instruction from the start of the block
+     * @return false if the instruction has to run from its step instead
+     */
+    bool translate_native(uint16_t opcode, uint16_t pc, int next, bool last) {
+        if (opcode >= 0x100) {
+            return false;
+        }
+
+        // Fields of the opcode, https://www.smspower.org/Development/InstructionSet
+        int x = opcode >> 6;
+        int y = (opcode >> 3) & 7;
+        int z = opcode & 7;
+
+        if (x == 1 && y != 6 && z != 6) {
+            // ld r, r'
+            pending_instructions++;
+            load(EAX, register8(z));
+            store(EAX, register8(y));
+            end_instruction(4, next, last);
+            return true;
+        }
+
+        if (x == 2 && z != 6) {
+            return alu(y, register8(z), 0, 4, next, last);
+        }
+
+        if (x == 3 && z == 6) {
+            return alu(y, nullptr, cpu.m_mem->read(pc + 1), 7, next, last);
+        }
+
+        if (x != 0) {
+            return false;
+        }
+
+        if (z == 4 || z == 5) {
+            if (y == 6) {
+                return false;
+            }
+            // inc r, dec r
+            pending_instructions++;
+            resolve_flags();
+            const uint8_t* reg = register8(y);
+            load(EAX, reg);
+            code.emit({0xFE, static_cast<uint8_t>(z == 4 ? 0xC0 : 0xC8)});     // inc al / dec al
+            store(EAX, reg);
+            table_lookup(z == 4 ? INC8_FLAGS.data() : DEC8_FLAGS.data());
+            code.emit({0x80});                                                  // and byte [F], carry
+            field(4, &cpu.m_reg.F);
+            code.emit_u8(flag_mask(FLAGS::CARRY_C));
+            code.emit({0x08});                                                  // or byte [F], al
+            field(EAX, &cpu.m_reg.F);
+            end_instruction(4, next, last);
+            return true;
+        }
+
+        if (z == 6) {
+            if (y == 6) {
+                return false;
+            }
+            // ld r, n
+            pending_instructions++;
+            code.emit({0xC6});                                                  // mov byte [r], n
+            field(0, register8(y));
+            code.emit_u8(cpu.m_mem->read(pc + 1));
+            end_instruction(7, next, last);
+            return true;
+        }
+
+        if (z == 1 && (y & 1) == 0) {
+            // ld rr, nn
+            pending_instructions++;
+            code.emit({0x66, 0xC7});                                            // mov word [rr], nn
+            field(0, register16(y >> 1));
+            code.emit_u16(cpu.m_mem->read_word(pc + 1));
+            end_instruction(10, next, last);
+            return true;
+        }
+
+        if (z == 3) {
+            // inc rr, dec rr
+            pending_instructions++;
+            code.emit({0x66, 0xFF});                                            // inc/dec word [rr]
+            field((y & 1) == 0 ? 0 : 1, register16(y >> 1));
+            end_instruction(6, next, last);
+            return true;
+        }
+
+        if (z != 0) {
+            return false;
+        }
+
+        if (y == 0) {
+            // nop
+            pending_instructions++;
+            end_instruction(4, next, last);
+            return true;
+        }
+
+        if (y == 1) {
+            return false;
+        }
+
+        int8_t jump = static_cast<int8_t>(cpu.m_mem->read(pc + 1));
+        if (y == 2) {
+            // djnz $ runs in bulk, which the step does
+            if (jump == -2) {
+                return false;
+            }
+            pending_instructions++;
+            code.emit({0xFE});                                                  // dec byte [B]
+            field(1, &cpu.m_reg.B);
+            branch(NOT_ZERO, 13, next + jump);
+            end_instruction(8, next, last);
+            return true;
+        }
+
+        // A backward jr can close an idle loop, which only the step can look for
+        if (jump < 0) {
+            return false;
+        }
+
+        if (y == 3) {
+            // jr d
+            pending_instructions++;
+            add_cycles(12);
+            leave(next + jump);
+            return true;
+        }
+
+        // jr cc, d. The conditions are nz, z, nc and c
+        pending_instructions++;
+        resolve_flags();
+        int condition = y - 4;
+        uint8_t mask = (condition >> 1) == 0 ? flag_mask(FLAGS::ZERO_Z) : flag_mask(FLAGS::CARRY_C);
+        bool jump_if_set = (condition & 1) != 0;
+        code.emit({0xF6});                                                      // test byte [F], mask
+        field(0, &cpu.m_reg.F);
+        code.emit_u8(mask);
+        branch(jump_if_set ? NOT_ZERO : ZERO, 12, next + jump);
+        end_instruction(7, next, last);
+        return true;
+    }
+
+    /**
+     * Emits add, sub, and, xor, or or cp with A
+     * @param operand The register operand, or nullptr to use the immediate instead
+     */
+    bool alu(int operation, const uint8_t* operand, uint8_t immediate, int cycles, int next, bool last) {
+        // adc and sbc depend on the carry in, they run from their steps
+        if (operation == 1 || operation == 3) {
+            return false;
+        }
+
+        pending_instructions++;
+        // These operations replace all of F, so any pending flags are dropped instead of being built
+        if (!flags_resolved) {
+            code.emit({0xC6});                                                  // mov byte [lazy op], NONE
+            field(0, &cpu.m_lazy_flags.op);
+            code.emit_u8(static_cast<uint8_t>(FlagOp::NONE));
+            flags_resolved = true;
+        }
+
+        load(EAX, &cpu.m_reg.A);
+        if (operand != nullptr) {
+            load(ECX, operand);
+        } else {
+            code.emit({0xB9});                                                  // mov ecx, n
+            code.emit_u32(immediate);
+        }
+
+        switch (operation) {
+            case 0:
+            case 2:
+            case 7:
+                // The flags come from the table indexed by A and the result
+                code.emit({0x89, 0xC2});                                        // mov edx, eax
+                code.emit({static_cast<uint8_t>(operation == 0 ? 0x00 : 0x28), 0xCA});  // add/sub dl, cl
+                if (operation != 7) {
+                    store(EDX, &cpu.m_reg.A);
+                }
+                code.emit({0xC1, 0xE0, 0x08});                                  // shl eax, 8
+                code.emit({0x0F, 0xB6, 0xD2});                                  // movzx edx, dl
+                code.emit({0x09, 0xD0});                                        // or eax, edx
+                table_lookup(operation == 0 ? ADD8_FLAGS.data() : SUB8_FLAGS.data());
+                if (operation == 7) {
+                    // cp takes bits 5 and 3 from the operand instead of the result
+                    code.emit({0x83, 0xE0, static_cast<uint8_t>(~FLAGS_53)});  // and eax, ~FLAGS_53
+                    code.emit({0x83, 0xE1, FLAGS_53});                          // and ecx, FLAGS_53
+                    code.emit({0x09, 0xC8});                                    // or eax, ecx
+                }
+                break;
+            default:
+                code.emit({operation == 4 ? uint8_t{0x21} : operation == 5 ? uint8_t{0x31} : uint8_t{0x09},
+                           0xC8});                                              // and/xor/or eax, ecx
+                store(EAX, &cpu.m_reg.A);
+                table_lookup(SZ53P_FLAGS.data());
+                if (operation == 4) {
+                    code.emit({0x83, 0xC8, flag_mask(FLAGS::HALF_CARRY_H)});    // or eax, half carry
+                }
+                break;
+        }
+
+        store(EAX, &cpu.m_reg.F);
+        end_instruction(cycles, next, last);
+        return true;
+    }
+
+    /**
+     * Calls the step of an instruction that isn't translated, storing everything the step can see beforehand. The
+     * block is left if the step says so
+     */
+    void call_step(BlockStep step, int offset, bool last) {
+        store_instruction_count();
+        store_cycles();
+        store_pc(offset);
+        call(reinterpret_cast<uint64_t>(step));
+        pending_instructions = 0;
+        flags_resolved = false;
+
+        if (last) {
+            jump_to_epilogue();
+            return;
+        }
+
+        code.emit({0x84, 0xC0});                                                // test al, al
+        code.emit({0x0F, ZERO});                                                // jz epilogue
+        code.emit_rel32(epilogue);
+        // The step may have moved the deadline
+        load_run_state();
+    }
+
+    /**
+     * Counts the cycles of the instruction just emitted, and leaves the block at the next instruction if the deadline
+     * has been reached or this is the last instruction
+     */
+    void end_instruction(int cycles, int next, bool last) {
+        add_cycles(cycles);
+        if (last) {
+            leave(next);
+            return;
+        }
+
+        code.emit({0x4D, 0x39, 0xEC});                                          // cmp r12, r13
+        code.emit({0x0F, BELOW});                                               // jb next instruction
+        size_t carry_on = code.position();
+        code.emit_u32(0);
+        leave(next);
+        code.patch_rel32(carry_on);
+    }
+
+    /**
+     * Leaves the block at a branch target if the condition of the x86 flags holds
+     */
+    void branch(X86Condition taken, int cycles, int target) {
+        // The condition is inverted by flipping its lowest bit
+        code.emit({0x0F, static_cast<uint8_t>(taken ^ 1)});                     // jncc not taken
+        size_t not_taken = code.position();
+        code.emit_u32(0);
+        add_cycles(cycles);
+        leave(target);
+        code.patch_rel32(not_taken);
+    }
+
+    /**
+     * Stores the state kept in x86 registers and returns, with the PC at an offset from the start of the block
+     */
+    void leave(int offset) {
+        store_instruction_count();
+        store_cycles();
+        store_pc(offset);
+        jump_to_epilogue();
+    }
+
+    /**
+     * Builds F from the pending lazy flags, if there are any
+     */
+    void resolve_flags() {
+        if (flags_resolved) {
+            return;
+        }
+
+        code.emit({0x80});                                                      // cmp byte [lazy op], NONE
+        field(7, &cpu.m_lazy_flags.op);
+        code.emit_u8(static_cast<uint8_t>(FlagOp::NONE));
+        code.emit({0x74, 0x0F});                                                // je past the call
+        call(reinterpret_cast<uint64_t>(&BlockTranslator::resolve_lazy_flags));
+        flags_resolved = true;
+    }
+
+    static void resolve_lazy_flags(Z80& cpu) {
+        cpu.resolve_flags();
+    }
+
+    /**
+     * Replaces eax, an index into a flag table, by the table entry
+     */
+    void table_lookup(const uint8_t* table) {
+        code.emit({0x48, 0xBE});                                                // mov rsi, table
+        code.emit_u64(reinterpret_cast<uint64_t>(table));
+        code.emit({0x0F, 0xB6, 0x04, 0x06});                                    // movzx eax, byte [rsi + rax]
+    }
+
+    // Always 15 bytes, resolve_flags() jumps over it
+    void call(uint64_t function) {
+        code.emit({0x48, 0x89, 0xDF});                                          // mov rdi, rbx
+        code.emit({0x48, 0xB8});                                                // mov rax, function
+        code.emit_u64(function);
+        code.emit({0xFF, 0xD0});                                                // call rax
+    }
+
+    void jump_to_epilogue() {
+        code.emit({0xE9});                                                      // jmp epilogue
+        code.emit_rel32(epilogue);
+    }
+
+    void add_cycles(int cycles) {
+        code.emit({0x49, 0x83, 0xC4, static_cast<uint8_t>(cycles)});            // add r12, cycles
+    }
+
+    void load_run_state() {
+        code.emit({0x4C, 0x8B});                                                // mov r12, [m_run_cycles]
+        field(4, &cpu.m_run_cycles);
+        code.emit({0x4C, 0x8B});                                                // mov r13, [m_run_deadline]
+        field(5, &cpu.m_run_deadline);
+    }
+
+    void store_cycles() {
+        code.emit({0x4C, 0x89});                                                // mov [m_run_cycles], r12
+        field(4, &cpu.m_run_cycles);
+    }
+
+    void store_instruction_count() {
+        if (pending_instructions == 0) {
+            return;
+        }
+
+        code.emit({0x48, 0x81});                                                // add [m_instruction_count], n
+        field(0, &cpu.m_instruction_count);
+        code.emit_u32(pending_instructions);
+    }
+
+    void store_pc(int offset) {
+        code.emit({0x41, 0x8D, 0x86});                                          // lea eax, [r14 + offset]
+        code.emit_u32(static_cast<uint32_t>(offset));
+        code.emit({0x66, 0x89});                                                // mov [PC], ax
+        field(EAX, &cpu.m_reg.PC);
+    }
+
+    void load(X86Register reg, const uint8_t* byte) {
+        code.emit({0x0F, 0xB6});                                                // movzx reg, byte [field]
+        field(reg, byte);
+    }
+
+    void store(X86Register reg, const uint8_t* byte) {
+        code.emit({0x88});                                                      // mov byte [field], reg
+        field(reg, byte);
+    }
+
+    /**
+     * Emits the ModRM byte and displacement of a field of the Z80, addressed from rbx
+     * @param reg The register operand, or the extension of the opcode
+     */
+    void field(uint8_t reg, const void* address) {
+        code.emit_u8(0x80 | ((reg & 7) << 3) | 3);
+        code.emit_u32(static_cast<uint32_t>(static_cast<const uint8_t*>(address) - reinterpret_cast<uint8_t*>(&cpu)));
+    }
+
+    /**
+     * @param r The register field of the opcode, which can't be (hl)
+     */
+    const uint8_t* register8(int r) const {
+        const uint8_t* registers[] = {&cpu.m_reg.B, &cpu.m_reg.C, &cpu.m_reg.D, &cpu.m_reg.E,
+                                      &cpu.m_reg.H, &cpu.m_reg.L, nullptr, &cpu.m_reg.A};
+        return registers[r];
+    }
+
+    const uint16_t* register16(int rr) const {
+        const uint16_t* registers[] = {&cpu.m_reg.BC, &cpu.m_reg.DE, &cpu.m_reg.HL, &cpu.m_reg.SP};
+        return registers[rr];
+    }
+};
+
+void Z80::translate_block(DecodedBlock &block) {
+    if (!m_jit.allocate()) {
+        return;
+    }
+
+    // Blocks that are still hot are translated again, unless the buffer can't be used any more. Then they only ever
+    // run from the block cache
+    auto discard_translations = [this]() {
+        m_jit.clear();
+        for (DecodedBlock& cached : m_blocks) {
+            if (cached.native != nullptr) {
+                cached.native = nullptr;
+                cached.countdown = JIT_THRESHOLD;
+            }
+        }
+    };
+
+    if (!m_jit.begin(JIT_MAX_BLOCK_SIZE)) {
+        // The buffer is full, or couldn't be made writable
+        discard_translations();
+        if (!m_jit.begin(JIT_MAX_BLOCK_SIZE)) {
+            return;
+        }
+    }
+
+    BlockTranslator translator{*this, m_jit};
+    block.native = translator.translate(block);
+    if (block.native == nullptr) {
+        // The buffer couldn't be made executable, which the earlier translations sharing its last page depend on
+        discard_translations();
+    }
+}
+
+#endif
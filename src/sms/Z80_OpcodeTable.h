@@ -0,0 +1,282 @@
+/**
+ * Z80 OPCODE TABLE
+ *
+ * Base (un-prefixed) opcode table
+ * https://www.smspower.org/Development/InstructionSet
+ * https://clrhome.org/table/
+ *
+ * Each entry has the format
+ *      OPCODE(opcode, mnemonic, size, handler)
+ * Handlers for the 8-bit operands take them as template arguments (see Operand8), so every opcode gets its own handler
+ * with the registers it uses fixed at compile time. Handlers with more than one template argument are wrapped in
+ * parentheses so that the preprocessor doesn't split them.
+ * The table is expanded in Z80.cpp, once into the Z80::op<opcode> handlers (where only the handler and size are used)
+ * and once into the static disassembly metadata (where only the mnemonic and size are used). The dispatch switch, the
+ * threaded interpreter and the block cache all call the op<opcode> handlers.
+ * The prefixes have a size of 0, prefix() looks the instruction up in the prefixed tables (Z80_PrefixedOpcodeTable.h)
+ * and its handler moves the PC past all of it.
+ * Entries must be kept in opcode order.
+ */
+
+#ifndef SOMOS_Z80_OPCODETABLE_H
+#define SOMOS_Z80_OPCODETABLE_H
+
+#define Z80_OPCODE_TABLE(OPCODE) \
+    OPCODE(0x00, "nop",         1, nop())                                     \
+    OPCODE(0x01, "ld bc, nn",   3, load_16bit(m_reg.BC))                      \
+    OPCODE(0x02, "ld (bc), a",  1, write_A_value(m_reg.BC))                   \
+    OPCODE(0x03, "inc bc",      1, inc_16bit(m_reg.BC))                       \
+    OPCODE(0x04, "inc b",       1, inc_8bit<Operand8::B>())                   \
+    OPCODE(0x05, "dec b",       1, dec_8bit<Operand8::B>())                   \
+    OPCODE(0x06, "ld b, n",     2, (load_8bit<Operand8::B, Operand8::N>()))   \
+    OPCODE(0x07, "rlca",        1, rlca())                                    \
+    OPCODE(0x08, "ex af, af'",  1, ex_af())                                   \
+    OPCODE(0x09, "add hl, bc",  1, add_16bit(m_reg.HL, m_reg.BC))             \
+    OPCODE(0x0A, "ld a, (bc)",  1, load_8bit_reg_ptr(m_reg.A, m_reg.BC))      \
+    OPCODE(0x0B, "dec bc",      1, dec_16bit(m_reg.BC))                       \
+    OPCODE(0x0C, "inc c",       1, inc_8bit<Operand8::C>())                   \
+    OPCODE(0x0D, "dec c",       1, dec_8bit<Operand8::C>())                   \
+    OPCODE(0x0E, "ld c, n",     2, (load_8bit<Operand8::C, Operand8::N>()))   \
+    OPCODE(0x0F, "rrca",        1, rrca())                                    \
+    OPCODE(0x10, "djnz d",      2, djnz())                                    \
+    OPCODE(0x11, "ld de, nn",   3, load_16bit(m_reg.DE))                      \
+    OPCODE(0x12, "ld (de), a",  1, write_A_value(m_reg.DE))                   \
+    OPCODE(0x13, "inc de",      1, inc_16bit(m_reg.DE))                       \
+    OPCODE(0x14, "inc d",       1, inc_8bit<Operand8::D>())                   \
+    OPCODE(0x15, "dec d",       1, dec_8bit<Operand8::D>())                   \
+    OPCODE(0x16, "ld d, n",     2, (load_8bit<Operand8::D, Operand8::N>()))   \
+    OPCODE(0x17, "rla",         1, rla())                                     \
+    OPCODE(0x18, "jr d",        2, jump_relative(true))                       \
+    OPCODE(0x19, "add hl, de",  1, add_16bit(m_reg.HL, m_reg.DE))             \
+    OPCODE(0x1A, "ld a, (de)",  1, load_8bit_reg_ptr(m_reg.A, m_reg.DE))      \
+    OPCODE(0x1B, "dec de",      1, dec_16bit(m_reg.DE))                       \
+    OPCODE(0x1C, "inc e",       1, inc_8bit<Operand8::E>())                   \
+    OPCODE(0x1D, "dec e",       1, dec_8bit<Operand8::E>())                   \
+    OPCODE(0x1E, "ld e, n",     2, (load_8bit<Operand8::E, Operand8::N>()))   \
+    OPCODE(0x1F, "rra",         1, rra())                                     \
+    OPCODE(0x20, "jr nz, d",    2, jump_relative(!is_flag_set(FLAGS::ZERO_Z))) \
+    OPCODE(0x21, "ld hl, nn",   3, load_16bit(m_reg.HL))                      \
+    OPCODE(0x22, "ld (nn), hl", 3, write_16bit_address(m_reg.HL))             \
+    OPCODE(0x23, "inc hl",      1, inc_16bit(m_reg.HL))                       \
+    OPCODE(0x24, "inc h",       1, inc_8bit<Operand8::H>())                   \
+    OPCODE(0x25, "dec h",       1, dec_8bit<Operand8::H>())                   \
+    OPCODE(0x26, "ld h, n",     2, (load_8bit<Operand8::H, Operand8::N>()))   \
+    OPCODE(0x27, "daa",         1, daa())                                     \
+    OPCODE(0x28, "jr z, d",     2, jump_relative(is_flag_set(FLAGS::ZERO_Z))) \
+    OPCODE(0x29, "add hl, hl",  1, add_16bit(m_reg.HL, m_reg.HL))             \
+    OPCODE(0x2A, "ld hl, (nn)", 3, load_16bit_address(m_reg.HL))              \
+    OPCODE(0x2B, "dec hl",      1, dec_16bit(m_reg.HL))                       \
+    OPCODE(0x2C, "inc l",       1, inc_8bit<Operand8::L>())                   \
+    OPCODE(0x2D, "dec l",       1, dec_8bit<Operand8::L>())                   \
+    OPCODE(0x2E, "ld l, n",     2, (load_8bit<Operand8::L, Operand8::N>()))   \
+    OPCODE(0x2F, "cpl",         1, cpl())                                     \
+    OPCODE(0x30, "jr nc, d",    2, jump_relative(!is_flag_set(FLAGS::CARRY_C))) \
+    OPCODE(0x31, "ld sp, nn",   3, load_16bit(m_reg.SP))                      \
+    OPCODE(0x32, "ld (nn), a",  3, write_A_address())                         \
+    OPCODE(0x33, "inc sp",      1, inc_16bit(m_reg.SP))                       \
+    OPCODE(0x34, "inc (hl)",    1, inc_8bit<Operand8::HL_PTR>())              \
+    OPCODE(0x35, "dec (hl)",    1, dec_8bit<Operand8::HL_PTR>())              \
+    OPCODE(0x36, "ld (hl), n",  2, (load_8bit<Operand8::HL_PTR, Operand8::N>())) \
+    OPCODE(0x37, "scf",         1, scf())                                     \
+    OPCODE(0x38, "jr c, d",     2, jump_relative(is_flag_set(FLAGS::CARRY_C))) \
+    OPCODE(0x39, "add hl, sp",  1, add_16bit(m_reg.HL, m_reg.SP))             \
+    OPCODE(0x3A, "ld a, (nn)",  3, load_A_address())                          \
+    OPCODE(0x3B, "dec sp",      1, dec_16bit(m_reg.SP))                       \
+    OPCODE(0x3C, "inc a",       1, inc_8bit<Operand8::A>())                   \
+    OPCODE(0x3D, "dec a",       1, dec_8bit<Operand8::A>())                   \
+    OPCODE(0x3E, "ld a, n",     2, (load_8bit<Operand8::A, Operand8::N>()))   \
+    OPCODE(0x3F, "ccf",         1, ccf())                                     \
+    OPCODE(0x40, "ld b, b",     1, (load_8bit<Operand8::B, Operand8::B>()))   \
+    OPCODE(0x41, "ld b, c",     1, (load_8bit<Operand8::B, Operand8::C>()))   \
+    OPCODE(0x42, "ld b, d",     1, (load_8bit<Operand8::B, Operand8::D>()))   \
+    OPCODE(0x43, "ld b, e",     1, (load_8bit<Operand8::B, Operand8::E>()))   \
+    OPCODE(0x44, "ld b, h",     1, (load_8bit<Operand8::B, Operand8::H>()))   \
+    OPCODE(0x45, "ld b, l",     1, (load_8bit<Operand8::B, Operand8::L>()))   \
+    OPCODE(0x46, "ld b, (hl)",  1, (load_8bit<Operand8::B, Operand8::HL_PTR>())) \
+    OPCODE(0x47, "ld b, a",     1, (load_8bit<Operand8::B, Operand8::A>()))   \
+    OPCODE(0x48, "ld c, b",     1, (load_8bit<Operand8::C, Operand8::B>()))   \
+    OPCODE(0x49, "ld c, c",     1, (load_8bit<Operand8::C, Operand8::C>()))   \
+    OPCODE(0x4A, "ld c, d",     1, (load_8bit<Operand8::C, Operand8::D>()))   \
+    OPCODE(0x4B, "ld c, e",     1, (load_8bit<Operand8::C, Operand8::E>()))   \
+    OPCODE(0x4C, "ld c, h",     1, (load_8bit<Operand8::C, Operand8::H>()))   \
+    OPCODE(0x4D, "ld c, l",     1, (load_8bit<Operand8::C, Operand8::L>()))   \
+    OPCODE(0x4E, "ld c, (hl)",  1, (load_8bit<Operand8::C, Operand8::HL_PTR>())) \
+    OPCODE(0x4F, "ld c, a",     1, (load_8bit<Operand8::C, Operand8::A>()))   \
+    OPCODE(0x50, "ld d, b",     1, (load_8bit<Operand8::D, Operand8::B>()))   \
+    OPCODE(0x51, "ld d, c",     1, (load_8bit<Operand8::D, Operand8::C>()))   \
+    OPCODE(0x52, "ld d, d",     1, (load_8bit<Operand8::D, Operand8::D>()))   \
+    OPCODE(0x53, "ld d, e",     1, (load_8bit<Operand8::D, Operand8::E>()))   \
+    OPCODE(0x54, "ld d, h",     1, (load_8bit<Operand8::D, Operand8::H>()))   \
+    OPCODE(0x55, "ld d, l",     1, (load_8bit<Operand8::D, Operand8::L>()))   \
+    OPCODE(0x56, "ld d, (hl)",  1, (load_8bit<Operand8::D, Operand8::HL_PTR>())) \
+    OPCODE(0x57, "ld d, a",     1, (load_8bit<Operand8::D, Operand8::A>()))   \
+    OPCODE(0x58, "ld e, b",     1, (load_8bit<Operand8::E, Operand8::B>()))   \
+    OPCODE(0x59, "ld e, c",     1, (load_8bit<Operand8::E, Operand8::C>()))   \
+    OPCODE(0x5A, "ld e, d",     1, (load_8bit<Operand8::E, Operand8::D>()))   \
+    OPCODE(0x5B, "ld e, e",     1, (load_8bit<Operand8::E, Operand8::E>()))   \
+    OPCODE(0x5C, "ld e, h",     1, (load_8bit<Operand8::E, Operand8::H>()))   \
+    OPCODE(0x5D, "ld e, l",     1, (load_8bit<Operand8::E, Operand8::L>()))   \
+    OPCODE(0x5E, "ld e, (hl)",  1, (load_8bit<Operand8::E, Operand8::HL_PTR>())) \
+    OPCODE(0x5F, "ld e, a",     1, (load_8bit<Operand8::E, Operand8::A>()))   \
+    OPCODE(0x60, "ld h, b",     1, (load_8bit<Operand8::H, Operand8::B>()))   \
+    OPCODE(0x61, "ld h, c",     1, (load_8bit<Operand8::H, Operand8::C>()))   \
+    OPCODE(0x62, "ld h, d",     1, (load_8bit<Operand8::H, Operand8::D>()))   \
+    OPCODE(0x63, "ld h, e",     1, (load_8bit<Operand8::H, Operand8::E>()))   \
+    OPCODE(0x64, "ld h, h",     1, (load_8bit<Operand8::H, Operand8::H>()))   \
+    OPCODE(0x65, "ld h, l",     1, (load_8bit<Operand8::H, Operand8::L>()))   \
+    OPCODE(0x66, "ld h, (hl)",  1, (load_8bit<Operand8::H, Operand8::HL_PTR>())) \
+    OPCODE(0x67, "ld h, a",     1, (load_8bit<Operand8::H, Operand8::A>()))   \
+    OPCODE(0x68, "ld l, b",     1, (load_8bit<Operand8::L, Operand8::B>()))   \
+    OPCODE(0x69, "ld l, c",     1, (load_8bit<Operand8::L, Operand8::C>()))   \
+    OPCODE(0x6A, "ld l, d",     1, (load_8bit<Operand8::L, Operand8::D>()))   \
+    OPCODE(0x6B, "ld l, e",     1, (load_8bit<Operand8::L, Operand8::E>()))   \
+    OPCODE(0x6C, "ld l, h",     1, (load_8bit<Operand8::L, Operand8::H>()))   \
+    OPCODE(0x6D, "ld l, l",     1, (load_8bit<Operand8::L, Operand8::L>()))   \
+    OPCODE(0x6E, "ld l, (hl)",  1, (load_8bit<Operand8::L, Operand8::HL_PTR>())) \
+    OPCODE(0x6F, "ld l, a",     1, (load_8bit<Operand8::L, Operand8::A>()))   \
+    OPCODE(0x70, "ld (hl), b",  1, (load_8bit<Operand8::HL_PTR, Operand8::B>())) \
+    OPCODE(0x71, "ld (hl), c",  1, (load_8bit<Operand8::HL_PTR, Operand8::C>())) \
+    OPCODE(0x72, "ld (hl), d",  1, (load_8bit<Operand8::HL_PTR, Operand8::D>())) \
+    OPCODE(0x73, "ld (hl), e",  1, (load_8bit<Operand8::HL_PTR, Operand8::E>())) \
+    OPCODE(0x74, "ld (hl), h",  1, (load_8bit<Operand8::HL_PTR, Operand8::H>())) \
+    OPCODE(0x75, "ld (hl), l",  1, (load_8bit<Operand8::HL_PTR, Operand8::L>())) \
+    OPCODE(0x76, "halt",        1, halt())                                    \
+    OPCODE(0x77, "ld (hl), a",  1, (load_8bit<Operand8::HL_PTR, Operand8::A>())) \
+    OPCODE(0x78, "ld a, b",     1, (load_8bit<Operand8::A, Operand8::B>()))   \
+    OPCODE(0x79, "ld a, c",     1, (load_8bit<Operand8::A, Operand8::C>()))   \
+    OPCODE(0x7A, "ld a, d",     1, (load_8bit<Operand8::A, Operand8::D>()))   \
+    OPCODE(0x7B, "ld a, e",     1, (load_8bit<Operand8::A, Operand8::E>()))   \
+    OPCODE(0x7C, "ld a, h",     1, (load_8bit<Operand8::A, Operand8::H>()))   \
+    OPCODE(0x7D, "ld a, l",     1, (load_8bit<Operand8::A, Operand8::L>()))   \
+    OPCODE(0x7E, "ld a, (hl)",  1, (load_8bit<Operand8::A, Operand8::HL_PTR>())) \
+    OPCODE(0x7F, "ld a, a",     1, (load_8bit<Operand8::A, Operand8::A>()))   \
+    OPCODE(0x80, "add a, b",    1, add_A<Operand8::B>())                      \
+    OPCODE(0x81, "add a, c",    1, add_A<Operand8::C>())                      \
+    OPCODE(0x82, "add a, d",    1, add_A<Operand8::D>())                      \
+    OPCODE(0x83, "add a, e",    1, add_A<Operand8::E>())                      \
+    OPCODE(0x84, "add a, h",    1, add_A<Operand8::H>())                      \
+    OPCODE(0x85, "add a, l",    1, add_A<Operand8::L>())                      \
+    OPCODE(0x86, "add a, (hl)", 1, add_A<Operand8::HL_PTR>())                 \
+    OPCODE(0x87, "add a, a",    1, add_A<Operand8::A>())                      \
+    OPCODE(0x88, "adc a, b",    1, adc_A<Operand8::B>())                      \
+    OPCODE(0x89, "adc a, c",    1, adc_A<Operand8::C>())                      \
+    OPCODE(0x8A, "adc a, d",    1, adc_A<Operand8::D>())                      \
+    OPCODE(0x8B, "adc a, e",    1, adc_A<Operand8::E>())                      \
+    OPCODE(0x8C, "adc a, h",    1, adc_A<Operand8::H>())                      \
+    OPCODE(0x8D, "adc a, l",    1, adc_A<Operand8::L>())                      \
+    OPCODE(0x8E, "adc a, (hl)", 1, adc_A<Operand8::HL_PTR>())                 \
+    OPCODE(0x8F, "adc a, a",    1, adc_A<Operand8::A>())                      \
+    OPCODE(0x90, "sub b",       1, sub_A<Operand8::B>())                      \
+    OPCODE(0x91, "sub c",       1, sub_A<Operand8::C>())                      \
+    OPCODE(0x92, "sub d",       1, sub_A<Operand8::D>())                      \
+    OPCODE(0x93, "sub e",       1, sub_A<Operand8::E>())                      \
+    OPCODE(0x94, "sub h",       1, sub_A<Operand8::H>())                      \
+    OPCODE(0x95, "sub l",       1, sub_A<Operand8::L>())                      \
+    OPCODE(0x96, "sub (hl)",    1, sub_A<Operand8::HL_PTR>())                 \
+    OPCODE(0x97, "sub a",       1, sub_A<Operand8::A>())                      \
+    OPCODE(0x98, "sbc a, b",    1, sbc_A<Operand8::B>())                      \
+    OPCODE(0x99, "sbc a, c",    1, sbc_A<Operand8::C>())                      \
+    OPCODE(0x9A, "sbc a, d",    1, sbc_A<Operand8::D>())                      \
+    OPCODE(0x9B, "sbc a, e",    1, sbc_A<Operand8::E>())                      \
+    OPCODE(0x9C, "sbc a, h",    1, sbc_A<Operand8::H>())                      \
+    OPCODE(0x9D, "sbc a, l",    1, sbc_A<Operand8::L>())                      \
+    OPCODE(0x9E, "sbc a, (hl)", 1, sbc_A<Operand8::HL_PTR>())                 \
+    OPCODE(0x9F, "sbc a, a",    1, sbc_A<Operand8::A>())                      \
+    OPCODE(0xA0, "and b",       1, and_A<Operand8::B>())                      \
+    OPCODE(0xA1, "and c",       1, and_A<Operand8::C>())                      \
+    OPCODE(0xA2, "and d",       1, and_A<Operand8::D>())                      \
+    OPCODE(0xA3, "and e",       1, and_A<Operand8::E>())                      \
+    OPCODE(0xA4, "and h",       1, and_A<Operand8::H>())                      \
+    OPCODE(0xA5, "and l",       1, and_A<Operand8::L>())                      \
+    OPCODE(0xA6, "and (hl)",    1, and_A<Operand8::HL_PTR>())                 \
+    OPCODE(0xA7, "and a",       1, and_A<Operand8::A>())                      \
+    OPCODE(0xA8, "xor b",       1, xor_A<Operand8::B>())                      \
+    OPCODE(0xA9, "xor c",       1, xor_A<Operand8::C>())                      \
+    OPCODE(0xAA, "xor d",       1, xor_A<Operand8::D>())                      \
+    OPCODE(0xAB, "xor e",       1, xor_A<Operand8::E>())                      \
+    OPCODE(0xAC, "xor h",       1, xor_A<Operand8::H>())                      \
+    OPCODE(0xAD, "xor l",       1, xor_A<Operand8::L>())                      \
+    OPCODE(0xAE, "xor (hl)",    1, xor_A<Operand8::HL_PTR>())                 \
+    OPCODE(0xAF, "xor a",       1, xor_A<Operand8::A>())                      \
+    OPCODE(0xB0, "or b",        1, or_A<Operand8::B>())                       \
+    OPCODE(0xB1, "or c",        1, or_A<Operand8::C>())                       \
+    OPCODE(0xB2, "or d",        1, or_A<Operand8::D>())                       \
+    OPCODE(0xB3, "or e",        1, or_A<Operand8::E>())                       \
+    OPCODE(0xB4, "or h",        1, or_A<Operand8::H>())                       \
+    OPCODE(0xB5, "or l",        1, or_A<Operand8::L>())                       \
+    OPCODE(0xB6, "or (hl)",     1, or_A<Operand8::HL_PTR>())                  \
+    OPCODE(0xB7, "or a",        1, or_A<Operand8::A>())                       \
+    OPCODE(0xB8, "cp b",        1, cp_A<Operand8::B>())                       \
+    OPCODE(0xB9, "cp c",        1, cp_A<Operand8::C>())                       \
+    OPCODE(0xBA, "cp d",        1, cp_A<Operand8::D>())                       \
+    OPCODE(0xBB, "cp e",        1, cp_A<Operand8::E>())                       \
+    OPCODE(0xBC, "cp h",        1, cp_A<Operand8::H>())                       \
+    OPCODE(0xBD, "cp l",        1, cp_A<Operand8::L>())                       \
+    OPCODE(0xBE, "cp (hl)",     1, cp_A<Operand8::HL_PTR>())                  \
+    OPCODE(0xBF, "cp a",        1, cp_A<Operand8::A>())                       \
+    OPCODE(0xC0, "ret nz",      1, ret(!is_flag_set(FLAGS::ZERO_Z)))          \
+    OPCODE(0xC1, "pop bc",      1, pop_16bit(m_reg.BC))                       \
+    OPCODE(0xC2, "jp nz, nn",   3, jump(!is_flag_set(FLAGS::ZERO_Z)))         \
+    OPCODE(0xC3, "jp nn",       3, jump(true))                                \
+    OPCODE(0xC4, "call nz, nn", 3, call(!is_flag_set(FLAGS::ZERO_Z)))         \
+    OPCODE(0xC5, "push bc",     1, push_16bit(m_reg.BC))                      \
+    OPCODE(0xC6, "add a, n",    2, add_A<Operand8::N>())                      \
+    OPCODE(0xC7, "rst 0x00",    1, rst(0x00))                                 \
+    OPCODE(0xC8, "ret z",       1, ret(is_flag_set(FLAGS::ZERO_Z)))           \
+    OPCODE(0xC9, "ret",         1, ret(true, 10))                             \
+    OPCODE(0xCA, "jp z, nn",    3, jump(is_flag_set(FLAGS::ZERO_Z)))          \
+    OPCODE(0xCB, "prefix cb",   0, prefix())                                  \
+    OPCODE(0xCC, "call z, nn",  3, call(is_flag_set(FLAGS::ZERO_Z)))          \
+    OPCODE(0xCD, "call nn",     3, call(true))                                \
+    OPCODE(0xCE, "adc a, n",    2, adc_A<Operand8::N>())                      \
+    OPCODE(0xCF, "rst 0x08",    1, rst(0x08))                                 \
+    OPCODE(0xD0, "ret nc",      1, ret(!is_flag_set(FLAGS::CARRY_C)))         \
+    OPCODE(0xD1, "pop de",      1, pop_16bit(m_reg.DE))                       \
+    OPCODE(0xD2, "jp nc, nn",   3, jump(!is_flag_set(FLAGS::CARRY_C)))        \
+    OPCODE(0xD3, "out (n), a",  2, output_n())                                \
+    OPCODE(0xD4, "call nc, nn", 3, call(!is_flag_set(FLAGS::CARRY_C)))        \
+    OPCODE(0xD5, "push de",     1, push_16bit(m_reg.DE))                      \
+    OPCODE(0xD6, "sub n",       2, sub_A<Operand8::N>())                      \
+    OPCODE(0xD7, "rst 0x10",    1, rst(0x10))                                 \
+    OPCODE(0xD8, "ret c",       1, ret(is_flag_set(FLAGS::CARRY_C)))          \
+    OPCODE(0xD9, "exx",         1, exx())                                     \
+    OPCODE(0xDA, "jp c, nn",    3, jump(is_flag_set(FLAGS::CARRY_C)))         \
+    OPCODE(0xDB, "in a, (n)",   2, input_n())                                 \
+    OPCODE(0xDC, "call c, nn",  3, call(is_flag_set(FLAGS::CARRY_C)))         \
+    OPCODE(0xDD, "prefix dd",   0, prefix())                                  \
+    OPCODE(0xDE, "sbc a, n",    2, sbc_A<Operand8::N>())                      \
+    OPCODE(0xDF, "rst 0x18",    1, rst(0x18))                                 \
+    OPCODE(0xE0, "ret po",      1, ret(!is_flag_set(FLAGS::PARITY_P)))        \
+    OPCODE(0xE1, "pop hl",      1, pop_16bit(m_reg.HL))                       \
+    OPCODE(0xE2, "jp po, nn",   3, jump(!is_flag_set(FLAGS::PARITY_P)))       \
+    OPCODE(0xE3, "ex (sp), hl", 1, ex_SP(m_reg.HL))                           \
+    OPCODE(0xE4, "call po, nn", 3, call(!is_flag_set(FLAGS::PARITY_P)))       \
+    OPCODE(0xE5, "push hl",     1, push_16bit(m_reg.HL))                      \
+    OPCODE(0xE6, "and n",       2, and_A<Operand8::N>())                      \
+    OPCODE(0xE7, "rst 0x20",    1, rst(0x20))                                 \
+    OPCODE(0xE8, "ret pe",      1, ret(is_flag_set(FLAGS::PARITY_P)))         \
+    OPCODE(0xE9, "jp (hl)",     1, jump_register(m_reg.HL))                   \
+    OPCODE(0xEA, "jp pe, nn",   3, jump(is_flag_set(FLAGS::PARITY_P)))        \
+    OPCODE(0xEB, "ex de, hl",   1, ex_16bit_registers(m_reg.DE, m_reg.HL))    \
+    OPCODE(0xEC, "call pe, nn", 3, call(is_flag_set(FLAGS::PARITY_P)))        \
+    OPCODE(0xED, "prefix ed",   0, prefix())                                  \
+    OPCODE(0xEE, "xor n",       2, xor_A<Operand8::N>())                      \
+    OPCODE(0xEF, "rst 0x28",    1, rst(0x28))                                 \
+    OPCODE(0xF0, "ret p",       1, ret(!is_flag_set(FLAGS::SIGN_S)))          \
+    OPCODE(0xF1, "pop af",      1, pop_af())                                  \
+    OPCODE(0xF2, "jp p, nn",    3, jump(!is_flag_set(FLAGS::SIGN_S)))         \
+    OPCODE(0xF3, "di",          1, set_interrupts(false))                     \
+    OPCODE(0xF4, "call p, nn",  3, call(!is_flag_set(FLAGS::SIGN_S)))         \
+    OPCODE(0xF5, "push af",     1, push_af())                                 \
+    OPCODE(0xF6, "or n",        2, or_A<Operand8::N>())                       \
+    OPCODE(0xF7, "rst 0x30",    1, rst(0x30))                                 \
+    OPCODE(0xF8, "ret m",       1, ret(is_flag_set(FLAGS::SIGN_S)))           \
+    OPCODE(0xF9, "ld sp, hl",   1, load_SP(m_reg.HL))                         \
+    OPCODE(0xFA, "jp m, nn",    3, jump(is_flag_set(FLAGS::SIGN_S)))          \
+    OPCODE(0xFB, "ei",          1, set_interrupts(true))                      \
+    OPCODE(0xFC, "call m, nn",  3, call(is_flag_set(FLAGS::SIGN_S)))          \
+    OPCODE(0xFD, "prefix fd",   0, prefix())                                  \
+    OPCODE(0xFE, "cp n",        2, cp_A<Operand8::N>())                       \
+    OPCODE(0xFF, "rst 0x38",    1, rst(0x38))
+
+#endif //SOMOS_Z80_OPCODETABLE_H
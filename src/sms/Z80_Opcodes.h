@@ -0,0 +1,817 @@
+/**
+ * Z80 OPCODES
+ *
+ * Handlers of the Z80 instructions and the op<> specialisation of every opcode table entry. They are defined in a
+ * header so that the ahead of time translations, which only call aot_step<>(), can inline the whole instruction and
+ * compile each block to straight-line code. The interpreters in Z80.cpp include it as well
+ */
+
+#ifndef SOMOS_Z80_OPCODES_H
+#define SOMOS_Z80_OPCODES_H
+
+#include "Z80.h"
+#include "Z80_OpcodeTable.h"
+#include "Z80_PrefixedOpcodeTable.h"
+#include "Z80_FlagTables.h"
+#include "bit_utils.h"
+
+#include <algorithm>
+
+inline void Z80::nop() {
+    m_cycles = 4;
+}
+
+inline void Z80::not_implemented() {
+    m_cycles = 0;
+}
+
+inline void Z80::load_16bit(uint16_t &reg) {
+    reg = m_mem->read_word(m_reg.PC + 1);
+    m_cycles = 10;
+}
+
+inline void Z80::load_16bit_address(uint16_t &reg) {
+    reg = m_mem->read_word(m_mem->read_word(m_reg.PC + 1));
+    m_cycles = 16;
+}
+
+inline void Z80::write_16bit_address(uint16_t reg) {
+    m_mem->write_word(m_mem->read_word(m_reg.PC + 1), reg);
+    m_cycles = 16;
+}
+
+inline void Z80::load_A_address() {
+    m_reg.A = m_mem->read(m_mem->read_word(m_reg.PC + 1));
+    m_cycles = 13;
+}
+
+inline void Z80::write_A_address() {
+    m_mem->write(m_mem->read_word(m_reg.PC + 1), m_reg.A);
+    m_cycles = 13;
+}
+
+inline void Z80::load_SP(uint16_t reg) {
+    m_reg.SP = reg;
+    m_cycles = 6;
+}
+
+inline void Z80::load_I_A() {
+    m_reg.I = m_reg.A;
+    m_cycles = 9;
+}
+
+inline void Z80::load_R_A() {
+    // R counts from the new value. The instruction count carries on, so the count so far is taken back off
+    m_reg.R = (m_reg.A & 0x80) | ((m_reg.A - m_instruction_count) & 0x7F);
+    m_cycles = 9;
+}
+
+inline void Z80::load_A_IR(uint8_t value) {
+    m_reg.A = value;
+
+    resolve_flags();
+    m_reg.F = (m_reg.F & flag_mask(FLAGS::CARRY_C)) | (SZ53P_FLAGS[value] & ~flag_mask(FLAGS::PARITY_P)) |
+              (m_iff2 ? flag_mask(FLAGS::PARITY_P) : 0);
+    m_cycles = 9;
+}
+
+inline void Z80::load_8bit_reg_ptr(uint8_t &reg, uint16_t ptr) {
+    reg = m_mem->read(ptr);
+    m_cycles = 7;
+}
+
+inline void Z80::write_A_value(uint16_t reg) {
+    m_mem->write(reg, m_reg.A);
+    m_cycles = 7;
+}
+
+inline void Z80::inc_16bit(uint16_t &reg) {
+    reg++;
+    m_cycles = 6;
+}
+
+// Flags changed by the 8-bit arithmetic and logic operations on A
+constexpr uint8_t ALL_FLAGS = 0xFF;
+
+inline void Z80::dec_16bit(uint16_t &reg) {
+    reg--;
+    m_cycles = 6;
+}
+
+// Flags changed by the accumulator rotations
+constexpr uint8_t ROTATE_A_FLAGS = flag_mask(FLAGS::HALF_CARRY_H) | flag_mask(FLAGS::SUBTRACT_N) |
+                                          flag_mask(FLAGS::CARRY_C) | FLAGS_53;
+
+inline void Z80::rlca() {
+    bool is_bit7_set = is_bit_set(m_reg.A, 7);
+
+    m_reg.A = m_reg.A << 1;
+    if (is_bit7_set) {
+        bit_set(m_reg.A, 0);
+    } else {
+        bit_reset(m_reg.A, 0);
+    }
+
+    resolve_flags();
+    m_reg.F = (m_reg.F & ~ROTATE_A_FLAGS) | (m_reg.A & FLAGS_53) | (is_bit7_set ? flag_mask(FLAGS::CARRY_C) : 0);
+
+    m_cycles = 4;
+}
+
+inline void Z80::rrca() {
+    bool is_bit0_set = is_bit_set(m_reg.A, 0);
+
+    m_reg.A = m_reg.A >> 1;
+    if (is_bit0_set) {
+        bit_set(m_reg.A, 7);
+    } else {
+        bit_reset(m_reg.A, 7);
+    }
+
+    resolve_flags();
+    m_reg.F = (m_reg.F & ~ROTATE_A_FLAGS) | (m_reg.A & FLAGS_53) | (is_bit0_set ? flag_mask(FLAGS::CARRY_C) : 0);
+
+    m_cycles = 4;
+}
+
+inline void Z80::rla() {
+    bool is_bit7_set = is_bit_set(m_reg.A, 7);
+    bool carry = is_flag_set(FLAGS::CARRY_C);
+
+    m_reg.A = (m_reg.A << 1) | (carry ? 1 : 0);
+
+    resolve_flags();
+    m_reg.F = (m_reg.F & ~ROTATE_A_FLAGS) | (m_reg.A & FLAGS_53) | (is_bit7_set ? flag_mask(FLAGS::CARRY_C) : 0);
+
+    m_cycles = 4;
+}
+
+inline void Z80::rra() {
+    bool is_bit0_set = is_bit_set(m_reg.A, 0);
+    bool carry = is_flag_set(FLAGS::CARRY_C);
+
+    m_reg.A = (m_reg.A >> 1) | (carry ? 0x80 : 0);
+
+    resolve_flags();
+    m_reg.F = (m_reg.F & ~ROTATE_A_FLAGS) | (m_reg.A & FLAGS_53) | (is_bit0_set ? flag_mask(FLAGS::CARRY_C) : 0);
+
+    m_cycles = 4;
+}
+
+inline void Z80::daa() {
+    resolve_flags();
+    uint8_t value = m_reg.A;
+    bool subtract = is_bit_set(m_reg.F, FLAGS::SUBTRACT_N);
+    bool half_carry = is_bit_set(m_reg.F, FLAGS::HALF_CARRY_H);
+    bool carry = is_bit_set(m_reg.F, FLAGS::CARRY_C);
+
+    // Add or subtract 6 from every digit that is out of the 0-9 range
+    uint8_t correction = 0;
+    if (half_carry || (value & 0x0F) > 9) {
+        correction |= 0x06;
+    }
+    if (carry || value > 0x99) {
+        correction |= 0x60;
+        carry = true;
+    }
+
+    if (subtract) {
+        m_reg.A -= correction;
+        half_carry = half_carry && (value & 0x0F) < 6;
+    } else {
+        m_reg.A += correction;
+        half_carry = (value & 0x0F) > 9;
+    }
+
+    m_reg.F = SZ53P_FLAGS[m_reg.A] | (subtract ? flag_mask(FLAGS::SUBTRACT_N) : 0) |
+              (half_carry ? flag_mask(FLAGS::HALF_CARRY_H) : 0) | (carry ? flag_mask(FLAGS::CARRY_C) : 0);
+    m_cycles = 4;
+}
+
+inline void Z80::cpl() {
+    m_reg.A = ~m_reg.A;
+
+    resolve_flags();
+    m_reg.F = (m_reg.F & ~FLAGS_53) | (m_reg.A & FLAGS_53) | flag_mask(FLAGS::HALF_CARRY_H) |
+              flag_mask(FLAGS::SUBTRACT_N);
+    m_cycles = 4;
+}
+
+// Flags changed by scf and ccf
+constexpr uint8_t CARRY_OP_FLAGS = flag_mask(FLAGS::HALF_CARRY_H) | flag_mask(FLAGS::SUBTRACT_N) |
+                                          flag_mask(FLAGS::CARRY_C) | FLAGS_53;
+
+inline void Z80::scf() {
+    resolve_flags();
+    m_reg.F = (m_reg.F & ~CARRY_OP_FLAGS) | (m_reg.A & FLAGS_53) | flag_mask(FLAGS::CARRY_C);
+    m_cycles = 4;
+}
+
+inline void Z80::ccf() {
+    resolve_flags();
+    bool carry = is_bit_set(m_reg.F, FLAGS::CARRY_C);
+    m_reg.F = (m_reg.F & ~CARRY_OP_FLAGS) | (m_reg.A & FLAGS_53) |
+              (carry ? flag_mask(FLAGS::HALF_CARRY_H) : flag_mask(FLAGS::CARRY_C));
+    m_cycles = 4;
+}
+
+inline void Z80::ex_16bit_registers(uint16_t &reg1, uint16_t &reg2) {
+    uint16_t tmp = reg1;
+    reg1 = reg2;
+    reg2 = tmp;
+
+    m_cycles = 4;
+}
+
+inline void Z80::ex_af() {
+    resolve_flags();
+    ex_16bit_registers(m_reg.AF, m_shadow.AF);
+}
+
+inline void Z80::exx() {
+    ex_16bit_registers(m_reg.BC, m_shadow.BC);
+    ex_16bit_registers(m_reg.DE, m_shadow.DE);
+    ex_16bit_registers(m_reg.HL, m_shadow.HL);
+}
+
+inline void Z80::ex_SP(uint16_t &reg) {
+    uint16_t value = m_mem->read_word(m_reg.SP);
+    m_mem->write_word(m_reg.SP, reg);
+    reg = value;
+    m_cycles = 19;
+}
+
+inline void Z80::add_16bit(uint16_t &reg, uint16_t value) {
+    uint16_t operand = reg;
+    reg = (reg + value) & 0xFFFF;
+
+    set_lazy_flags(FlagOp::ADD16, flag_mask(FLAGS::HALF_CARRY_H) | flag_mask(FLAGS::SUBTRACT_N) |
+                                  flag_mask(FLAGS::CARRY_C) | FLAGS_53, operand, reg);
+    m_cycles = 11;
+}
+
+inline void Z80::adc_HL(uint16_t value) {
+    int carry = is_flag_set(FLAGS::CARRY_C) ? 1 : 0;
+    int sum = m_reg.HL + value + carry;
+    uint16_t result = sum & 0xFFFF;
+
+    uint8_t f = ((result >> 8) & (flag_mask(FLAGS::SIGN_S) | FLAGS_53)) | (result == 0 ? flag_mask(FLAGS::ZERO_Z) : 0);
+    f |= ((m_reg.HL ^ value ^ result) & 0x1000) ? flag_mask(FLAGS::HALF_CARRY_H) : 0;
+    f |= ((~(m_reg.HL ^ value) & (m_reg.HL ^ result)) & 0x8000) ? flag_mask(FLAGS::OVERFLOW_V) : 0;
+    f |= sum > 0xFFFF ? flag_mask(FLAGS::CARRY_C) : 0;
+
+    m_lazy_flags.op = FlagOp::NONE;
+    m_reg.F = f;
+    m_reg.HL = result;
+    m_cycles = 15;
+}
+
+inline void Z80::sbc_HL(uint16_t value) {
+    int carry = is_flag_set(FLAGS::CARRY_C) ? 1 : 0;
+    int difference = m_reg.HL - value - carry;
+    uint16_t result = difference & 0xFFFF;
+
+    uint8_t f = ((result >> 8) & (flag_mask(FLAGS::SIGN_S) | FLAGS_53)) | (result == 0 ? flag_mask(FLAGS::ZERO_Z) : 0);
+    f |= flag_mask(FLAGS::SUBTRACT_N);
+    f |= ((m_reg.HL ^ value ^ result) & 0x1000) ? flag_mask(FLAGS::HALF_CARRY_H) : 0;
+    f |= (((m_reg.HL ^ value) & (m_reg.HL ^ result)) & 0x8000) ? flag_mask(FLAGS::OVERFLOW_V) : 0;
+    f |= difference < 0 ? flag_mask(FLAGS::CARRY_C) : 0;
+
+    m_lazy_flags.op = FlagOp::NONE;
+    m_reg.F = f;
+    m_reg.HL = result;
+    m_cycles = 15;
+}
+
+inline void Z80::neg() {
+    uint8_t value = m_reg.A;
+    m_reg.A = 0 - value;
+
+    set_lazy_flags(FlagOp::SUB8, ALL_FLAGS, 0, m_reg.A);
+    m_cycles = 8;
+}
+
+inline void Z80::rld() {
+    uint8_t value = m_mem->read(m_reg.HL);
+    m_mem->write(m_reg.HL, (value << 4) | (m_reg.A & 0x0F));
+    m_reg.A = (m_reg.A & 0xF0) | (value >> 4);
+
+    resolve_flags();
+    m_reg.F = (m_reg.F & flag_mask(FLAGS::CARRY_C)) | SZ53P_FLAGS[m_reg.A];
+    m_cycles = 18;
+}
+
+inline void Z80::rrd() {
+    uint8_t value = m_mem->read(m_reg.HL);
+    m_mem->write(m_reg.HL, (m_reg.A << 4) | (value >> 4));
+    m_reg.A = (m_reg.A & 0xF0) | (value & 0x0F);
+
+    resolve_flags();
+    m_reg.F = (m_reg.F & flag_mask(FLAGS::CARRY_C)) | SZ53P_FLAGS[m_reg.A];
+    m_cycles = 18;
+}
+
+inline void Z80::add_A(uint8_t value, int cycles) {
+    uint8_t operand = m_reg.A;
+    m_reg.A += value;
+
+    set_lazy_flags(FlagOp::ADD8, ALL_FLAGS, operand, m_reg.A);
+    m_cycles = cycles;
+}
+
+inline void Z80::adc_A(uint8_t value, int cycles) {
+    int carry = is_flag_set(FLAGS::CARRY_C) ? 1 : 0;
+    int sum = m_reg.A + value + carry;
+    uint8_t result = sum & 0xFF;
+
+    // The carry in makes the result ambiguous in the (operand, result) table, so build F directly
+    uint8_t f = SZ53P_FLAGS[result] & ~flag_mask(FLAGS::PARITY_P);
+    f |= ((m_reg.A ^ value ^ result) & 0x10) ? flag_mask(FLAGS::HALF_CARRY_H) : 0;
+    f |= ((~(m_reg.A ^ value) & (m_reg.A ^ result)) & 0x80) ? flag_mask(FLAGS::OVERFLOW_V) : 0;
+    f |= sum > 0xFF ? flag_mask(FLAGS::CARRY_C) : 0;
+
+    m_lazy_flags.op = FlagOp::NONE;
+    m_reg.F = f;
+    m_reg.A = result;
+    m_cycles = cycles;
+}
+
+inline void Z80::sub_A(uint8_t value, int cycles) {
+    uint8_t operand = m_reg.A;
+    m_reg.A -= value;
+
+    set_lazy_flags(FlagOp::SUB8, ALL_FLAGS, operand, m_reg.A);
+    m_cycles = cycles;
+}
+
+inline void Z80::sbc_A(uint8_t value, int cycles) {
+    int carry = is_flag_set(FLAGS::CARRY_C) ? 1 : 0;
+    int difference = m_reg.A - value - carry;
+    uint8_t result = difference & 0xFF;
+
+    // The carry in makes the result ambiguous in the (operand, result) table, so build F directly
+    uint8_t f = (SZ53P_FLAGS[result] & ~flag_mask(FLAGS::PARITY_P)) | flag_mask(FLAGS::SUBTRACT_N);
+    f |= ((m_reg.A ^ value ^ result) & 0x10) ? flag_mask(FLAGS::HALF_CARRY_H) : 0;
+    f |= (((m_reg.A ^ value) & (m_reg.A ^ result)) & 0x80) ? flag_mask(FLAGS::OVERFLOW_V) : 0;
+    f |= difference < 0 ? flag_mask(FLAGS::CARRY_C) : 0;
+
+    m_lazy_flags.op = FlagOp::NONE;
+    m_reg.F = f;
+    m_reg.A = result;
+    m_cycles = cycles;
+}
+
+inline void Z80::and_A(uint8_t value, int cycles) {
+    m_reg.A &= value;
+
+    set_lazy_flags(FlagOp::AND8, ALL_FLAGS, m_reg.A, m_reg.A);
+    m_cycles = cycles;
+}
+
+inline void Z80::xor_A(uint8_t value, int cycles) {
+    m_reg.A ^= value;
+
+    set_lazy_flags(FlagOp::LOGIC8, ALL_FLAGS, m_reg.A, m_reg.A);
+    m_cycles = cycles;
+}
+
+inline void Z80::or_A(uint8_t value, int cycles) {
+    m_reg.A |= value;
+
+    set_lazy_flags(FlagOp::LOGIC8, ALL_FLAGS, m_reg.A, m_reg.A);
+    m_cycles = cycles;
+}
+
+inline void Z80::cp_A(uint8_t value, int cycles) {
+    uint8_t result = m_reg.A - value;
+
+    set_lazy_flags(FlagOp::CP8, ALL_FLAGS, m_reg.A, result);
+    m_cycles = cycles;
+}
+
+inline void Z80::djnz() {
+  int8_t offset = (int8_t) m_mem->read(m_reg.PC + 1);
+
+  // djnz $ is a delay loop. It can only end when B reaches 0, so all the iterations that jump and that fit before the
+  // run deadline are executed at once
+  if(offset == -2 && m_reg.B != 1) {
+    unsigned long jumps = m_reg.B == 0 ? 255 : m_reg.B - 1;
+    unsigned long fit = m_run_cycles < m_run_deadline ? (m_run_deadline - m_run_cycles + 12) / 13 : 1;
+    unsigned long iterations = std::min(jumps, std::max(fit, 1ul));
+
+    m_reg.B -= iterations;
+    m_run_cycles += 13 * (iterations - 1);
+    m_instruction_count += iterations - 1;
+    m_reg.PC -= 2;
+    m_cycles = 13;
+    return;
+  }
+
+  m_reg.B--;
+  m_cycles = 8;
+
+  if(m_reg.B != 0) {
+    // The jump is relative to the next instruction, which the PC is moved to by this instruction's size (2)
+    m_reg.PC += offset;
+    m_cycles = 13;
+  }
+}
+
+inline void Z80::jump_relative(bool condition) {
+    m_cycles = 7;
+
+    if (condition) {
+        int8_t jump_amount = (int8_t) m_mem->read(m_reg.PC + 1);
+        uint16_t target = m_reg.PC + 2 + jump_amount;
+        // The jump is relative to the next instruction, which the PC is moved to by this instruction's size (2)
+        m_reg.PC += jump_amount;
+        m_cycles = 12;
+
+        if (jump_amount < 0) {
+            idle_branch(target);
+        }
+    }
+}
+
+inline void Z80::jump(bool condition) {
+    m_cycles = 10;
+
+    if (condition) {
+        uint16_t target = m_mem->read_word(m_reg.PC + 1);
+        bool backwards = target <= m_reg.PC;
+        // The PC will be incremented by this instruction's size (3)
+        m_reg.PC = target - 3;
+
+        if (backwards) {
+            idle_branch(target);
+        }
+    }
+}
+
+inline void Z80::jump_register(uint16_t reg) {
+    // The PC will be incremented by this instruction's size (1, after any prefix)
+    m_reg.PC = reg - 1;
+    m_cycles = 4;
+}
+
+inline void Z80::return_from_interrupt() {
+    ret(true, 14);
+    m_iff1 = m_iff2;
+
+    // retn can enable interrupts again, take a pending one after this instruction
+    if (m_iff1 && m_pending_interrupts != 0) {
+        m_run_deadline = 0;
+    }
+}
+
+inline void Z80::set_interrupt_mode(uint8_t mode) {
+    m_interrupt_mode = mode;
+    m_cycles = 8;
+}
+
+inline void Z80::call(bool condition) {
+    m_cycles = 10;
+
+    if (condition) {
+        push_16bit(m_reg.PC + 3);
+        // The PC will be incremented by this instruction's size (3)
+        m_reg.PC = m_mem->read_word(m_reg.PC + 1) - 3;
+        m_cycles = 17;
+    }
+}
+
+inline void Z80::ret(bool condition, int cycles) {
+    m_cycles = 5;
+
+    if (condition) {
+        uint16_t address;
+        pop_16bit(address);
+        // The PC will be incremented by this instruction's size (1)
+        m_reg.PC = address - 1;
+        m_cycles = cycles;
+    }
+}
+
+inline void Z80::rst(uint16_t address) {
+    push_16bit(m_reg.PC + 1);
+    // The PC will be incremented by this instruction's size (1)
+    m_reg.PC = address - 1;
+    m_cycles = 11;
+}
+
+inline void Z80::push_16bit(uint16_t value) {
+    m_reg.SP -= 2;
+    m_mem->write_word(m_reg.SP, value);
+    m_cycles = 11;
+}
+
+inline void Z80::pop_16bit(uint16_t &reg) {
+    reg = m_mem->read_word(m_reg.SP);
+    m_reg.SP += 2;
+    m_cycles = 10;
+}
+
+inline void Z80::push_af() {
+    resolve_flags();
+    push_16bit(m_reg.AF);
+}
+
+inline void Z80::pop_af() {
+    pop_16bit(m_reg.AF);
+    m_lazy_flags.op = FlagOp::NONE;
+}
+
+inline void Z80::set_interrupts(bool enable) {
+    m_iff1 = enable;
+    m_iff2 = enable;
+    m_cycles = 4;
+
+    // Interrupts can only be taken after the instruction that follows ei. If one is pending, the execution loop stops
+    // right after that instruction
+    if (enable) {
+        m_ei_instruction = m_instruction_count;
+        if (m_pending_interrupts != 0) {
+            m_run_deadline = std::min(m_run_deadline, m_run_cycles + m_cycles + 1);
+        }
+    }
+}
+
+inline void Z80::halt() {
+    m_halted = true;
+    m_reg.PC -= 1;
+    m_cycles = 4;
+
+    unsigned long cycle = m_run_cycles + m_cycles;
+    if (cycle < m_run_deadline) {
+        unsigned long nops = (m_run_deadline - cycle + 3) / 4;
+        m_run_cycles += nops * 4;
+        m_instruction_count += nops;
+    }
+}
+
+inline void Z80::invalid_ed() {
+    m_cycles = 8;
+}
+
+inline void Z80::block_compare(int direction, bool repeat) {
+    uint8_t value = m_mem->read(m_reg.HL);
+    uint8_t result = m_reg.A - value;
+    m_reg.HL += direction;
+    m_reg.BC--;
+
+    // Flag reference: http://www.z80.info/z80sflag.htm
+    resolve_flags();
+    bool half_carry = (m_reg.A ^ value ^ result) & 0x10;
+    uint8_t n = result - (half_carry ? 1 : 0);
+    m_reg.F = (m_reg.F & flag_mask(FLAGS::CARRY_C)) |
+              (SZ53P_FLAGS[result] & (flag_mask(FLAGS::SIGN_S) | flag_mask(FLAGS::ZERO_Z)));
+    m_reg.F |= flag_mask(FLAGS::SUBTRACT_N) | (half_carry ? flag_mask(FLAGS::HALF_CARRY_H) : 0);
+    m_reg.F |= (n & flag_mask(FLAGS::COPY_3)) | ((n << 4) & flag_mask(FLAGS::COPY_5));
+    m_reg.F |= m_reg.BC != 0 ? flag_mask(FLAGS::OVERFLOW_V) : 0;
+    m_cycles = 16;
+
+    // Stay on the instruction until BC is 0 or A is found
+    if (repeat && m_reg.BC != 0 && result != 0) {
+        m_reg.PC -= 2;
+        m_cycles = 21;
+    }
+}
+
+inline void Z80::block_load(int direction, bool repeat) {
+    // A single iteration, or for the repeating forms all the ones that fit before the deadline. Each one is a separate
+    // instruction, and all but the last one take 21 cycles
+    unsigned long iterations = 1;
+    if (repeat) {
+        unsigned long remaining = m_reg.BC == 0 ? 0x10000 : m_reg.BC;
+        unsigned long fit = m_run_cycles < m_run_deadline ? (m_run_deadline - m_run_cycles + 20) / 21 : 1;
+        iterations = std::min(remaining, std::max(fit, 1ul));
+    }
+
+    uint8_t value = block_transfer(m_reg.DE, m_reg.HL, iterations, direction);
+    m_reg.HL += direction * iterations;
+    m_reg.DE += direction * iterations;
+    m_reg.BC -= iterations;
+
+    // Flag reference: http://www.z80.info/z80sflag.htm
+    resolve_flags();
+    uint8_t n = m_reg.A + value;
+    m_reg.F &= flag_mask(FLAGS::SIGN_S) | flag_mask(FLAGS::ZERO_Z) | flag_mask(FLAGS::CARRY_C);
+    m_reg.F |= (n & flag_mask(FLAGS::COPY_3)) | ((n << 4) & flag_mask(FLAGS::COPY_5));
+    flag_sr(FLAGS::OVERFLOW_V, m_reg.BC != 0);
+
+    m_run_cycles += 21 * (iterations - 1);
+    m_instruction_count += 2 * (iterations - 1);
+    m_cycles = 16;
+
+    // Stay on the instruction until BC is 0
+    if (repeat && m_reg.BC != 0) {
+        m_reg.PC -= 2;
+        m_cycles = 21;
+    }
+}
+
+inline uint8_t Z80::block_transfer(uint16_t dest, uint16_t src, unsigned long count, int direction) {
+    uint8_t value = 0;
+
+    while (count > 0) {
+        // Copy up to the end of the source or destination page, whichever comes first
+        unsigned long src_offset = src & (MEMORY_PAGE_SIZE - 1);
+        unsigned long dest_offset = dest & (MEMORY_PAGE_SIZE - 1);
+        unsigned long src_room = direction > 0 ? MEMORY_PAGE_SIZE - src_offset : src_offset + 1;
+        unsigned long dest_room = direction > 0 ? MEMORY_PAGE_SIZE - dest_offset : dest_offset + 1;
+        int chunk = static_cast<int>(std::min({count, src_room, dest_room}));
+
+        uint16_t src_low = direction > 0 ? src : src - chunk + 1;
+        uint16_t dest_low = direction > 0 ? dest : dest - chunk + 1;
+        const uint8_t* s = m_mem->read_span(src_low, chunk);
+        uint8_t* d = s != nullptr ? m_mem->write_span(dest_low, chunk) : nullptr;
+
+        if (d == nullptr) {
+            // ROM, mapper registers or decoded code, write one byte at a time
+            for (int i = 0; i < chunk; i++) {
+                value = m_mem->read(src);
+                m_mem->write(dest, value);
+                src += direction;
+                dest += direction;
+            }
+        } else {
+            if (d + chunk <= s || s + chunk <= d) {
+                std::memcpy(d, s, chunk);
+            } else if (d == s + direction) {
+                // Copying onto the next byte fills the range with the first byte, a common way of clearing memory
+                std::memset(d, direction > 0 ? s[0] : s[chunk - 1], chunk);
+            } else if (direction > 0) {
+                for (int i = 0; i < chunk; i++) {
+                    d[i] = s[i];
+                }
+            } else {
+                for (int i = chunk - 1; i >= 0; i--) {
+                    d[i] = s[i];
+                }
+            }
+
+            value = direction > 0 ? d[chunk - 1] : d[0];
+            src += direction * chunk;
+            dest += direction * chunk;
+        }
+
+        count -= chunk;
+    }
+
+    return value;
+}
+
+inline void Z80::output_n() {
+    m_io->write(m_mem->read(m_reg.PC + 1), m_reg.A);
+    m_cycles = 11;
+}
+
+inline void Z80::input_n() {
+    m_reg.A = m_io->read(m_mem->read(m_reg.PC + 1));
+    m_cycles = 11;
+}
+
+inline uint8_t Z80::input_c() {
+    uint8_t value = m_io->read(m_reg.C);
+
+    resolve_flags();
+    m_reg.F = (m_reg.F & flag_mask(FLAGS::CARRY_C)) | SZ53P_FLAGS[value];
+    m_cycles = 12;
+
+    return value;
+}
+
+inline void Z80::output_c(uint8_t value) {
+    m_io->write(m_reg.C, value);
+    m_cycles = 12;
+}
+
+inline void Z80::block_input(int direction, bool repeat) {
+    // All the iterations of the repeating forms that fit before the deadline run at once, like block_load. The deadline
+    // is checked after every port access, as the device can move it
+    uint8_t value;
+    while (true) {
+        value = m_io->read(m_reg.C);
+        m_mem->write(m_reg.HL, value);
+        m_reg.HL += direction;
+        m_reg.B--;
+
+        if (!repeat || m_reg.B == 0 || m_run_cycles + 21 >= m_run_deadline) {
+            break;
+        }
+        m_run_cycles += 21;
+        m_instruction_count += 2;
+    }
+
+    block_io_flags(value, value + ((m_reg.C + direction) & 0xFF));
+
+    // Stay on the instruction until B is 0
+    if (repeat && m_reg.B != 0) {
+        m_reg.PC -= 2;
+        m_cycles = 21;
+    }
+}
+
+inline void Z80::block_output(int direction, bool repeat) {
+    uint8_t value;
+    while (true) {
+        value = m_mem->read(m_reg.HL);
+        m_reg.B--;
+        m_io->write(m_reg.C, value);
+        m_reg.HL += direction;
+
+        if (!repeat || m_reg.B == 0 || m_run_cycles + 21 >= m_run_deadline) {
+            break;
+        }
+        m_run_cycles += 21;
+        m_instruction_count += 2;
+    }
+
+    block_io_flags(value, value + m_reg.L);
+
+    // Stay on the instruction until B is 0
+    if (repeat && m_reg.B != 0) {
+        m_reg.PC -= 2;
+        m_cycles = 21;
+    }
+}
+
+inline void Z80::block_io_flags(uint8_t value, unsigned int sum) {
+    // Flag reference: "The Undocumented Z80 Documented", the flags of ini, ind, outi and outd
+    resolve_flags();
+    m_reg.F = SZ53P_FLAGS[m_reg.B] & ~flag_mask(FLAGS::PARITY_P);
+    m_reg.F |= SZ53P_FLAGS[(sum & 0x07) ^ m_reg.B] & flag_mask(FLAGS::PARITY_P);
+    m_reg.F |= (value & 0x80) ? flag_mask(FLAGS::SUBTRACT_N) : 0;
+    m_reg.F |= sum > 0xFF ? flag_mask(FLAGS::HALF_CARRY_H) | flag_mask(FLAGS::CARRY_C) : 0;
+    m_cycles = 16;
+}
+
+inline void Z80::resolve_flags() {
+    if (m_lazy_flags.op != FlagOp::NONE) {
+        m_reg.F = evaluate_flags();
+        m_lazy_flags.op = FlagOp::NONE;
+    }
+}
+
+inline void Z80::set_lazy_flags(FlagOp op, uint8_t affected, uint16_t operand, uint16_t result) {
+    // The pending flags only need to be built if this operation keeps some of the bits they changed
+    if (m_lazy_flags.op == FlagOp::NONE) {
+        m_lazy_flags.preserved = m_reg.F & ~affected;
+    } else if ((m_lazy_flags.affected & ~affected) == 0) {
+        m_lazy_flags.preserved &= ~affected;
+    } else {
+        m_lazy_flags.preserved = evaluate_flags() & ~affected;
+    }
+
+    m_lazy_flags.op = op;
+    m_lazy_flags.affected = affected;
+    m_lazy_flags.operand = operand;
+    m_lazy_flags.result = result;
+}
+
+// The size of every instruction is a compile time constant, so each handler only needs a single add to move the PC
+#define OPCODE(code, mnemonic, size, handler)   \
+    template<>                                  \
+    inline void Z80::op<code>() {               \
+        handler;                                \
+        m_reg.PC += size;                       \
+    }
+Z80_OPCODE_TABLE(OPCODE)
+#undef OPCODE
+
+// The prefix is skipped before the handler runs, so that the handlers find their operands at the same offsets as in the
+// un-prefixed instructions. The opcode after the prefix is fetched like the prefix itself, which also moves R on
+#define OPCODE(code, mnemonic, size, handler)   \
+    template<>                                  \
+    inline void Z80::op<code>() {               \
+        if (size > 1) {                         \
+            m_instruction_count++;              \
+        }                                       \
+        m_reg.PC += 1;                          \
+        handler;                                \
+        m_reg.PC += size - 1;                   \
+    }
+Z80_PREFIXED_OPCODE_TABLE(OPCODE)
+#undef OPCODE
+
+#define OPCODE(code, mnemonic, size, handler)                                                       \
+    template<>                                                                                      \
+    inline bool Z80::block_step<code>() {                                                           \
+        uint16_t next_pc = m_reg.PC + size;                                                         \
+        m_instruction_count++;                                                                      \
+        m_cycles = 0;                                                                               \
+        op<code>();                                                                                 \
+        m_run_cycles += m_cycles;                                                                   \
+        return m_reg.PC == next_pc && m_run_cycles < m_run_deadline &&                              \
+               m_mem->code_generation() == m_block_code_generation;                                 \
+    }
+Z80_OPCODE_TABLE(OPCODE)
+Z80_PREFIXED_OPCODE_TABLE(OPCODE)
+#undef OPCODE
+
+template<uint16_t Opcode>
+inline bool Z80::aot_step(Z80 &cpu) {
+    return cpu.block_step<Opcode>();
+}
+
+#endif //SOMOS_Z80_OPCODES_H
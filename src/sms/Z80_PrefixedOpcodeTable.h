@@ -0,0 +1,1559 @@
+/**
+ * Z80 PREFIXED OPCODE TABLE
+ *
+ * Opcode tables of the 0xCB, 0xDD, 0xED, 0xFD, 0xDD 0xCB and 0xFD 0xCB prefixes
+ * https://www.smspower.org/Development/InstructionSet
+ * http://www.z80.info/decoding.htm
+ *
+ * Same format as the base table in Z80_OpcodeTable.h, with the opcodes numbered as described by OPCODE_TABLE_CB in
+ * Z80.h. The size includes the prefixes and the handlers run with the PC past the first prefix, see Z80::op.
+ * Entries must be kept in opcode order, 256 per table.
+ *
+ * Instructions that don't use HL, H, L or (hl) ignore a 0xDD or 0xFD prefix. The prefix is an instruction of its own
+ * that takes 4 cycles and the next opcode is decoded as usual ("prefix dd" and "prefix fd"). Index register entries
+ * that reuse the handler of an HL instruction add the 4 cycles of the prefix to it. Opcodes missing from the 0xED table
+ * take 8 cycles and do nothing ("nop").
+ */
+
+#ifndef SOMOS_Z80_PREFIXEDOPCODETABLE_H
+#define SOMOS_Z80_PREFIXEDOPCODETABLE_H
+
+#define Z80_PREFIXED_OPCODE_TABLE(OPCODE) \
+    OPCODE(0x100, "rlc b",            2, (rotate<Rotation::RLC, Operand8::B>()))                  \
+    OPCODE(0x101, "rlc c",            2, (rotate<Rotation::RLC, Operand8::C>()))                  \
+    OPCODE(0x102, "rlc d",            2, (rotate<Rotation::RLC, Operand8::D>()))                  \
+    OPCODE(0x103, "rlc e",            2, (rotate<Rotation::RLC, Operand8::E>()))                  \
+    OPCODE(0x104, "rlc h",            2, (rotate<Rotation::RLC, Operand8::H>()))                  \
+    OPCODE(0x105, "rlc l",            2, (rotate<Rotation::RLC, Operand8::L>()))                  \
+    OPCODE(0x106, "rlc (hl)",         2, (rotate<Rotation::RLC, Operand8::HL_PTR>()))             \
+    OPCODE(0x107, "rlc a",            2, (rotate<Rotation::RLC, Operand8::A>()))                  \
+    OPCODE(0x108, "rrc b",            2, (rotate<Rotation::RRC, Operand8::B>()))                  \
+    OPCODE(0x109, "rrc c",            2, (rotate<Rotation::RRC, Operand8::C>()))                  \
+    OPCODE(0x10A, "rrc d",            2, (rotate<Rotation::RRC, Operand8::D>()))                  \
+    OPCODE(0x10B, "rrc e",            2, (rotate<Rotation::RRC, Operand8::E>()))                  \
+    OPCODE(0x10C, "rrc h",            2, (rotate<Rotation::RRC, Operand8::H>()))                  \
+    OPCODE(0x10D, "rrc l",            2, (rotate<Rotation::RRC, Operand8::L>()))                  \
+    OPCODE(0x10E, "rrc (hl)",         2, (rotate<Rotation::RRC, Operand8::HL_PTR>()))             \
+    OPCODE(0x10F, "rrc a",            2, (rotate<Rotation::RRC, Operand8::A>()))                  \
+    OPCODE(0x110, "rl b",             2, (rotate<Rotation::RL, Operand8::B>()))                   \
+    OPCODE(0x111, "rl c",             2, (rotate<Rotation::RL, Operand8::C>()))                   \
+    OPCODE(0x112, "rl d",             2, (rotate<Rotation::RL, Operand8::D>()))                   \
+    OPCODE(0x113, "rl e",             2, (rotate<Rotation::RL, Operand8::E>()))                   \
+    OPCODE(0x114, "rl h",             2, (rotate<Rotation::RL, Operand8::H>()))                   \
+    OPCODE(0x115, "rl l",             2, (rotate<Rotation::RL, Operand8::L>()))                   \
+    OPCODE(0x116, "rl (hl)",          2, (rotate<Rotation::RL, Operand8::HL_PTR>()))              \
+    OPCODE(0x117, "rl a",             2, (rotate<Rotation::RL, Operand8::A>()))                   \
+    OPCODE(0x118, "rr b",             2, (rotate<Rotation::RR, Operand8::B>()))                   \
+    OPCODE(0x119, "rr c",             2, (rotate<Rotation::RR, Operand8::C>()))                   \
+    OPCODE(0x11A, "rr d",             2, (rotate<Rotation::RR, Operand8::D>()))                   \
+    OPCODE(0x11B, "rr e",             2, (rotate<Rotation::RR, Operand8::E>()))                   \
+    OPCODE(0x11C, "rr h",             2, (rotate<Rotation::RR, Operand8::H>()))                   \
+    OPCODE(0x11D, "rr l",             2, (rotate<Rotation::RR, Operand8::L>()))                   \
+    OPCODE(0x11E, "rr (hl)",          2, (rotate<Rotation::RR, Operand8::HL_PTR>()))              \
+    OPCODE(0x11F, "rr a",             2, (rotate<Rotation::RR, Operand8::A>()))                   \
+    OPCODE(0x120, "sla b",            2, (rotate<Rotation::SLA, Operand8::B>()))                  \
+    OPCODE(0x121, "sla c",            2, (rotate<Rotation::SLA, Operand8::C>()))                  \
+    OPCODE(0x122, "sla d",            2, (rotate<Rotation::SLA, Operand8::D>()))                  \
+    OPCODE(0x123, "sla e",            2, (rotate<Rotation::SLA, Operand8::E>()))                  \
+    OPCODE(0x124, "sla h",            2, (rotate<Rotation::SLA, Operand8::H>()))                  \
+    OPCODE(0x125, "sla l",            2, (rotate<Rotation::SLA, Operand8::L>()))                  \
+    OPCODE(0x126, "sla (hl)",         2, (rotate<Rotation::SLA, Operand8::HL_PTR>()))             \
+    OPCODE(0x127, "sla a",            2, (rotate<Rotation::SLA, Operand8::A>()))                  \
+    OPCODE(0x128, "sra b",            2, (rotate<Rotation::SRA, Operand8::B>()))                  \
+    OPCODE(0x129, "sra c",            2, (rotate<Rotation::SRA, Operand8::C>()))                  \
+    OPCODE(0x12A, "sra d",            2, (rotate<Rotation::SRA, Operand8::D>()))                  \
+    OPCODE(0x12B, "sra e",            2, (rotate<Rotation::SRA, Operand8::E>()))                  \
+    OPCODE(0x12C, "sra h",            2, (rotate<Rotation::SRA, Operand8::H>()))                  \
+    OPCODE(0x12D, "sra l",            2, (rotate<Rotation::SRA, Operand8::L>()))                  \
+    OPCODE(0x12E, "sra (hl)",         2, (rotate<Rotation::SRA, Operand8::HL_PTR>()))             \
+    OPCODE(0x12F, "sra a",            2, (rotate<Rotation::SRA, Operand8::A>()))                  \
+    OPCODE(0x130, "sll b",            2, (rotate<Rotation::SLL, Operand8::B>()))                  \
+    OPCODE(0x131, "sll c",            2, (rotate<Rotation::SLL, Operand8::C>()))                  \
+    OPCODE(0x132, "sll d",            2, (rotate<Rotation::SLL, Operand8::D>()))                  \
+    OPCODE(0x133, "sll e",            2, (rotate<Rotation::SLL, Operand8::E>()))                  \
+    OPCODE(0x134, "sll h",            2, (rotate<Rotation::SLL, Operand8::H>()))                  \
+    OPCODE(0x135, "sll l",            2, (rotate<Rotation::SLL, Operand8::L>()))                  \
+    OPCODE(0x136, "sll (hl)",         2, (rotate<Rotation::SLL, Operand8::HL_PTR>()))             \
+    OPCODE(0x137, "sll a",            2, (rotate<Rotation::SLL, Operand8::A>()))                  \
+    OPCODE(0x138, "srl b",            2, (rotate<Rotation::SRL, Operand8::B>()))                  \
+    OPCODE(0x139, "srl c",            2, (rotate<Rotation::SRL, Operand8::C>()))                  \
+    OPCODE(0x13A, "srl d",            2, (rotate<Rotation::SRL, Operand8::D>()))                  \
+    OPCODE(0x13B, "srl e",            2, (rotate<Rotation::SRL, Operand8::E>()))                  \
+    OPCODE(0x13C, "srl h",            2, (rotate<Rotation::SRL, Operand8::H>()))                  \
+    OPCODE(0x13D, "srl l",            2, (rotate<Rotation::SRL, Operand8::L>()))                  \
+    OPCODE(0x13E, "srl (hl)",         2, (rotate<Rotation::SRL, Operand8::HL_PTR>()))             \
+    OPCODE(0x13F, "srl a",            2, (rotate<Rotation::SRL, Operand8::A>()))                  \
+    OPCODE(0x140, "bit 0, b",         2, (test_bit<0, Operand8::B>()))                            \
+    OPCODE(0x141, "bit 0, c",         2, (test_bit<0, Operand8::C>()))                            \
+    OPCODE(0x142, "bit 0, d",         2, (test_bit<0, Operand8::D>()))                            \
+    OPCODE(0x143, "bit 0, e",         2, (test_bit<0, Operand8::E>()))                            \
+    OPCODE(0x144, "bit 0, h",         2, (test_bit<0, Operand8::H>()))                            \
+    OPCODE(0x145, "bit 0, l",         2, (test_bit<0, Operand8::L>()))                            \
+    OPCODE(0x146, "bit 0, (hl)",      2, (test_bit<0, Operand8::HL_PTR>()))                       \
+    OPCODE(0x147, "bit 0, a",         2, (test_bit<0, Operand8::A>()))                            \
+    OPCODE(0x148, "bit 1, b",         2, (test_bit<1, Operand8::B>()))                            \
+    OPCODE(0x149, "bit 1, c",         2, (test_bit<1, Operand8::C>()))                            \
+    OPCODE(0x14A, "bit 1, d",         2, (test_bit<1, Operand8::D>()))                            \
+    OPCODE(0x14B, "bit 1, e",         2, (test_bit<1, Operand8::E>()))                            \
+    OPCODE(0x14C, "bit 1, h",         2, (test_bit<1, Operand8::H>()))                            \
+    OPCODE(0x14D, "bit 1, l",         2, (test_bit<1, Operand8::L>()))                            \
+    OPCODE(0x14E, "bit 1, (hl)",      2, (test_bit<1, Operand8::HL_PTR>()))                       \
+    OPCODE(0x14F, "bit 1, a",         2, (test_bit<1, Operand8::A>()))                            \
+    OPCODE(0x150, "bit 2, b",         2, (test_bit<2, Operand8::B>()))                            \
+    OPCODE(0x151, "bit 2, c",         2, (test_bit<2, Operand8::C>()))                            \
+    OPCODE(0x152, "bit 2, d",         2, (test_bit<2, Operand8::D>()))                            \
+    OPCODE(0x153, "bit 2, e",         2, (test_bit<2, Operand8::E>()))                            \
+    OPCODE(0x154, "bit 2, h",         2, (test_bit<2, Operand8::H>()))                            \
+    OPCODE(0x155, "bit 2, l",         2, (test_bit<2, Operand8::L>()))                            \
+    OPCODE(0x156, "bit 2, (hl)",      2, (test_bit<2, Operand8::HL_PTR>()))                       \
+    OPCODE(0x157, "bit 2, a",         2, (test_bit<2, Operand8::A>()))                            \
+    OPCODE(0x158, "bit 3, b",         2, (test_bit<3, Operand8::B>()))                            \
+    OPCODE(0x159, "bit 3, c",         2, (test_bit<3, Operand8::C>()))                            \
+    OPCODE(0x15A, "bit 3, d",         2, (test_bit<3, Operand8::D>()))                            \
+    OPCODE(0x15B, "bit 3, e",         2, (test_bit<3, Operand8::E>()))                            \
+    OPCODE(0x15C, "bit 3, h",         2, (test_bit<3, Operand8::H>()))                            \
+    OPCODE(0x15D, "bit 3, l",         2, (test_bit<3, Operand8::L>()))                            \
+    OPCODE(0x15E, "bit 3, (hl)",      2, (test_bit<3, Operand8::HL_PTR>()))                       \
+    OPCODE(0x15F, "bit 3, a",         2, (test_bit<3, Operand8::A>()))                            \
+    OPCODE(0x160, "bit 4, b",         2, (test_bit<4, Operand8::B>()))                            \
+    OPCODE(0x161, "bit 4, c",         2, (test_bit<4, Operand8::C>()))                            \
+    OPCODE(0x162, "bit 4, d",         2, (test_bit<4, Operand8::D>()))                            \
+    OPCODE(0x163, "bit 4, e",         2, (test_bit<4, Operand8::E>()))                            \
+    OPCODE(0x164, "bit 4, h",         2, (test_bit<4, Operand8::H>()))                            \
+    OPCODE(0x165, "bit 4, l",         2, (test_bit<4, Operand8::L>()))                            \
+    OPCODE(0x166, "bit 4, (hl)",      2, (test_bit<4, Operand8::HL_PTR>()))                       \
+    OPCODE(0x167, "bit 4, a",         2, (test_bit<4, Operand8::A>()))                            \
+    OPCODE(0x168, "bit 5, b",         2, (test_bit<5, Operand8::B>()))                            \
+    OPCODE(0x169, "bit 5, c",         2, (test_bit<5, Operand8::C>()))                            \
+    OPCODE(0x16A, "bit 5, d",         2, (test_bit<5, Operand8::D>()))                            \
+    OPCODE(0x16B, "bit 5, e",         2, (test_bit<5, Operand8::E>()))                            \
+    OPCODE(0x16C, "bit 5, h",         2, (test_bit<5, Operand8::H>()))                            \
+    OPCODE(0x16D, "bit 5, l",         2, (test_bit<5, Operand8::L>()))                            \
+    OPCODE(0x16E, "bit 5, (hl)",      2, (test_bit<5, Operand8::HL_PTR>()))                       \
+    OPCODE(0x16F, "bit 5, a",         2, (test_bit<5, Operand8::A>()))                            \
+    OPCODE(0x170, "bit 6, b",         2, (test_bit<6, Operand8::B>()))                            \
+    OPCODE(0x171, "bit 6, c",         2, (test_bit<6, Operand8::C>()))                            \
+    OPCODE(0x172, "bit 6, d",         2, (test_bit<6, Operand8::D>()))                            \
+    OPCODE(0x173, "bit 6, e",         2, (test_bit<6, Operand8::E>()))                            \
+    OPCODE(0x174, "bit 6, h",         2, (test_bit<6, Operand8::H>()))                            \
+    OPCODE(0x175, "bit 6, l",         2, (test_bit<6, Operand8::L>()))                            \
+    OPCODE(0x176, "bit 6, (hl)",      2, (test_bit<6, Operand8::HL_PTR>()))                       \
+    OPCODE(0x177, "bit 6, a",         2, (test_bit<6, Operand8::A>()))                            \
+    OPCODE(0x178, "bit 7, b",         2, (test_bit<7, Operand8::B>()))                            \
+    OPCODE(0x179, "bit 7, c",         2, (test_bit<7, Operand8::C>()))                            \
+    OPCODE(0x17A, "bit 7, d",         2, (test_bit<7, Operand8::D>()))                            \
+    OPCODE(0x17B, "bit 7, e",         2, (test_bit<7, Operand8::E>()))                            \
+    OPCODE(0x17C, "bit 7, h",         2, (test_bit<7, Operand8::H>()))                            \
+    OPCODE(0x17D, "bit 7, l",         2, (test_bit<7, Operand8::L>()))                            \
+    OPCODE(0x17E, "bit 7, (hl)",      2, (test_bit<7, Operand8::HL_PTR>()))                       \
+    OPCODE(0x17F, "bit 7, a",         2, (test_bit<7, Operand8::A>()))                            \
+    OPCODE(0x180, "res 0, b",         2, (change_bit<0, false, Operand8::B>()))                   \
+    OPCODE(0x181, "res 0, c",         2, (change_bit<0, false, Operand8::C>()))                   \
+    OPCODE(0x182, "res 0, d",         2, (change_bit<0, false, Operand8::D>()))                   \
+    OPCODE(0x183, "res 0, e",         2, (change_bit<0, false, Operand8::E>()))                   \
+    OPCODE(0x184, "res 0, h",         2, (change_bit<0, false, Operand8::H>()))                   \
+    OPCODE(0x185, "res 0, l",         2, (change_bit<0, false, Operand8::L>()))                   \
+    OPCODE(0x186, "res 0, (hl)",      2, (change_bit<0, false, Operand8::HL_PTR>()))              \
+    OPCODE(0x187, "res 0, a",         2, (change_bit<0, false, Operand8::A>()))                   \
+    OPCODE(0x188, "res 1, b",         2, (change_bit<1, false, Operand8::B>()))                   \
+    OPCODE(0x189, "res 1, c",         2, (change_bit<1, false, Operand8::C>()))                   \
+    OPCODE(0x18A, "res 1, d",         2, (change_bit<1, false, Operand8::D>()))                   \
+    OPCODE(0x18B, "res 1, e",         2, (change_bit<1, false, Operand8::E>()))                   \
+    OPCODE(0x18C, "res 1, h",         2, (change_bit<1, false, Operand8::H>()))                   \
+    OPCODE(0x18D, "res 1, l",         2, (change_bit<1, false, Operand8::L>()))                   \
+    OPCODE(0x18E, "res 1, (hl)",      2, (change_bit<1, false, Operand8::HL_PTR>()))              \
+    OPCODE(0x18F, "res 1, a",         2, (change_bit<1, false, Operand8::A>()))                   \
+    OPCODE(0x190, "res 2, b",         2, (change_bit<2, false, Operand8::B>()))                   \
+    OPCODE(0x191, "res 2, c",         2, (change_bit<2, false, Operand8::C>()))                   \
+    OPCODE(0x192, "res 2, d",         2, (change_bit<2, false, Operand8::D>()))                   \
+    OPCODE(0x193, "res 2, e",         2, (change_bit<2, false, Operand8::E>()))                   \
+    OPCODE(0x194, "res 2, h",         2, (change_bit<2, false, Operand8::H>()))                   \
+    OPCODE(0x195, "res 2, l",         2, (change_bit<2, false, Operand8::L>()))                   \
+    OPCODE(0x196, "res 2, (hl)",      2, (change_bit<2, false, Operand8::HL_PTR>()))              \
+    OPCODE(0x197, "res 2, a",         2, (change_bit<2, false, Operand8::A>()))                   \
+    OPCODE(0x198, "res 3, b",         2, (change_bit<3, false, Operand8::B>()))                   \
+    OPCODE(0x199, "res 3, c",         2, (change_bit<3, false, Operand8::C>()))                   \
+    OPCODE(0x19A, "res 3, d",         2, (change_bit<3, false, Operand8::D>()))                   \
+    OPCODE(0x19B, "res 3, e",         2, (change_bit<3, false, Operand8::E>()))                   \
+    OPCODE(0x19C, "res 3, h",         2, (change_bit<3, false, Operand8::H>()))                   \
+    OPCODE(0x19D, "res 3, l",         2, (change_bit<3, false, Operand8::L>()))                   \
+    OPCODE(0x19E, "res 3, (hl)",      2, (change_bit<3, false, Operand8::HL_PTR>()))              \
+    OPCODE(0x19F, "res 3, a",         2, (change_bit<3, false, Operand8::A>()))                   \
+    OPCODE(0x1A0, "res 4, b",         2, (change_bit<4, false, Operand8::B>()))                   \
+    OPCODE(0x1A1, "res 4, c",         2, (change_bit<4, false, Operand8::C>()))                   \
+    OPCODE(0x1A2, "res 4, d",         2, (change_bit<4, false, Operand8::D>()))                   \
+    OPCODE(0x1A3, "res 4, e",         2, (change_bit<4, false, Operand8::E>()))                   \
+    OPCODE(0x1A4, "res 4, h",         2, (change_bit<4, false, Operand8::H>()))                   \
+    OPCODE(0x1A5, "res 4, l",         2, (change_bit<4, false, Operand8::L>()))                   \
+    OPCODE(0x1A6, "res 4, (hl)",      2, (change_bit<4, false, Operand8::HL_PTR>()))              \
+    OPCODE(0x1A7, "res 4, a",         2, (change_bit<4, false, Operand8::A>()))                   \
+    OPCODE(0x1A8, "res 5, b",         2, (change_bit<5, false, Operand8::B>()))                   \
+    OPCODE(0x1A9, "res 5, c",         2, (change_bit<5, false, Operand8::C>()))                   \
+    OPCODE(0x1AA, "res 5, d",         2, (change_bit<5, false, Operand8::D>()))                   \
+    OPCODE(0x1AB, "res 5, e",         2, (change_bit<5, false, Operand8::E>()))                   \
+    OPCODE(0x1AC, "res 5, h",         2, (change_bit<5, false, Operand8::H>()))                   \
+    OPCODE(0x1AD, "res 5, l",         2, (change_bit<5, false, Operand8::L>()))                   \
+    OPCODE(0x1AE, "res 5, (hl)",      2, (change_bit<5, false, Operand8::HL_PTR>()))              \
+    OPCODE(0x1AF, "res 5, a",         2, (change_bit<5, false, Operand8::A>()))                   \
+    OPCODE(0x1B0, "res 6, b",         2, (change_bit<6, false, Operand8::B>()))                   \
+    OPCODE(0x1B1, "res 6, c",         2, (change_bit<6, false, Operand8::C>()))                   \
+    OPCODE(0x1B2, "res 6, d",         2, (change_bit<6, false, Operand8::D>()))                   \
+    OPCODE(0x1B3, "res 6, e",         2, (change_bit<6, false, Operand8::E>()))                   \
+    OPCODE(0x1B4, "res 6, h",         2, (change_bit<6, false, Operand8::H>()))                   \
+    OPCODE(0x1B5, "res 6, l",         2, (change_bit<6, false, Operand8::L>()))                   \
+    OPCODE(0x1B6, "res 6, (hl)",      2, (change_bit<6, false, Operand8::HL_PTR>()))              \
+    OPCODE(0x1B7, "res 6, a",         2, (change_bit<6, false, Operand8::A>()))                   \
+    OPCODE(0x1B8, "res 7, b",         2, (change_bit<7, false, Operand8::B>()))                   \
+    OPCODE(0x1B9, "res 7, c",         2, (change_bit<7, false, Operand8::C>()))                   \
+    OPCODE(0x1BA, "res 7, d",         2, (change_bit<7, false, Operand8::D>()))                   \
+    OPCODE(0x1BB, "res 7, e",         2, (change_bit<7, false, Operand8::E>()))                   \
+    OPCODE(0x1BC, "res 7, h",         2, (change_bit<7, false, Operand8::H>()))                   \
+    OPCODE(0x1BD, "res 7, l",         2, (change_bit<7, false, Operand8::L>()))                   \
+    OPCODE(0x1BE, "res 7, (hl)",      2, (change_bit<7, false, Operand8::HL_PTR>()))              \
+    OPCODE(0x1BF, "res 7, a",         2, (change_bit<7, false, Operand8::A>()))                   \
+    OPCODE(0x1C0, "set 0, b",         2, (change_bit<0, true, Operand8::B>()))                    \
+    OPCODE(0x1C1, "set 0, c",         2, (change_bit<0, true, Operand8::C>()))                    \
+    OPCODE(0x1C2, "set 0, d",         2, (change_bit<0, true, Operand8::D>()))                    \
+    OPCODE(0x1C3, "set 0, e",         2, (change_bit<0, true, Operand8::E>()))                    \
+    OPCODE(0x1C4, "set 0, h",         2, (change_bit<0, true, Operand8::H>()))                    \
+    OPCODE(0x1C5, "set 0, l",         2, (change_bit<0, true, Operand8::L>()))                    \
+    OPCODE(0x1C6, "set 0, (hl)",      2, (change_bit<0, true, Operand8::HL_PTR>()))               \
+    OPCODE(0x1C7, "set 0, a",         2, (change_bit<0, true, Operand8::A>()))                    \
+    OPCODE(0x1C8, "set 1, b",         2, (change_bit<1, true, Operand8::B>()))                    \
+    OPCODE(0x1C9, "set 1, c",         2, (change_bit<1, true, Operand8::C>()))                    \
+    OPCODE(0x1CA, "set 1, d",         2, (change_bit<1, true, Operand8::D>()))                    \
+    OPCODE(0x1CB, "set 1, e",         2, (change_bit<1, true, Operand8::E>()))                    \
+    OPCODE(0x1CC, "set 1, h",         2, (change_bit<1, true, Operand8::H>()))                    \
+    OPCODE(0x1CD, "set 1, l",         2, (change_bit<1, true, Operand8::L>()))                    \
+    OPCODE(0x1CE, "set 1, (hl)",      2, (change_bit<1, true, Operand8::HL_PTR>()))               \
+    OPCODE(0x1CF, "set 1, a",         2, (change_bit<1, true, Operand8::A>()))                    \
+    OPCODE(0x1D0, "set 2, b",         2, (change_bit<2, true, Operand8::B>()))                    \
+    OPCODE(0x1D1, "set 2, c",         2, (change_bit<2, true, Operand8::C>()))                    \
+    OPCODE(0x1D2, "set 2, d",         2, (change_bit<2, true, Operand8::D>()))                    \
+    OPCODE(0x1D3, "set 2, e",         2, (change_bit<2, true, Operand8::E>()))                    \
+    OPCODE(0x1D4, "set 2, h",         2, (change_bit<2, true, Operand8::H>()))                    \
+    OPCODE(0x1D5, "set 2, l",         2, (change_bit<2, true, Operand8::L>()))                    \
+    OPCODE(0x1D6, "set 2, (hl)",      2, (change_bit<2, true, Operand8::HL_PTR>()))               \
+    OPCODE(0x1D7, "set 2, a",         2, (change_bit<2, true, Operand8::A>()))                    \
+    OPCODE(0x1D8, "set 3, b",         2, (change_bit<3, true, Operand8::B>()))                    \
+    OPCODE(0x1D9, "set 3, c",         2, (change_bit<3, true, Operand8::C>()))                    \
+    OPCODE(0x1DA, "set 3, d",         2, (change_bit<3, true, Operand8::D>()))                    \
+    OPCODE(0x1DB, "set 3, e",         2, (change_bit<3, true, Operand8::E>()))                    \
+    OPCODE(0x1DC, "set 3, h",         2, (change_bit<3, true, Operand8::H>()))                    \
+    OPCODE(0x1DD, "set 3, l",         2, (change_bit<3, true, Operand8::L>()))                    \
+    OPCODE(0x1DE, "set 3, (hl)",      2, (change_bit<3, true, Operand8::HL_PTR>()))               \
+    OPCODE(0x1DF, "set 3, a",         2, (change_bit<3, true, Operand8::A>()))                    \
+    OPCODE(0x1E0, "set 4, b",         2, (change_bit<4, true, Operand8::B>()))                    \
+    OPCODE(0x1E1, "set 4, c",         2, (change_bit<4, true, Operand8::C>()))                    \
+    OPCODE(0x1E2, "set 4, d",         2, (change_bit<4, true, Operand8::D>()))                    \
+    OPCODE(0x1E3, "set 4, e",         2, (change_bit<4, true, Operand8::E>()))                    \
+    OPCODE(0x1E4, "set 4, h",         2, (change_bit<4, true, Operand8::H>()))                    \
+    OPCODE(0x1E5, "set 4, l",         2, (change_bit<4, true, Operand8::L>()))                    \
+    OPCODE(0x1E6, "set 4, (hl)",      2, (change_bit<4, true, Operand8::HL_PTR>()))               \
+    OPCODE(0x1E7, "set 4, a",         2, (change_bit<4, true, Operand8::A>()))                    \
+    OPCODE(0x1E8, "set 5, b",         2, (change_bit<5, true, Operand8::B>()))                    \
+    OPCODE(0x1E9, "set 5, c",         2, (change_bit<5, true, Operand8::C>()))                    \
+    OPCODE(0x1EA, "set 5, d",         2, (change_bit<5, true, Operand8::D>()))                    \
+    OPCODE(0x1EB, "set 5, e",         2, (change_bit<5, true, Operand8::E>()))                    \
+    OPCODE(0x1EC, "set 5, h",         2, (change_bit<5, true, Operand8::H>()))                    \
+    OPCODE(0x1ED, "set 5, l",         2, (change_bit<5, true, Operand8::L>()))                    \
+    OPCODE(0x1EE, "set 5, (hl)",      2, (change_bit<5, true, Operand8::HL_PTR>()))               \
+    OPCODE(0x1EF, "set 5, a",         2, (change_bit<5, true, Operand8::A>()))                    \
+    OPCODE(0x1F0, "set 6, b",         2, (change_bit<6, true, Operand8::B>()))                    \
+    OPCODE(0x1F1, "set 6, c",         2, (change_bit<6, true, Operand8::C>()))                    \
+    OPCODE(0x1F2, "set 6, d",         2, (change_bit<6, true, Operand8::D>()))                    \
+    OPCODE(0x1F3, "set 6, e",         2, (change_bit<6, true, Operand8::E>()))                    \
+    OPCODE(0x1F4, "set 6, h",         2, (change_bit<6, true, Operand8::H>()))                    \
+    OPCODE(0x1F5, "set 6, l",         2, (change_bit<6, true, Operand8::L>()))                    \
+    OPCODE(0x1F6, "set 6, (hl)",      2, (change_bit<6, true, Operand8::HL_PTR>()))               \
+    OPCODE(0x1F7, "set 6, a",         2, (change_bit<6, true, Operand8::A>()))                    \
+    OPCODE(0x1F8, "set 7, b",         2, (change_bit<7, true, Operand8::B>()))                    \
+    OPCODE(0x1F9, "set 7, c",         2, (change_bit<7, true, Operand8::C>()))                    \
+    OPCODE(0x1FA, "set 7, d",         2, (change_bit<7, true, Operand8::D>()))                    \
+    OPCODE(0x1FB, "set 7, e",         2, (change_bit<7, true, Operand8::E>()))                    \
+    OPCODE(0x1FC, "set 7, h",         2, (change_bit<7, true, Operand8::H>()))                    \
+    OPCODE(0x1FD, "set 7, l",         2, (change_bit<7, true, Operand8::L>()))                    \
+    OPCODE(0x1FE, "set 7, (hl)",      2, (change_bit<7, true, Operand8::HL_PTR>()))               \
+    OPCODE(0x1FF, "set 7, a",         2, (change_bit<7, true, Operand8::A>()))                    \
+    OPCODE(0x200, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x201, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x202, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x203, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x204, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x205, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x206, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x207, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x208, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x209, "add ix, bc",       2, (add_16bit(m_reg.IX, m_reg.BC), m_cycles += 4))          \
+    OPCODE(0x20A, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x20B, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x20C, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x20D, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x20E, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x20F, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x210, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x211, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x212, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x213, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x214, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x215, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x216, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x217, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x218, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x219, "add ix, de",       2, (add_16bit(m_reg.IX, m_reg.DE), m_cycles += 4))          \
+    OPCODE(0x21A, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x21B, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x21C, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x21D, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x21E, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x21F, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x220, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x221, "ld ix, nn",        4, (load_16bit(m_reg.IX), m_cycles += 4))                   \
+    OPCODE(0x222, "ld (nn), ix",      4, (write_16bit_address(m_reg.IX), m_cycles += 4))          \
+    OPCODE(0x223, "inc ix",           2, (inc_16bit(m_reg.IX), m_cycles += 4))                    \
+    OPCODE(0x224, "inc ixh",          2, inc_8bit<Operand8::IXH>())                               \
+    OPCODE(0x225, "dec ixh",          2, dec_8bit<Operand8::IXH>())                               \
+    OPCODE(0x226, "ld ixh, n",        3, (load_8bit<Operand8::IXH, Operand8::N>()))               \
+    OPCODE(0x227, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x228, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x229, "add ix, ix",       2, (add_16bit(m_reg.IX, m_reg.IX), m_cycles += 4))          \
+    OPCODE(0x22A, "ld ix, (nn)",      4, (load_16bit_address(m_reg.IX), m_cycles += 4))           \
+    OPCODE(0x22B, "dec ix",           2, (dec_16bit(m_reg.IX), m_cycles += 4))                    \
+    OPCODE(0x22C, "inc ixl",          2, inc_8bit<Operand8::IXL>())                               \
+    OPCODE(0x22D, "dec ixl",          2, dec_8bit<Operand8::IXL>())                               \
+    OPCODE(0x22E, "ld ixl, n",        3, (load_8bit<Operand8::IXL, Operand8::N>()))               \
+    OPCODE(0x22F, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x230, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x231, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x232, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x233, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x234, "inc (ix+d)",       3, inc_8bit<Operand8::IX_D>())                              \
+    OPCODE(0x235, "dec (ix+d)",       3, dec_8bit<Operand8::IX_D>())                              \
+    OPCODE(0x236, "ld (ix+d), n",     4, load_8bit_indexed_n<Operand8::IX_D>())                   \
+    OPCODE(0x237, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x238, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x239, "add ix, sp",       2, (add_16bit(m_reg.IX, m_reg.SP), m_cycles += 4))          \
+    OPCODE(0x23A, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x23B, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x23C, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x23D, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x23E, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x23F, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x240, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x241, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x242, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x243, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x244, "ld b, ixh",        2, (load_8bit<Operand8::B, Operand8::IXH>()))               \
+    OPCODE(0x245, "ld b, ixl",        2, (load_8bit<Operand8::B, Operand8::IXL>()))               \
+    OPCODE(0x246, "ld b, (ix+d)",     3, (load_8bit<Operand8::B, Operand8::IX_D>()))              \
+    OPCODE(0x247, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x248, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x249, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x24A, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x24B, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x24C, "ld c, ixh",        2, (load_8bit<Operand8::C, Operand8::IXH>()))               \
+    OPCODE(0x24D, "ld c, ixl",        2, (load_8bit<Operand8::C, Operand8::IXL>()))               \
+    OPCODE(0x24E, "ld c, (ix+d)",     3, (load_8bit<Operand8::C, Operand8::IX_D>()))              \
+    OPCODE(0x24F, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x250, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x251, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x252, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x253, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x254, "ld d, ixh",        2, (load_8bit<Operand8::D, Operand8::IXH>()))               \
+    OPCODE(0x255, "ld d, ixl",        2, (load_8bit<Operand8::D, Operand8::IXL>()))               \
+    OPCODE(0x256, "ld d, (ix+d)",     3, (load_8bit<Operand8::D, Operand8::IX_D>()))              \
+    OPCODE(0x257, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x258, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x259, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x25A, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x25B, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x25C, "ld e, ixh",        2, (load_8bit<Operand8::E, Operand8::IXH>()))               \
+    OPCODE(0x25D, "ld e, ixl",        2, (load_8bit<Operand8::E, Operand8::IXL>()))               \
+    OPCODE(0x25E, "ld e, (ix+d)",     3, (load_8bit<Operand8::E, Operand8::IX_D>()))              \
+    OPCODE(0x25F, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x260, "ld ixh, b",        2, (load_8bit<Operand8::IXH, Operand8::B>()))               \
+    OPCODE(0x261, "ld ixh, c",        2, (load_8bit<Operand8::IXH, Operand8::C>()))               \
+    OPCODE(0x262, "ld ixh, d",        2, (load_8bit<Operand8::IXH, Operand8::D>()))               \
+    OPCODE(0x263, "ld ixh, e",        2, (load_8bit<Operand8::IXH, Operand8::E>()))               \
+    OPCODE(0x264, "ld ixh, ixh",      2, (load_8bit<Operand8::IXH, Operand8::IXH>()))             \
+    OPCODE(0x265, "ld ixh, ixl",      2, (load_8bit<Operand8::IXH, Operand8::IXL>()))             \
+    OPCODE(0x266, "ld h, (ix+d)",     3, (load_8bit<Operand8::H, Operand8::IX_D>()))              \
+    OPCODE(0x267, "ld ixh, a",        2, (load_8bit<Operand8::IXH, Operand8::A>()))               \
+    OPCODE(0x268, "ld ixl, b",        2, (load_8bit<Operand8::IXL, Operand8::B>()))               \
+    OPCODE(0x269, "ld ixl, c",        2, (load_8bit<Operand8::IXL, Operand8::C>()))               \
+    OPCODE(0x26A, "ld ixl, d",        2, (load_8bit<Operand8::IXL, Operand8::D>()))               \
+    OPCODE(0x26B, "ld ixl, e",        2, (load_8bit<Operand8::IXL, Operand8::E>()))               \
+    OPCODE(0x26C, "ld ixl, ixh",      2, (load_8bit<Operand8::IXL, Operand8::IXH>()))             \
+    OPCODE(0x26D, "ld ixl, ixl",      2, (load_8bit<Operand8::IXL, Operand8::IXL>()))             \
+    OPCODE(0x26E, "ld l, (ix+d)",     3, (load_8bit<Operand8::L, Operand8::IX_D>()))              \
+    OPCODE(0x26F, "ld ixl, a",        2, (load_8bit<Operand8::IXL, Operand8::A>()))               \
+    OPCODE(0x270, "ld (ix+d), b",     3, (load_8bit<Operand8::IX_D, Operand8::B>()))              \
+    OPCODE(0x271, "ld (ix+d), c",     3, (load_8bit<Operand8::IX_D, Operand8::C>()))              \
+    OPCODE(0x272, "ld (ix+d), d",     3, (load_8bit<Operand8::IX_D, Operand8::D>()))              \
+    OPCODE(0x273, "ld (ix+d), e",     3, (load_8bit<Operand8::IX_D, Operand8::E>()))              \
+    OPCODE(0x274, "ld (ix+d), h",     3, (load_8bit<Operand8::IX_D, Operand8::H>()))              \
+    OPCODE(0x275, "ld (ix+d), l",     3, (load_8bit<Operand8::IX_D, Operand8::L>()))              \
+    OPCODE(0x276, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x277, "ld (ix+d), a",     3, (load_8bit<Operand8::IX_D, Operand8::A>()))              \
+    OPCODE(0x278, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x279, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x27A, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x27B, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x27C, "ld a, ixh",        2, (load_8bit<Operand8::A, Operand8::IXH>()))               \
+    OPCODE(0x27D, "ld a, ixl",        2, (load_8bit<Operand8::A, Operand8::IXL>()))               \
+    OPCODE(0x27E, "ld a, (ix+d)",     3, (load_8bit<Operand8::A, Operand8::IX_D>()))              \
+    OPCODE(0x27F, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x280, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x281, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x282, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x283, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x284, "add a, ixh",       2, add_A<Operand8::IXH>())                                  \
+    OPCODE(0x285, "add a, ixl",       2, add_A<Operand8::IXL>())                                  \
+    OPCODE(0x286, "add a, (ix+d)",    3, add_A<Operand8::IX_D>())                                 \
+    OPCODE(0x287, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x288, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x289, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x28A, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x28B, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x28C, "adc a, ixh",       2, adc_A<Operand8::IXH>())                                  \
+    OPCODE(0x28D, "adc a, ixl",       2, adc_A<Operand8::IXL>())                                  \
+    OPCODE(0x28E, "adc a, (ix+d)",    3, adc_A<Operand8::IX_D>())                                 \
+    OPCODE(0x28F, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x290, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x291, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x292, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x293, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x294, "sub ixh",          2, sub_A<Operand8::IXH>())                                  \
+    OPCODE(0x295, "sub ixl",          2, sub_A<Operand8::IXL>())                                  \
+    OPCODE(0x296, "sub (ix+d)",       3, sub_A<Operand8::IX_D>())                                 \
+    OPCODE(0x297, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x298, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x299, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x29A, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x29B, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x29C, "sbc a, ixh",       2, sbc_A<Operand8::IXH>())                                  \
+    OPCODE(0x29D, "sbc a, ixl",       2, sbc_A<Operand8::IXL>())                                  \
+    OPCODE(0x29E, "sbc a, (ix+d)",    3, sbc_A<Operand8::IX_D>())                                 \
+    OPCODE(0x29F, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2A0, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2A1, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2A2, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2A3, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2A4, "and ixh",          2, and_A<Operand8::IXH>())                                  \
+    OPCODE(0x2A5, "and ixl",          2, and_A<Operand8::IXL>())                                  \
+    OPCODE(0x2A6, "and (ix+d)",       3, and_A<Operand8::IX_D>())                                 \
+    OPCODE(0x2A7, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2A8, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2A9, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2AA, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2AB, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2AC, "xor ixh",          2, xor_A<Operand8::IXH>())                                  \
+    OPCODE(0x2AD, "xor ixl",          2, xor_A<Operand8::IXL>())                                  \
+    OPCODE(0x2AE, "xor (ix+d)",       3, xor_A<Operand8::IX_D>())                                 \
+    OPCODE(0x2AF, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2B0, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2B1, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2B2, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2B3, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2B4, "or ixh",           2, or_A<Operand8::IXH>())                                   \
+    OPCODE(0x2B5, "or ixl",           2, or_A<Operand8::IXL>())                                   \
+    OPCODE(0x2B6, "or (ix+d)",        3, or_A<Operand8::IX_D>())                                  \
+    OPCODE(0x2B7, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2B8, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2B9, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2BA, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2BB, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2BC, "cp ixh",           2, cp_A<Operand8::IXH>())                                   \
+    OPCODE(0x2BD, "cp ixl",           2, cp_A<Operand8::IXL>())                                   \
+    OPCODE(0x2BE, "cp (ix+d)",        3, cp_A<Operand8::IX_D>())                                  \
+    OPCODE(0x2BF, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2C0, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2C1, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2C2, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2C3, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2C4, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2C5, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2C6, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2C7, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2C8, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2C9, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2CA, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2CB, "prefix ddcb",      0, not_implemented())                                       \
+    OPCODE(0x2CC, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2CD, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2CE, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2CF, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2D0, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2D1, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2D2, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2D3, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2D4, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2D5, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2D6, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2D7, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2D8, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2D9, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2DA, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2DB, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2DC, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2DD, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2DE, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2DF, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2E0, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2E1, "pop ix",           2, (pop_16bit(m_reg.IX), m_cycles += 4))                    \
+    OPCODE(0x2E2, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2E3, "ex (sp), ix",      2, (ex_SP(m_reg.IX), m_cycles += 4))                        \
+    OPCODE(0x2E4, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2E5, "push ix",          2, (push_16bit(m_reg.IX), m_cycles += 4))                   \
+    OPCODE(0x2E6, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2E7, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2E8, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2E9, "jp (ix)",          2, (jump_register(m_reg.IX), m_cycles += 4))                \
+    OPCODE(0x2EA, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2EB, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2EC, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2ED, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2EE, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2EF, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2F0, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2F1, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2F2, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2F3, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2F4, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2F5, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2F6, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2F7, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2F8, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2F9, "ld sp, ix",        2, (load_SP(m_reg.IX), m_cycles += 4))                      \
+    OPCODE(0x2FA, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2FB, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2FC, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2FD, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2FE, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x2FF, "prefix dd",        1, nop())                                                   \
+    OPCODE(0x300, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x301, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x302, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x303, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x304, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x305, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x306, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x307, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x308, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x309, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x30A, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x30B, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x30C, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x30D, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x30E, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x30F, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x310, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x311, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x312, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x313, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x314, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x315, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x316, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x317, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x318, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x319, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x31A, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x31B, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x31C, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x31D, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x31E, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x31F, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x320, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x321, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x322, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x323, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x324, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x325, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x326, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x327, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x328, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x329, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x32A, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x32B, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x32C, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x32D, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x32E, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x32F, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x330, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x331, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x332, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x333, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x334, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x335, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x336, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x337, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x338, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x339, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x33A, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x33B, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x33C, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x33D, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x33E, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x33F, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x340, "in b, (c)",        2, (m_reg.B = input_c()))                                   \
+    OPCODE(0x341, "out (c), b",       2, output_c(m_reg.B))                                       \
+    OPCODE(0x342, "sbc hl, bc",       2, sbc_HL(m_reg.BC))                                        \
+    OPCODE(0x343, "ld (nn), bc",      4, (write_16bit_address(m_reg.BC), m_cycles += 4))          \
+    OPCODE(0x344, "neg",              2, neg())                                                   \
+    OPCODE(0x345, "retn",             2, return_from_interrupt())                                 \
+    OPCODE(0x346, "im 0",             2, set_interrupt_mode(0))                                   \
+    OPCODE(0x347, "ld i, a",          2, load_I_A())                                              \
+    OPCODE(0x348, "in c, (c)",        2, (m_reg.C = input_c()))                                   \
+    OPCODE(0x349, "out (c), c",       2, output_c(m_reg.C))                                       \
+    OPCODE(0x34A, "adc hl, bc",       2, adc_HL(m_reg.BC))                                        \
+    OPCODE(0x34B, "ld bc, (nn)",      4, (load_16bit_address(m_reg.BC), m_cycles += 4))           \
+    OPCODE(0x34C, "neg",              2, neg())                                                   \
+    OPCODE(0x34D, "reti",             2, return_from_interrupt())                                 \
+    OPCODE(0x34E, "im 0",             2, set_interrupt_mode(0))                                   \
+    OPCODE(0x34F, "ld r, a",          2, load_R_A())                                              \
+    OPCODE(0x350, "in d, (c)",        2, (m_reg.D = input_c()))                                   \
+    OPCODE(0x351, "out (c), d",       2, output_c(m_reg.D))                                       \
+    OPCODE(0x352, "sbc hl, de",       2, sbc_HL(m_reg.DE))                                        \
+    OPCODE(0x353, "ld (nn), de",      4, (write_16bit_address(m_reg.DE), m_cycles += 4))          \
+    OPCODE(0x354, "neg",              2, neg())                                                   \
+    OPCODE(0x355, "retn",             2, return_from_interrupt())                                 \
+    OPCODE(0x356, "im 1",             2, set_interrupt_mode(1))                                   \
+    OPCODE(0x357, "ld a, i",          2, load_A_IR(m_reg.I))                                      \
+    OPCODE(0x358, "in e, (c)",        2, (m_reg.E = input_c()))                                   \
+    OPCODE(0x359, "out (c), e",       2, output_c(m_reg.E))                                       \
+    OPCODE(0x35A, "adc hl, de",       2, adc_HL(m_reg.DE))                                        \
+    OPCODE(0x35B, "ld de, (nn)",      4, (load_16bit_address(m_reg.DE), m_cycles += 4))           \
+    OPCODE(0x35C, "neg",              2, neg())                                                   \
+    OPCODE(0x35D, "retn",             2, return_from_interrupt())                                 \
+    OPCODE(0x35E, "im 2",             2, set_interrupt_mode(2))                                   \
+    OPCODE(0x35F, "ld a, r",          2, load_A_IR(refresh_r()))                                  \
+    OPCODE(0x360, "in h, (c)",        2, (m_reg.H = input_c()))                                   \
+    OPCODE(0x361, "out (c), h",       2, output_c(m_reg.H))                                       \
+    OPCODE(0x362, "sbc hl, hl",       2, sbc_HL(m_reg.HL))                                        \
+    OPCODE(0x363, "ld (nn), hl",      4, (write_16bit_address(m_reg.HL), m_cycles += 4))          \
+    OPCODE(0x364, "neg",              2, neg())                                                   \
+    OPCODE(0x365, "retn",             2, return_from_interrupt())                                 \
+    OPCODE(0x366, "im 0",             2, set_interrupt_mode(0))                                   \
+    OPCODE(0x367, "rrd",              2, rrd())                                                   \
+    OPCODE(0x368, "in l, (c)",        2, (m_reg.L = input_c()))                                   \
+    OPCODE(0x369, "out (c), l",       2, output_c(m_reg.L))                                       \
+    OPCODE(0x36A, "adc hl, hl",       2, adc_HL(m_reg.HL))                                        \
+    OPCODE(0x36B, "ld hl, (nn)",      4, (load_16bit_address(m_reg.HL), m_cycles += 4))           \
+    OPCODE(0x36C, "neg",              2, neg())                                                   \
+    OPCODE(0x36D, "retn",             2, return_from_interrupt())                                 \
+    OPCODE(0x36E, "im 0",             2, set_interrupt_mode(0))                                   \
+    OPCODE(0x36F, "rld",              2, rld())                                                   \
+    OPCODE(0x370, "in (c)",           2, input_c())                                               \
+    OPCODE(0x371, "out (c), 0",       2, output_c(0))                                             \
+    OPCODE(0x372, "sbc hl, sp",       2, sbc_HL(m_reg.SP))                                        \
+    OPCODE(0x373, "ld (nn), sp",      4, (write_16bit_address(m_reg.SP), m_cycles += 4))          \
+    OPCODE(0x374, "neg",              2, neg())                                                   \
+    OPCODE(0x375, "retn",             2, return_from_interrupt())                                 \
+    OPCODE(0x376, "im 1",             2, set_interrupt_mode(1))                                   \
+    OPCODE(0x377, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x378, "in a, (c)",        2, (m_reg.A = input_c()))                                   \
+    OPCODE(0x379, "out (c), a",       2, output_c(m_reg.A))                                       \
+    OPCODE(0x37A, "adc hl, sp",       2, adc_HL(m_reg.SP))                                        \
+    OPCODE(0x37B, "ld sp, (nn)",      4, (load_16bit_address(m_reg.SP), m_cycles += 4))           \
+    OPCODE(0x37C, "neg",              2, neg())                                                   \
+    OPCODE(0x37D, "retn",             2, return_from_interrupt())                                 \
+    OPCODE(0x37E, "im 2",             2, set_interrupt_mode(2))                                   \
+    OPCODE(0x37F, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x380, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x381, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x382, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x383, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x384, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x385, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x386, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x387, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x388, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x389, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x38A, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x38B, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x38C, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x38D, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x38E, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x38F, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x390, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x391, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x392, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x393, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x394, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x395, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x396, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x397, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x398, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x399, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x39A, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x39B, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x39C, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x39D, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x39E, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x39F, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3A0, "ldi",              2, block_load(1, false))                                    \
+    OPCODE(0x3A1, "cpi",              2, block_compare(1, false))                                 \
+    OPCODE(0x3A2, "ini",              2, block_input(1, false))                                   \
+    OPCODE(0x3A3, "outi",             2, block_output(1, false))                                  \
+    OPCODE(0x3A4, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3A5, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3A6, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3A7, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3A8, "ldd",              2, block_load(-1, false))                                   \
+    OPCODE(0x3A9, "cpd",              2, block_compare(-1, false))                                \
+    OPCODE(0x3AA, "ind",              2, block_input(-1, false))                                  \
+    OPCODE(0x3AB, "outd",             2, block_output(-1, false))                                 \
+    OPCODE(0x3AC, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3AD, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3AE, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3AF, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3B0, "ldir",             2, block_load(1, true))                                     \
+    OPCODE(0x3B1, "cpir",             2, block_compare(1, true))                                  \
+    OPCODE(0x3B2, "inir",             2, block_input(1, true))                                    \
+    OPCODE(0x3B3, "otir",             2, block_output(1, true))                                   \
+    OPCODE(0x3B4, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3B5, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3B6, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3B7, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3B8, "lddr",             2, block_load(-1, true))                                    \
+    OPCODE(0x3B9, "cpdr",             2, block_compare(-1, true))                                 \
+    OPCODE(0x3BA, "indr",             2, block_input(-1, true))                                   \
+    OPCODE(0x3BB, "otdr",             2, block_output(-1, true))                                  \
+    OPCODE(0x3BC, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3BD, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3BE, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3BF, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3C0, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3C1, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3C2, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3C3, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3C4, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3C5, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3C6, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3C7, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3C8, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3C9, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3CA, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3CB, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3CC, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3CD, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3CE, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3CF, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3D0, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3D1, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3D2, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3D3, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3D4, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3D5, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3D6, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3D7, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3D8, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3D9, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3DA, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3DB, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3DC, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3DD, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3DE, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3DF, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3E0, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3E1, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3E2, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3E3, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3E4, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3E5, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3E6, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3E7, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3E8, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3E9, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3EA, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3EB, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3EC, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3ED, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3EE, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3EF, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3F0, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3F1, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3F2, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3F3, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3F4, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3F5, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3F6, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3F7, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3F8, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3F9, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3FA, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3FB, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3FC, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3FD, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3FE, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x3FF, "nop",              2, invalid_ed())                                            \
+    OPCODE(0x400, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x401, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x402, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x403, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x404, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x405, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x406, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x407, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x408, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x409, "add iy, bc",       2, (add_16bit(m_reg.IY, m_reg.BC), m_cycles += 4))          \
+    OPCODE(0x40A, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x40B, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x40C, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x40D, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x40E, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x40F, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x410, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x411, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x412, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x413, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x414, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x415, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x416, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x417, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x418, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x419, "add iy, de",       2, (add_16bit(m_reg.IY, m_reg.DE), m_cycles += 4))          \
+    OPCODE(0x41A, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x41B, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x41C, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x41D, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x41E, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x41F, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x420, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x421, "ld iy, nn",        4, (load_16bit(m_reg.IY), m_cycles += 4))                   \
+    OPCODE(0x422, "ld (nn), iy",      4, (write_16bit_address(m_reg.IY), m_cycles += 4))          \
+    OPCODE(0x423, "inc iy",           2, (inc_16bit(m_reg.IY), m_cycles += 4))                    \
+    OPCODE(0x424, "inc iyh",          2, inc_8bit<Operand8::IYH>())                               \
+    OPCODE(0x425, "dec iyh",          2, dec_8bit<Operand8::IYH>())                               \
+    OPCODE(0x426, "ld iyh, n",        3, (load_8bit<Operand8::IYH, Operand8::N>()))               \
+    OPCODE(0x427, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x428, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x429, "add iy, iy",       2, (add_16bit(m_reg.IY, m_reg.IY), m_cycles += 4))          \
+    OPCODE(0x42A, "ld iy, (nn)",      4, (load_16bit_address(m_reg.IY), m_cycles += 4))           \
+    OPCODE(0x42B, "dec iy",           2, (dec_16bit(m_reg.IY), m_cycles += 4))                    \
+    OPCODE(0x42C, "inc iyl",          2, inc_8bit<Operand8::IYL>())                               \
+    OPCODE(0x42D, "dec iyl",          2, dec_8bit<Operand8::IYL>())                               \
+    OPCODE(0x42E, "ld iyl, n",        3, (load_8bit<Operand8::IYL, Operand8::N>()))               \
+    OPCODE(0x42F, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x430, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x431, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x432, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x433, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x434, "inc (iy+d)",       3, inc_8bit<Operand8::IY_D>())                              \
+    OPCODE(0x435, "dec (iy+d)",       3, dec_8bit<Operand8::IY_D>())                              \
+    OPCODE(0x436, "ld (iy+d), n",     4, load_8bit_indexed_n<Operand8::IY_D>())                   \
+    OPCODE(0x437, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x438, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x439, "add iy, sp",       2, (add_16bit(m_reg.IY, m_reg.SP), m_cycles += 4))          \
+    OPCODE(0x43A, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x43B, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x43C, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x43D, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x43E, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x43F, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x440, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x441, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x442, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x443, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x444, "ld b, iyh",        2, (load_8bit<Operand8::B, Operand8::IYH>()))               \
+    OPCODE(0x445, "ld b, iyl",        2, (load_8bit<Operand8::B, Operand8::IYL>()))               \
+    OPCODE(0x446, "ld b, (iy+d)",     3, (load_8bit<Operand8::B, Operand8::IY_D>()))              \
+    OPCODE(0x447, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x448, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x449, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x44A, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x44B, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x44C, "ld c, iyh",        2, (load_8bit<Operand8::C, Operand8::IYH>()))               \
+    OPCODE(0x44D, "ld c, iyl",        2, (load_8bit<Operand8::C, Operand8::IYL>()))               \
+    OPCODE(0x44E, "ld c, (iy+d)",     3, (load_8bit<Operand8::C, Operand8::IY_D>()))              \
+    OPCODE(0x44F, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x450, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x451, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x452, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x453, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x454, "ld d, iyh",        2, (load_8bit<Operand8::D, Operand8::IYH>()))               \
+    OPCODE(0x455, "ld d, iyl",        2, (load_8bit<Operand8::D, Operand8::IYL>()))               \
+    OPCODE(0x456, "ld d, (iy+d)",     3, (load_8bit<Operand8::D, Operand8::IY_D>()))              \
+    OPCODE(0x457, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x458, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x459, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x45A, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x45B, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x45C, "ld e, iyh",        2, (load_8bit<Operand8::E, Operand8::IYH>()))               \
+    OPCODE(0x45D, "ld e, iyl",        2, (load_8bit<Operand8::E, Operand8::IYL>()))               \
+    OPCODE(0x45E, "ld e, (iy+d)",     3, (load_8bit<Operand8::E, Operand8::IY_D>()))              \
+    OPCODE(0x45F, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x460, "ld iyh, b",        2, (load_8bit<Operand8::IYH, Operand8::B>()))               \
+    OPCODE(0x461, "ld iyh, c",        2, (load_8bit<Operand8::IYH, Operand8::C>()))               \
+    OPCODE(0x462, "ld iyh, d",        2, (load_8bit<Operand8::IYH, Operand8::D>()))               \
+    OPCODE(0x463, "ld iyh, e",        2, (load_8bit<Operand8::IYH, Operand8::E>()))               \
+    OPCODE(0x464, "ld iyh, iyh",      2, (load_8bit<Operand8::IYH, Operand8::IYH>()))             \
+    OPCODE(0x465, "ld iyh, iyl",      2, (load_8bit<Operand8::IYH, Operand8::IYL>()))             \
+    OPCODE(0x466, "ld h, (iy+d)",     3, (load_8bit<Operand8::H, Operand8::IY_D>()))              \
+    OPCODE(0x467, "ld iyh, a",        2, (load_8bit<Operand8::IYH, Operand8::A>()))               \
+    OPCODE(0x468, "ld iyl, b",        2, (load_8bit<Operand8::IYL, Operand8::B>()))               \
+    OPCODE(0x469, "ld iyl, c",        2, (load_8bit<Operand8::IYL, Operand8::C>()))               \
+    OPCODE(0x46A, "ld iyl, d",        2, (load_8bit<Operand8::IYL, Operand8::D>()))               \
+    OPCODE(0x46B, "ld iyl, e",        2, (load_8bit<Operand8::IYL, Operand8::E>()))               \
+    OPCODE(0x46C, "ld iyl, iyh",      2, (load_8bit<Operand8::IYL, Operand8::IYH>()))             \
+    OPCODE(0x46D, "ld iyl, iyl",      2, (load_8bit<Operand8::IYL, Operand8::IYL>()))             \
+    OPCODE(0x46E, "ld l, (iy+d)",     3, (load_8bit<Operand8::L, Operand8::IY_D>()))              \
+    OPCODE(0x46F, "ld iyl, a",        2, (load_8bit<Operand8::IYL, Operand8::A>()))               \
+    OPCODE(0x470, "ld (iy+d), b",     3, (load_8bit<Operand8::IY_D, Operand8::B>()))              \
+    OPCODE(0x471, "ld (iy+d), c",     3, (load_8bit<Operand8::IY_D, Operand8::C>()))              \
+    OPCODE(0x472, "ld (iy+d), d",     3, (load_8bit<Operand8::IY_D, Operand8::D>()))              \
+    OPCODE(0x473, "ld (iy+d), e",     3, (load_8bit<Operand8::IY_D, Operand8::E>()))              \
+    OPCODE(0x474, "ld (iy+d), h",     3, (load_8bit<Operand8::IY_D, Operand8::H>()))              \
+    OPCODE(0x475, "ld (iy+d), l",     3, (load_8bit<Operand8::IY_D, Operand8::L>()))              \
+    OPCODE(0x476, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x477, "ld (iy+d), a",     3, (load_8bit<Operand8::IY_D, Operand8::A>()))              \
+    OPCODE(0x478, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x479, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x47A, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x47B, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x47C, "ld a, iyh",        2, (load_8bit<Operand8::A, Operand8::IYH>()))               \
+    OPCODE(0x47D, "ld a, iyl",        2, (load_8bit<Operand8::A, Operand8::IYL>()))               \
+    OPCODE(0x47E, "ld a, (iy+d)",     3, (load_8bit<Operand8::A, Operand8::IY_D>()))              \
+    OPCODE(0x47F, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x480, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x481, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x482, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x483, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x484, "add a, iyh",       2, add_A<Operand8::IYH>())                                  \
+    OPCODE(0x485, "add a, iyl",       2, add_A<Operand8::IYL>())                                  \
+    OPCODE(0x486, "add a, (iy+d)",    3, add_A<Operand8::IY_D>())                                 \
+    OPCODE(0x487, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x488, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x489, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x48A, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x48B, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x48C, "adc a, iyh",       2, adc_A<Operand8::IYH>())                                  \
+    OPCODE(0x48D, "adc a, iyl",       2, adc_A<Operand8::IYL>())                                  \
+    OPCODE(0x48E, "adc a, (iy+d)",    3, adc_A<Operand8::IY_D>())                                 \
+    OPCODE(0x48F, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x490, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x491, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x492, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x493, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x494, "sub iyh",          2, sub_A<Operand8::IYH>())                                  \
+    OPCODE(0x495, "sub iyl",          2, sub_A<Operand8::IYL>())                                  \
+    OPCODE(0x496, "sub (iy+d)",       3, sub_A<Operand8::IY_D>())                                 \
+    OPCODE(0x497, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x498, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x499, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x49A, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x49B, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x49C, "sbc a, iyh",       2, sbc_A<Operand8::IYH>())                                  \
+    OPCODE(0x49D, "sbc a, iyl",       2, sbc_A<Operand8::IYL>())                                  \
+    OPCODE(0x49E, "sbc a, (iy+d)",    3, sbc_A<Operand8::IY_D>())                                 \
+    OPCODE(0x49F, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4A0, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4A1, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4A2, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4A3, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4A4, "and iyh",          2, and_A<Operand8::IYH>())                                  \
+    OPCODE(0x4A5, "and iyl",          2, and_A<Operand8::IYL>())                                  \
+    OPCODE(0x4A6, "and (iy+d)",       3, and_A<Operand8::IY_D>())                                 \
+    OPCODE(0x4A7, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4A8, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4A9, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4AA, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4AB, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4AC, "xor iyh",          2, xor_A<Operand8::IYH>())                                  \
+    OPCODE(0x4AD, "xor iyl",          2, xor_A<Operand8::IYL>())                                  \
+    OPCODE(0x4AE, "xor (iy+d)",       3, xor_A<Operand8::IY_D>())                                 \
+    OPCODE(0x4AF, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4B0, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4B1, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4B2, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4B3, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4B4, "or iyh",           2, or_A<Operand8::IYH>())                                   \
+    OPCODE(0x4B5, "or iyl",           2, or_A<Operand8::IYL>())                                   \
+    OPCODE(0x4B6, "or (iy+d)",        3, or_A<Operand8::IY_D>())                                  \
+    OPCODE(0x4B7, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4B8, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4B9, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4BA, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4BB, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4BC, "cp iyh",           2, cp_A<Operand8::IYH>())                                   \
+    OPCODE(0x4BD, "cp iyl",           2, cp_A<Operand8::IYL>())                                   \
+    OPCODE(0x4BE, "cp (iy+d)",        3, cp_A<Operand8::IY_D>())                                  \
+    OPCODE(0x4BF, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4C0, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4C1, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4C2, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4C3, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4C4, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4C5, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4C6, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4C7, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4C8, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4C9, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4CA, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4CB, "prefix fdcb",      0, not_implemented())                                       \
+    OPCODE(0x4CC, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4CD, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4CE, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4CF, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4D0, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4D1, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4D2, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4D3, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4D4, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4D5, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4D6, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4D7, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4D8, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4D9, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4DA, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4DB, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4DC, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4DD, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4DE, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4DF, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4E0, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4E1, "pop iy",           2, (pop_16bit(m_reg.IY), m_cycles += 4))                    \
+    OPCODE(0x4E2, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4E3, "ex (sp), iy",      2, (ex_SP(m_reg.IY), m_cycles += 4))                        \
+    OPCODE(0x4E4, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4E5, "push iy",          2, (push_16bit(m_reg.IY), m_cycles += 4))                   \
+    OPCODE(0x4E6, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4E7, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4E8, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4E9, "jp (iy)",          2, (jump_register(m_reg.IY), m_cycles += 4))                \
+    OPCODE(0x4EA, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4EB, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4EC, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4ED, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4EE, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4EF, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4F0, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4F1, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4F2, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4F3, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4F4, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4F5, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4F6, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4F7, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4F8, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4F9, "ld sp, iy",        2, (load_SP(m_reg.IY), m_cycles += 4))                      \
+    OPCODE(0x4FA, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4FB, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4FC, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4FD, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4FE, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x4FF, "prefix fd",        1, nop())                                                   \
+    OPCODE(0x500, "rlc (ix+d), b",    4, (rotate<Rotation::RLC, Operand8::IX_D, Operand8::B>()))  \
+    OPCODE(0x501, "rlc (ix+d), c",    4, (rotate<Rotation::RLC, Operand8::IX_D, Operand8::C>()))  \
+    OPCODE(0x502, "rlc (ix+d), d",    4, (rotate<Rotation::RLC, Operand8::IX_D, Operand8::D>()))  \
+    OPCODE(0x503, "rlc (ix+d), e",    4, (rotate<Rotation::RLC, Operand8::IX_D, Operand8::E>()))  \
+    OPCODE(0x504, "rlc (ix+d), h",    4, (rotate<Rotation::RLC, Operand8::IX_D, Operand8::H>()))  \
+    OPCODE(0x505, "rlc (ix+d), l",    4, (rotate<Rotation::RLC, Operand8::IX_D, Operand8::L>()))  \
+    OPCODE(0x506, "rlc (ix+d)",       4, (rotate<Rotation::RLC, Operand8::IX_D>()))               \
+    OPCODE(0x507, "rlc (ix+d), a",    4, (rotate<Rotation::RLC, Operand8::IX_D, Operand8::A>()))  \
+    OPCODE(0x508, "rrc (ix+d), b",    4, (rotate<Rotation::RRC, Operand8::IX_D, Operand8::B>()))  \
+    OPCODE(0x509, "rrc (ix+d), c",    4, (rotate<Rotation::RRC, Operand8::IX_D, Operand8::C>()))  \
+    OPCODE(0x50A, "rrc (ix+d), d",    4, (rotate<Rotation::RRC, Operand8::IX_D, Operand8::D>()))  \
+    OPCODE(0x50B, "rrc (ix+d), e",    4, (rotate<Rotation::RRC, Operand8::IX_D, Operand8::E>()))  \
+    OPCODE(0x50C, "rrc (ix+d), h",    4, (rotate<Rotation::RRC, Operand8::IX_D, Operand8::H>()))  \
+    OPCODE(0x50D, "rrc (ix+d), l",    4, (rotate<Rotation::RRC, Operand8::IX_D, Operand8::L>()))  \
+    OPCODE(0x50E, "rrc (ix+d)",       4, (rotate<Rotation::RRC, Operand8::IX_D>()))               \
+    OPCODE(0x50F, "rrc (ix+d), a",    4, (rotate<Rotation::RRC, Operand8::IX_D, Operand8::A>()))  \
+    OPCODE(0x510, "rl (ix+d), b",     4, (rotate<Rotation::RL, Operand8::IX_D, Operand8::B>()))   \
+    OPCODE(0x511, "rl (ix+d), c",     4, (rotate<Rotation::RL, Operand8::IX_D, Operand8::C>()))   \
+    OPCODE(0x512, "rl (ix+d), d",     4, (rotate<Rotation::RL, Operand8::IX_D, Operand8::D>()))   \
+    OPCODE(0x513, "rl (ix+d), e",     4, (rotate<Rotation::RL, Operand8::IX_D, Operand8::E>()))   \
+    OPCODE(0x514, "rl (ix+d), h",     4, (rotate<Rotation::RL, Operand8::IX_D, Operand8::H>()))   \
+    OPCODE(0x515, "rl (ix+d), l",     4, (rotate<Rotation::RL, Operand8::IX_D, Operand8::L>()))   \
+    OPCODE(0x516, "rl (ix+d)",        4, (rotate<Rotation::RL, Operand8::IX_D>()))                \
+    OPCODE(0x517, "rl (ix+d), a",     4, (rotate<Rotation::RL, Operand8::IX_D, Operand8::A>()))   \
+    OPCODE(0x518, "rr (ix+d), b",     4, (rotate<Rotation::RR, Operand8::IX_D, Operand8::B>()))   \
+    OPCODE(0x519, "rr (ix+d), c",     4, (rotate<Rotation::RR, Operand8::IX_D, Operand8::C>()))   \
+    OPCODE(0x51A, "rr (ix+d), d",     4, (rotate<Rotation::RR, Operand8::IX_D, Operand8::D>()))   \
+    OPCODE(0x51B, "rr (ix+d), e",     4, (rotate<Rotation::RR, Operand8::IX_D, Operand8::E>()))   \
+    OPCODE(0x51C, "rr (ix+d), h",     4, (rotate<Rotation::RR, Operand8::IX_D, Operand8::H>()))   \
+    OPCODE(0x51D, "rr (ix+d), l",     4, (rotate<Rotation::RR, Operand8::IX_D, Operand8::L>()))   \
+    OPCODE(0x51E, "rr (ix+d)",        4, (rotate<Rotation::RR, Operand8::IX_D>()))                \
+    OPCODE(0x51F, "rr (ix+d), a",     4, (rotate<Rotation::RR, Operand8::IX_D, Operand8::A>()))   \
+    OPCODE(0x520, "sla (ix+d), b",    4, (rotate<Rotation::SLA, Operand8::IX_D, Operand8::B>()))  \
+    OPCODE(0x521, "sla (ix+d), c",    4, (rotate<Rotation::SLA, Operand8::IX_D, Operand8::C>()))  \
+    OPCODE(0x522, "sla (ix+d), d",    4, (rotate<Rotation::SLA, Operand8::IX_D, Operand8::D>()))  \
+    OPCODE(0x523, "sla (ix+d), e",    4, (rotate<Rotation::SLA, Operand8::IX_D, Operand8::E>()))  \
+    OPCODE(0x524, "sla (ix+d), h",    4, (rotate<Rotation::SLA, Operand8::IX_D, Operand8::H>()))  \
+    OPCODE(0x525, "sla (ix+d), l",    4, (rotate<Rotation::SLA, Operand8::IX_D, Operand8::L>()))  \
+    OPCODE(0x526, "sla (ix+d)",       4, (rotate<Rotation::SLA, Operand8::IX_D>()))               \
+    OPCODE(0x527, "sla (ix+d), a",    4, (rotate<Rotation::SLA, Operand8::IX_D, Operand8::A>()))  \
+    OPCODE(0x528, "sra (ix+d), b",    4, (rotate<Rotation::SRA, Operand8::IX_D, Operand8::B>()))  \
+    OPCODE(0x529, "sra (ix+d), c",    4, (rotate<Rotation::SRA, Operand8::IX_D, Operand8::C>()))  \
+    OPCODE(0x52A, "sra (ix+d), d",    4, (rotate<Rotation::SRA, Operand8::IX_D, Operand8::D>()))  \
+    OPCODE(0x52B, "sra (ix+d), e",    4, (rotate<Rotation::SRA, Operand8::IX_D, Operand8::E>()))  \
+    OPCODE(0x52C, "sra (ix+d), h",    4, (rotate<Rotation::SRA, Operand8::IX_D, Operand8::H>()))  \
+    OPCODE(0x52D, "sra (ix+d), l",    4, (rotate<Rotation::SRA, Operand8::IX_D, Operand8::L>()))  \
+    OPCODE(0x52E, "sra (ix+d)",       4, (rotate<Rotation::SRA, Operand8::IX_D>()))               \
+    OPCODE(0x52F, "sra (ix+d), a",    4, (rotate<Rotation::SRA, Operand8::IX_D, Operand8::A>()))  \
+    OPCODE(0x530, "sll (ix+d), b",    4, (rotate<Rotation::SLL, Operand8::IX_D, Operand8::B>()))  \
+    OPCODE(0x531, "sll (ix+d), c",    4, (rotate<Rotation::SLL, Operand8::IX_D, Operand8::C>()))  \
+    OPCODE(0x532, "sll (ix+d), d",    4, (rotate<Rotation::SLL, Operand8::IX_D, Operand8::D>()))  \
+    OPCODE(0x533, "sll (ix+d), e",    4, (rotate<Rotation::SLL, Operand8::IX_D, Operand8::E>()))  \
+    OPCODE(0x534, "sll (ix+d), h",    4, (rotate<Rotation::SLL, Operand8::IX_D, Operand8::H>()))  \
+    OPCODE(0x535, "sll (ix+d), l",    4, (rotate<Rotation::SLL, Operand8::IX_D, Operand8::L>()))  \
+    OPCODE(0x536, "sll (ix+d)",       4, (rotate<Rotation::SLL, Operand8::IX_D>()))               \
+    OPCODE(0x537, "sll (ix+d), a",    4, (rotate<Rotation::SLL, Operand8::IX_D, Operand8::A>()))  \
+    OPCODE(0x538, "srl (ix+d), b",    4, (rotate<Rotation::SRL, Operand8::IX_D, Operand8::B>()))  \
+    OPCODE(0x539, "srl (ix+d), c",    4, (rotate<Rotation::SRL, Operand8::IX_D, Operand8::C>()))  \
+    OPCODE(0x53A, "srl (ix+d), d",    4, (rotate<Rotation::SRL, Operand8::IX_D, Operand8::D>()))  \
+    OPCODE(0x53B, "srl (ix+d), e",    4, (rotate<Rotation::SRL, Operand8::IX_D, Operand8::E>()))  \
+    OPCODE(0x53C, "srl (ix+d), h",    4, (rotate<Rotation::SRL, Operand8::IX_D, Operand8::H>()))  \
+    OPCODE(0x53D, "srl (ix+d), l",    4, (rotate<Rotation::SRL, Operand8::IX_D, Operand8::L>()))  \
+    OPCODE(0x53E, "srl (ix+d)",       4, (rotate<Rotation::SRL, Operand8::IX_D>()))               \
+    OPCODE(0x53F, "srl (ix+d), a",    4, (rotate<Rotation::SRL, Operand8::IX_D, Operand8::A>()))  \
+    OPCODE(0x540, "bit 0, (ix+d)",    4, (test_bit<0, Operand8::IX_D>()))                         \
+    OPCODE(0x541, "bit 0, (ix+d)",    4, (test_bit<0, Operand8::IX_D>()))                         \
+    OPCODE(0x542, "bit 0, (ix+d)",    4, (test_bit<0, Operand8::IX_D>()))                         \
+    OPCODE(0x543, "bit 0, (ix+d)",    4, (test_bit<0, Operand8::IX_D>()))                         \
+    OPCODE(0x544, "bit 0, (ix+d)",    4, (test_bit<0, Operand8::IX_D>()))                         \
+    OPCODE(0x545, "bit 0, (ix+d)",    4, (test_bit<0, Operand8::IX_D>()))                         \
+    OPCODE(0x546, "bit 0, (ix+d)",    4, (test_bit<0, Operand8::IX_D>()))                         \
+    OPCODE(0x547, "bit 0, (ix+d)",    4, (test_bit<0, Operand8::IX_D>()))                         \
+    OPCODE(0x548, "bit 1, (ix+d)",    4, (test_bit<1, Operand8::IX_D>()))                         \
+    OPCODE(0x549, "bit 1, (ix+d)",    4, (test_bit<1, Operand8::IX_D>()))                         \
+    OPCODE(0x54A, "bit 1, (ix+d)",    4, (test_bit<1, Operand8::IX_D>()))                         \
+    OPCODE(0x54B, "bit 1, (ix+d)",    4, (test_bit<1, Operand8::IX_D>()))                         \
+    OPCODE(0x54C, "bit 1, (ix+d)",    4, (test_bit<1, Operand8::IX_D>()))                         \
+    OPCODE(0x54D, "bit 1, (ix+d)",    4, (test_bit<1, Operand8::IX_D>()))                         \
+    OPCODE(0x54E, "bit 1, (ix+d)",    4, (test_bit<1, Operand8::IX_D>()))                         \
+    OPCODE(0x54F, "bit 1, (ix+d)",    4, (test_bit<1, Operand8::IX_D>()))                         \
+    OPCODE(0x550, "bit 2, (ix+d)",    4, (test_bit<2, Operand8::IX_D>()))                         \
+    OPCODE(0x551, "bit 2, (ix+d)",    4, (test_bit<2, Operand8::IX_D>()))                         \
+    OPCODE(0x552, "bit 2, (ix+d)",    4, (test_bit<2, Operand8::IX_D>()))                         \
+    OPCODE(0x553, "bit 2, (ix+d)",    4, (test_bit<2, Operand8::IX_D>()))                         \
+    OPCODE(0x554, "bit 2, (ix+d)",    4, (test_bit<2, Operand8::IX_D>()))                         \
+    OPCODE(0x555, "bit 2, (ix+d)",    4, (test_bit<2, Operand8::IX_D>()))                         \
+    OPCODE(0x556, "bit 2, (ix+d)",    4, (test_bit<2, Operand8::IX_D>()))                         \
+    OPCODE(0x557, "bit 2, (ix+d)",    4, (test_bit<2, Operand8::IX_D>()))                         \
+    OPCODE(0x558, "bit 3, (ix+d)",    4, (test_bit<3, Operand8::IX_D>()))                         \
+    OPCODE(0x559, "bit 3, (ix+d)",    4, (test_bit<3, Operand8::IX_D>()))                         \
+    OPCODE(0x55A, "bit 3, (ix+d)",    4, (test_bit<3, Operand8::IX_D>()))                         \
+    OPCODE(0x55B, "bit 3, (ix+d)",    4, (test_bit<3, Operand8::IX_D>()))                         \
+    OPCODE(0x55C, "bit 3, (ix+d)",    4, (test_bit<3, Operand8::IX_D>()))                         \
+    OPCODE(0x55D, "bit 3, (ix+d)",    4, (test_bit<3, Operand8::IX_D>()))                         \
+    OPCODE(0x55E, "bit 3, (ix+d)",    4, (test_bit<3, Operand8::IX_D>()))                         \
+    OPCODE(0x55F, "bit 3, (ix+d)",    4, (test_bit<3, Operand8::IX_D>()))                         \
+    OPCODE(0x560, "bit 4, (ix+d)",    4, (test_bit<4, Operand8::IX_D>()))                         \
+    OPCODE(0x561, "bit 4, (ix+d)",    4, (test_bit<4, Operand8::IX_D>()))                         \
+    OPCODE(0x562, "bit 4, (ix+d)",    4, (test_bit<4, Operand8::IX_D>()))                         \
+    OPCODE(0x563, "bit 4, (ix+d)",    4, (test_bit<4, Operand8::IX_D>()))                         \
+    OPCODE(0x564, "bit 4, (ix+d)",    4, (test_bit<4, Operand8::IX_D>()))                         \
+    OPCODE(0x565, "bit 4, (ix+d)",    4, (test_bit<4, Operand8::IX_D>()))                         \
+    OPCODE(0x566, "bit 4, (ix+d)",    4, (test_bit<4, Operand8::IX_D>()))                         \
+    OPCODE(0x567, "bit 4, (ix+d)",    4, (test_bit<4, Operand8::IX_D>()))                         \
+    OPCODE(0x568, "bit 5, (ix+d)",    4, (test_bit<5, Operand8::IX_D>()))                         \
+    OPCODE(0x569, "bit 5, (ix+d)",    4, (test_bit<5, Operand8::IX_D>()))                         \
+    OPCODE(0x56A, "bit 5, (ix+d)",    4, (test_bit<5, Operand8::IX_D>()))                         \
+    OPCODE(0x56B, "bit 5, (ix+d)",    4, (test_bit<5, Operand8::IX_D>()))                         \
+    OPCODE(0x56C, "bit 5, (ix+d)",    4, (test_bit<5, Operand8::IX_D>()))                         \
+    OPCODE(0x56D, "bit 5, (ix+d)",    4, (test_bit<5, Operand8::IX_D>()))                         \
+    OPCODE(0x56E, "bit 5, (ix+d)",    4, (test_bit<5, Operand8::IX_D>()))                         \
+    OPCODE(0x56F, "bit 5, (ix+d)",    4, (test_bit<5, Operand8::IX_D>()))                         \
+    OPCODE(0x570, "bit 6, (ix+d)",    4, (test_bit<6, Operand8::IX_D>()))                         \
+    OPCODE(0x571, "bit 6, (ix+d)",    4, (test_bit<6, Operand8::IX_D>()))                         \
+    OPCODE(0x572, "bit 6, (ix+d)",    4, (test_bit<6, Operand8::IX_D>()))                         \
+    OPCODE(0x573, "bit 6, (ix+d)",    4, (test_bit<6, Operand8::IX_D>()))                         \
+    OPCODE(0x574, "bit 6, (ix+d)",    4, (test_bit<6, Operand8::IX_D>()))                         \
+    OPCODE(0x575, "bit 6, (ix+d)",    4, (test_bit<6, Operand8::IX_D>()))                         \
+    OPCODE(0x576, "bit 6, (ix+d)",    4, (test_bit<6, Operand8::IX_D>()))                         \
+    OPCODE(0x577, "bit 6, (ix+d)",    4, (test_bit<6, Operand8::IX_D>()))                         \
+    OPCODE(0x578, "bit 7, (ix+d)",    4, (test_bit<7, Operand8::IX_D>()))                         \
+    OPCODE(0x579, "bit 7, (ix+d)",    4, (test_bit<7, Operand8::IX_D>()))                         \
+    OPCODE(0x57A, "bit 7, (ix+d)",    4, (test_bit<7, Operand8::IX_D>()))                         \
+    OPCODE(0x57B, "bit 7, (ix+d)",    4, (test_bit<7, Operand8::IX_D>()))                         \
+    OPCODE(0x57C, "bit 7, (ix+d)",    4, (test_bit<7, Operand8::IX_D>()))                         \
+    OPCODE(0x57D, "bit 7, (ix+d)",    4, (test_bit<7, Operand8::IX_D>()))                         \
+    OPCODE(0x57E, "bit 7, (ix+d)",    4, (test_bit<7, Operand8::IX_D>()))                         \
+    OPCODE(0x57F, "bit 7, (ix+d)",    4, (test_bit<7, Operand8::IX_D>()))                         \
+    OPCODE(0x580, "res 0, (ix+d), b", 4, (change_bit<0, false, Operand8::IX_D, Operand8::B>()))   \
+    OPCODE(0x581, "res 0, (ix+d), c", 4, (change_bit<0, false, Operand8::IX_D, Operand8::C>()))   \
+    OPCODE(0x582, "res 0, (ix+d), d", 4, (change_bit<0, false, Operand8::IX_D, Operand8::D>()))   \
+    OPCODE(0x583, "res 0, (ix+d), e", 4, (change_bit<0, false, Operand8::IX_D, Operand8::E>()))   \
+    OPCODE(0x584, "res 0, (ix+d), h", 4, (change_bit<0, false, Operand8::IX_D, Operand8::H>()))   \
+    OPCODE(0x585, "res 0, (ix+d), l", 4, (change_bit<0, false, Operand8::IX_D, Operand8::L>()))   \
+    OPCODE(0x586, "res 0, (ix+d)",    4, (change_bit<0, false, Operand8::IX_D>()))                \
+    OPCODE(0x587, "res 0, (ix+d), a", 4, (change_bit<0, false, Operand8::IX_D, Operand8::A>()))   \
+    OPCODE(0x588, "res 1, (ix+d), b", 4, (change_bit<1, false, Operand8::IX_D, Operand8::B>()))   \
+    OPCODE(0x589, "res 1, (ix+d), c", 4, (change_bit<1, false, Operand8::IX_D, Operand8::C>()))   \
+    OPCODE(0x58A, "res 1, (ix+d), d", 4, (change_bit<1, false, Operand8::IX_D, Operand8::D>()))   \
+    OPCODE(0x58B, "res 1, (ix+d), e", 4, (change_bit<1, false, Operand8::IX_D, Operand8::E>()))   \
+    OPCODE(0x58C, "res 1, (ix+d), h", 4, (change_bit<1, false, Operand8::IX_D, Operand8::H>()))   \
+    OPCODE(0x58D, "res 1, (ix+d), l", 4, (change_bit<1, false, Operand8::IX_D, Operand8::L>()))   \
+    OPCODE(0x58E, "res 1, (ix+d)",    4, (change_bit<1, false, Operand8::IX_D>()))                \
+    OPCODE(0x58F, "res 1, (ix+d), a", 4, (change_bit<1, false, Operand8::IX_D, Operand8::A>()))   \
+    OPCODE(0x590, "res 2, (ix+d), b", 4, (change_bit<2, false, Operand8::IX_D, Operand8::B>()))   \
+    OPCODE(0x591, "res 2, (ix+d), c", 4, (change_bit<2, false, Operand8::IX_D, Operand8::C>()))   \
+    OPCODE(0x592, "res 2, (ix+d), d", 4, (change_bit<2, false, Operand8::IX_D, Operand8::D>()))   \
+    OPCODE(0x593, "res 2, (ix+d), e", 4, (change_bit<2, false, Operand8::IX_D, Operand8::E>()))   \
+    OPCODE(0x594, "res 2, (ix+d), h", 4, (change_bit<2, false, Operand8::IX_D, Operand8::H>()))   \
+    OPCODE(0x595, "res 2, (ix+d), l", 4, (change_bit<2, false, Operand8::IX_D, Operand8::L>()))   \
+    OPCODE(0x596, "res 2, (ix+d)",    4, (change_bit<2, false, Operand8::IX_D>()))                \
+    OPCODE(0x597, "res 2, (ix+d), a", 4, (change_bit<2, false, Operand8::IX_D, Operand8::A>()))   \
+    OPCODE(0x598, "res 3, (ix+d), b", 4, (change_bit<3, false, Operand8::IX_D, Operand8::B>()))   \
+    OPCODE(0x599, "res 3, (ix+d), c", 4, (change_bit<3, false, Operand8::IX_D, Operand8::C>()))   \
+    OPCODE(0x59A, "res 3, (ix+d), d", 4, (change_bit<3, false, Operand8::IX_D, Operand8::D>()))   \
+    OPCODE(0x59B, "res 3, (ix+d), e", 4, (change_bit<3, false, Operand8::IX_D, Operand8::E>()))   \
+    OPCODE(0x59C, "res 3, (ix+d), h", 4, (change_bit<3, false, Operand8::IX_D, Operand8::H>()))   \
+    OPCODE(0x59D, "res 3, (ix+d), l", 4, (change_bit<3, false, Operand8::IX_D, Operand8::L>()))   \
+    OPCODE(0x59E, "res 3, (ix+d)",    4, (change_bit<3, false, Operand8::IX_D>()))                \
+    OPCODE(0x59F, "res 3, (ix+d), a", 4, (change_bit<3, false, Operand8::IX_D, Operand8::A>()))   \
+    OPCODE(0x5A0, "res 4, (ix+d), b", 4, (change_bit<4, false, Operand8::IX_D, Operand8::B>()))   \
+    OPCODE(0x5A1, "res 4, (ix+d), c", 4, (change_bit<4, false, Operand8::IX_D, Operand8::C>()))   \
+    OPCODE(0x5A2, "res 4, (ix+d), d", 4, (change_bit<4, false, Operand8::IX_D, Operand8::D>()))   \
+    OPCODE(0x5A3, "res 4, (ix+d), e", 4, (change_bit<4, false, Operand8::IX_D, Operand8::E>()))   \
+    OPCODE(0x5A4, "res 4, (ix+d), h", 4, (change_bit<4, false, Operand8::IX_D, Operand8::H>()))   \
+    OPCODE(0x5A5, "res 4, (ix+d), l", 4, (change_bit<4, false, Operand8::IX_D, Operand8::L>()))   \
+    OPCODE(0x5A6, "res 4, (ix+d)",    4, (change_bit<4, false, Operand8::IX_D>()))                \
+    OPCODE(0x5A7, "res 4, (ix+d), a", 4, (change_bit<4, false, Operand8::IX_D, Operand8::A>()))   \
+    OPCODE(0x5A8, "res 5, (ix+d), b", 4, (change_bit<5, false, Operand8::IX_D, Operand8::B>()))   \
+    OPCODE(0x5A9, "res 5, (ix+d), c", 4, (change_bit<5, false, Operand8::IX_D, Operand8::C>()))   \
+    OPCODE(0x5AA, "res 5, (ix+d), d", 4, (change_bit<5, false, Operand8::IX_D, Operand8::D>()))   \
+    OPCODE(0x5AB, "res 5, (ix+d), e", 4, (change_bit<5, false, Operand8::IX_D, Operand8::E>()))   \
+    OPCODE(0x5AC, "res 5, (ix+d), h", 4, (change_bit<5, false, Operand8::IX_D, Operand8::H>()))   \
+    OPCODE(0x5AD, "res 5, (ix+d), l", 4, (change_bit<5, false, Operand8::IX_D, Operand8::L>()))   \
+    OPCODE(0x5AE, "res 5, (ix+d)",    4, (change_bit<5, false, Operand8::IX_D>()))                \
+    OPCODE(0x5AF, "res 5, (ix+d), a", 4, (change_bit<5, false, Operand8::IX_D, Operand8::A>()))   \
+    OPCODE(0x5B0, "res 6, (ix+d), b", 4, (change_bit<6, false, Operand8::IX_D, Operand8::B>()))   \
+    OPCODE(0x5B1, "res 6, (ix+d), c", 4, (change_bit<6, false, Operand8::IX_D, Operand8::C>()))   \
+    OPCODE(0x5B2, "res 6, (ix+d), d", 4, (change_bit<6, false, Operand8::IX_D, Operand8::D>()))   \
+    OPCODE(0x5B3, "res 6, (ix+d), e", 4, (change_bit<6, false, Operand8::IX_D, Operand8::E>()))   \
+    OPCODE(0x5B4, "res 6, (ix+d), h", 4, (change_bit<6, false, Operand8::IX_D, Operand8::H>()))   \
+    OPCODE(0x5B5, "res 6, (ix+d), l", 4, (change_bit<6, false, Operand8::IX_D, Operand8::L>()))   \
+    OPCODE(0x5B6, "res 6, (ix+d)",    4, (change_bit<6, false, Operand8::IX_D>()))                \
+    OPCODE(0x5B7, "res 6, (ix+d), a", 4, (change_bit<6, false, Operand8::IX_D, Operand8::A>()))   \
+    OPCODE(0x5B8, "res 7, (ix+d), b", 4, (change_bit<7, false, Operand8::IX_D, Operand8::B>()))   \
+    OPCODE(0x5B9, "res 7, (ix+d), c", 4, (change_bit<7, false, Operand8::IX_D, Operand8::C>()))   \
+    OPCODE(0x5BA, "res 7, (ix+d), d", 4, (change_bit<7, false, Operand8::IX_D, Operand8::D>()))   \
+    OPCODE(0x5BB, "res 7, (ix+d), e", 4, (change_bit<7, false, Operand8::IX_D, Operand8::E>()))   \
+    OPCODE(0x5BC, "res 7, (ix+d), h", 4, (change_bit<7, false, Operand8::IX_D, Operand8::H>()))   \
+    OPCODE(0x5BD, "res 7, (ix+d), l", 4, (change_bit<7, false, Operand8::IX_D, Operand8::L>()))   \
+    OPCODE(0x5BE, "res 7, (ix+d)",    4, (change_bit<7, false, Operand8::IX_D>()))                \
+    OPCODE(0x5BF, "res 7, (ix+d), a", 4, (change_bit<7, false, Operand8::IX_D, Operand8::A>()))   \
+    OPCODE(0x5C0, "set 0, (ix+d), b", 4, (change_bit<0, true, Operand8::IX_D, Operand8::B>()))    \
+    OPCODE(0x5C1, "set 0, (ix+d), c", 4, (change_bit<0, true, Operand8::IX_D, Operand8::C>()))    \
+    OPCODE(0x5C2, "set 0, (ix+d), d", 4, (change_bit<0, true, Operand8::IX_D, Operand8::D>()))    \
+    OPCODE(0x5C3, "set 0, (ix+d), e", 4, (change_bit<0, true, Operand8::IX_D, Operand8::E>()))    \
+    OPCODE(0x5C4, "set 0, (ix+d), h", 4, (change_bit<0, true, Operand8::IX_D, Operand8::H>()))    \
+    OPCODE(0x5C5, "set 0, (ix+d), l", 4, (change_bit<0, true, Operand8::IX_D, Operand8::L>()))    \
+    OPCODE(0x5C6, "set 0, (ix+d)",    4, (change_bit<0, true, Operand8::IX_D>()))                 \
+    OPCODE(0x5C7, "set 0, (ix+d), a", 4, (change_bit<0, true, Operand8::IX_D, Operand8::A>()))    \
+    OPCODE(0x5C8, "set 1, (ix+d), b", 4, (change_bit<1, true, Operand8::IX_D, Operand8::B>()))    \
+    OPCODE(0x5C9, "set 1, (ix+d), c", 4, (change_bit<1, true, Operand8::IX_D, Operand8::C>()))    \
+    OPCODE(0x5CA, "set 1, (ix+d), d", 4, (change_bit<1, true, Operand8::IX_D, Operand8::D>()))    \
+    OPCODE(0x5CB, "set 1, (ix+d), e", 4, (change_bit<1, true, Operand8::IX_D, Operand8::E>()))    \
+    OPCODE(0x5CC, "set 1, (ix+d), h", 4, (change_bit<1, true, Operand8::IX_D, Operand8::H>()))    \
+    OPCODE(0x5CD, "set 1, (ix+d), l", 4, (change_bit<1, true, Operand8::IX_D, Operand8::L>()))    \
+    OPCODE(0x5CE, "set 1, (ix+d)",    4, (change_bit<1, true, Operand8::IX_D>()))                 \
+    OPCODE(0x5CF, "set 1, (ix+d), a", 4, (change_bit<1, true, Operand8::IX_D, Operand8::A>()))    \
+    OPCODE(0x5D0, "set 2, (ix+d), b", 4, (change_bit<2, true, Operand8::IX_D, Operand8::B>()))    \
+    OPCODE(0x5D1, "set 2, (ix+d), c", 4, (change_bit<2, true, Operand8::IX_D, Operand8::C>()))    \
+    OPCODE(0x5D2, "set 2, (ix+d), d", 4, (change_bit<2, true, Operand8::IX_D, Operand8::D>()))    \
+    OPCODE(0x5D3, "set 2, (ix+d), e", 4, (change_bit<2, true, Operand8::IX_D, Operand8::E>()))    \
+    OPCODE(0x5D4, "set 2, (ix+d), h", 4, (change_bit<2, true, Operand8::IX_D, Operand8::H>()))    \
+    OPCODE(0x5D5, "set 2, (ix+d), l", 4, (change_bit<2, true, Operand8::IX_D, Operand8::L>()))    \
+    OPCODE(0x5D6, "set 2, (ix+d)",    4, (change_bit<2, true, Operand8::IX_D>()))                 \
+    OPCODE(0x5D7, "set 2, (ix+d), a", 4, (change_bit<2, true, Operand8::IX_D, Operand8::A>()))    \
+    OPCODE(0x5D8, "set 3, (ix+d), b", 4, (change_bit<3, true, Operand8::IX_D, Operand8::B>()))    \
+    OPCODE(0x5D9, "set 3, (ix+d), c", 4, (change_bit<3, true, Operand8::IX_D, Operand8::C>()))    \
+    OPCODE(0x5DA, "set 3, (ix+d), d", 4, (change_bit<3, true, Operand8::IX_D, Operand8::D>()))    \
+    OPCODE(0x5DB, "set 3, (ix+d), e", 4, (change_bit<3, true, Operand8::IX_D, Operand8::E>()))    \
+    OPCODE(0x5DC, "set 3, (ix+d), h", 4, (change_bit<3, true, Operand8::IX_D, Operand8::H>()))    \
+    OPCODE(0x5DD, "set 3, (ix+d), l", 4, (change_bit<3, true, Operand8::IX_D, Operand8::L>()))    \
+    OPCODE(0x5DE, "set 3, (ix+d)",    4, (change_bit<3, true, Operand8::IX_D>()))                 \
+    OPCODE(0x5DF, "set 3, (ix+d), a", 4, (change_bit<3, true, Operand8::IX_D, Operand8::A>()))    \
+    OPCODE(0x5E0, "set 4, (ix+d), b", 4, (change_bit<4, true, Operand8::IX_D, Operand8::B>()))    \
+    OPCODE(0x5E1, "set 4, (ix+d), c", 4, (change_bit<4, true, Operand8::IX_D, Operand8::C>()))    \
+    OPCODE(0x5E2, "set 4, (ix+d), d", 4, (change_bit<4, true, Operand8::IX_D, Operand8::D>()))    \
+    OPCODE(0x5E3, "set 4, (ix+d), e", 4, (change_bit<4, true, Operand8::IX_D, Operand8::E>()))    \
+    OPCODE(0x5E4, "set 4, (ix+d), h", 4, (change_bit<4, true, Operand8::IX_D, Operand8::H>()))    \
+    OPCODE(0x5E5, "set 4, (ix+d), l", 4, (change_bit<4, true, Operand8::IX_D, Operand8::L>()))    \
+    OPCODE(0x5E6, "set 4, (ix+d)",    4, (change_bit<4, true, Operand8::IX_D>()))                 \
+    OPCODE(0x5E7, "set 4, (ix+d), a", 4, (change_bit<4, true, Operand8::IX_D, Operand8::A>()))    \
+    OPCODE(0x5E8, "set 5, (ix+d), b", 4, (change_bit<5, true, Operand8::IX_D, Operand8::B>()))    \
+    OPCODE(0x5E9, "set 5, (ix+d), c", 4, (change_bit<5, true, Operand8::IX_D, Operand8::C>()))    \
+    OPCODE(0x5EA, "set 5, (ix+d), d", 4, (change_bit<5, true, Operand8::IX_D, Operand8::D>()))    \
+    OPCODE(0x5EB, "set 5, (ix+d), e", 4, (change_bit<5, true, Operand8::IX_D, Operand8::E>()))    \
+    OPCODE(0x5EC, "set 5, (ix+d), h", 4, (change_bit<5, true, Operand8::IX_D, Operand8::H>()))    \
+    OPCODE(0x5ED, "set 5, (ix+d), l", 4, (change_bit<5, true, Operand8::IX_D, Operand8::L>()))    \
+    OPCODE(0x5EE, "set 5, (ix+d)",    4, (change_bit<5, true, Operand8::IX_D>()))                 \
+    OPCODE(0x5EF, "set 5, (ix+d), a", 4, (change_bit<5, true, Operand8::IX_D, Operand8::A>()))    \
+    OPCODE(0x5F0, "set 6, (ix+d), b", 4, (change_bit<6, true, Operand8::IX_D, Operand8::B>()))    \
+    OPCODE(0x5F1, "set 6, (ix+d), c", 4, (change_bit<6, true, Operand8::IX_D, Operand8::C>()))    \
+    OPCODE(0x5F2, "set 6, (ix+d), d", 4, (change_bit<6, true, Operand8::IX_D, Operand8::D>()))    \
+    OPCODE(0x5F3, "set 6, (ix+d), e", 4, (change_bit<6, true, Operand8::IX_D, Operand8::E>()))    \
+    OPCODE(0x5F4, "set 6, (ix+d), h", 4, (change_bit<6, true, Operand8::IX_D, Operand8::H>()))    \
+    OPCODE(0x5F5, "set 6, (ix+d), l", 4, (change_bit<6, true, Operand8::IX_D, Operand8::L>()))    \
+    OPCODE(0x5F6, "set 6, (ix+d)",    4, (change_bit<6, true, Operand8::IX_D>()))                 \
+    OPCODE(0x5F7, "set 6, (ix+d), a", 4, (change_bit<6, true, Operand8::IX_D, Operand8::A>()))    \
+    OPCODE(0x5F8, "set 7, (ix+d), b", 4, (change_bit<7, true, Operand8::IX_D, Operand8::B>()))    \
+    OPCODE(0x5F9, "set 7, (ix+d), c", 4, (change_bit<7, true, Operand8::IX_D, Operand8::C>()))    \
+    OPCODE(0x5FA, "set 7, (ix+d), d", 4, (change_bit<7, true, Operand8::IX_D, Operand8::D>()))    \
+    OPCODE(0x5FB, "set 7, (ix+d), e", 4, (change_bit<7, true, Operand8::IX_D, Operand8::E>()))    \
+    OPCODE(0x5FC, "set 7, (ix+d), h", 4, (change_bit<7, true, Operand8::IX_D, Operand8::H>()))    \
+    OPCODE(0x5FD, "set 7, (ix+d), l", 4, (change_bit<7, true, Operand8::IX_D, Operand8::L>()))    \
+    OPCODE(0x5FE, "set 7, (ix+d)",    4, (change_bit<7, true, Operand8::IX_D>()))                 \
+    OPCODE(0x5FF, "set 7, (ix+d), a", 4, (change_bit<7, true, Operand8::IX_D, Operand8::A>()))    \
+    OPCODE(0x600, "rlc (iy+d), b",    4, (rotate<Rotation::RLC, Operand8::IY_D, Operand8::B>()))  \
+    OPCODE(0x601, "rlc (iy+d), c",    4, (rotate<Rotation::RLC, Operand8::IY_D, Operand8::C>()))  \
+    OPCODE(0x602, "rlc (iy+d), d",    4, (rotate<Rotation::RLC, Operand8::IY_D, Operand8::D>()))  \
+    OPCODE(0x603, "rlc (iy+d), e",    4, (rotate<Rotation::RLC, Operand8::IY_D, Operand8::E>()))  \
+    OPCODE(0x604, "rlc (iy+d), h",    4, (rotate<Rotation::RLC, Operand8::IY_D, Operand8::H>()))  \
+    OPCODE(0x605, "rlc (iy+d), l",    4, (rotate<Rotation::RLC, Operand8::IY_D, Operand8::L>()))  \
+    OPCODE(0x606, "rlc (iy+d)",       4, (rotate<Rotation::RLC, Operand8::IY_D>()))               \
+    OPCODE(0x607, "rlc (iy+d), a",    4, (rotate<Rotation::RLC, Operand8::IY_D, Operand8::A>()))  \
+    OPCODE(0x608, "rrc (iy+d), b",    4, (rotate<Rotation::RRC, Operand8::IY_D, Operand8::B>()))  \
+    OPCODE(0x609, "rrc (iy+d), c",    4, (rotate<Rotation::RRC, Operand8::IY_D, Operand8::C>()))  \
+    OPCODE(0x60A, "rrc (iy+d), d",    4, (rotate<Rotation::RRC, Operand8::IY_D, Operand8::D>()))  \
+    OPCODE(0x60B, "rrc (iy+d), e",    4, (rotate<Rotation::RRC, Operand8::IY_D, Operand8::E>()))  \
+    OPCODE(0x60C, "rrc (iy+d), h",    4, (rotate<Rotation::RRC, Operand8::IY_D, Operand8::H>()))  \
+    OPCODE(0x60D, "rrc (iy+d), l",    4, (rotate<Rotation::RRC, Operand8::IY_D, Operand8::L>()))  \
+    OPCODE(0x60E, "rrc (iy+d)",       4, (rotate<Rotation::RRC, Operand8::IY_D>()))               \
+    OPCODE(0x60F, "rrc (iy+d), a",    4, (rotate<Rotation::RRC, Operand8::IY_D, Operand8::A>()))  \
+    OPCODE(0x610, "rl (iy+d), b",     4, (rotate<Rotation::RL, Operand8::IY_D, Operand8::B>()))   \
+    OPCODE(0x611, "rl (iy+d), c",     4, (rotate<Rotation::RL, Operand8::IY_D, Operand8::C>()))   \
+    OPCODE(0x612, "rl (iy+d), d",     4, (rotate<Rotation::RL, Operand8::IY_D, Operand8::D>()))   \
+    OPCODE(0x613, "rl (iy+d), e",     4, (rotate<Rotation::RL, Operand8::IY_D, Operand8::E>()))   \
+    OPCODE(0x614, "rl (iy+d), h",     4, (rotate<Rotation::RL, Operand8::IY_D, Operand8::H>()))   \
+    OPCODE(0x615, "rl (iy+d), l",     4, (rotate<Rotation::RL, Operand8::IY_D, Operand8::L>()))   \
+    OPCODE(0x616, "rl (iy+d)",        4, (rotate<Rotation::RL, Operand8::IY_D>()))                \
+    OPCODE(0x617, "rl (iy+d), a",     4, (rotate<Rotation::RL, Operand8::IY_D, Operand8::A>()))   \
+    OPCODE(0x618, "rr (iy+d), b",     4, (rotate<Rotation::RR, Operand8::IY_D, Operand8::B>()))   \
+    OPCODE(0x619, "rr (iy+d), c",     4, (rotate<Rotation::RR, Operand8::IY_D, Operand8::C>()))   \
+    OPCODE(0x61A, "rr (iy+d), d",     4, (rotate<Rotation::RR, Operand8::IY_D, Operand8::D>()))   \
+    OPCODE(0x61B, "rr (iy+d), e",     4, (rotate<Rotation::RR, Operand8::IY_D, Operand8::E>()))   \
+    OPCODE(0x61C, "rr (iy+d), h",     4, (rotate<Rotation::RR, Operand8::IY_D, Operand8::H>()))   \
+    OPCODE(0x61D, "rr (iy+d), l",     4, (rotate<Rotation::RR, Operand8::IY_D, Operand8::L>()))   \
+    OPCODE(0x61E, "rr (iy+d)",        4, (rotate<Rotation::RR, Operand8::IY_D>()))                \
+    OPCODE(0x61F, "rr (iy+d), a",     4, (rotate<Rotation::RR, Operand8::IY_D, Operand8::A>()))   \
+    OPCODE(0x620, "sla (iy+d), b",    4, (rotate<Rotation::SLA, Operand8::IY_D, Operand8::B>()))  \
+    OPCODE(0x621, "sla (iy+d), c",    4, (rotate<Rotation::SLA, Operand8::IY_D, Operand8::C>()))  \
+    OPCODE(0x622, "sla (iy+d), d",    4, (rotate<Rotation::SLA, Operand8::IY_D, Operand8::D>()))  \
+    OPCODE(0x623, "sla (iy+d), e",    4, (rotate<Rotation::SLA, Operand8::IY_D, Operand8::E>()))  \
+    OPCODE(0x624, "sla (iy+d), h",    4, (rotate<Rotation::SLA, Operand8::IY_D, Operand8::H>()))  \
+    OPCODE(0x625, "sla (iy+d), l",    4, (rotate<Rotation::SLA, Operand8::IY_D, Operand8::L>()))  \
+    OPCODE(0x626, "sla (iy+d)",       4, (rotate<Rotation::SLA, Operand8::IY_D>()))               \
+    OPCODE(0x627, "sla (iy+d), a",    4, (rotate<Rotation::SLA, Operand8::IY_D, Operand8::A>()))  \
+    OPCODE(0x628, "sra (iy+d), b",    4, (rotate<Rotation::SRA, Operand8::IY_D, Operand8::B>()))  \
+    OPCODE(0x629, "sra (iy+d), c",    4, (rotate<Rotation::SRA, Operand8::IY_D, Operand8::C>()))  \
+    OPCODE(0x62A, "sra (iy+d), d",    4, (rotate<Rotation::SRA, Operand8::IY_D, Operand8::D>()))  \
+    OPCODE(0x62B, "sra (iy+d), e",    4, (rotate<Rotation::SRA, Operand8::IY_D, Operand8::E>()))  \
+    OPCODE(0x62C, "sra (iy+d), h",    4, (rotate<Rotation::SRA, Operand8::IY_D, Operand8::H>()))  \
+    OPCODE(0x62D, "sra (iy+d), l",    4, (rotate<Rotation::SRA, Operand8::IY_D, Operand8::L>()))  \
+    OPCODE(0x62E, "sra (iy+d)",       4, (rotate<Rotation::SRA, Operand8::IY_D>()))               \
+    OPCODE(0x62F, "sra (iy+d), a",    4, (rotate<Rotation::SRA, Operand8::IY_D, Operand8::A>()))  \
+    OPCODE(0x630, "sll (iy+d), b",    4, (rotate<Rotation::SLL, Operand8::IY_D, Operand8::B>()))  \
+    OPCODE(0x631, "sll (iy+d), c",    4, (rotate<Rotation::SLL, Operand8::IY_D, Operand8::C>()))  \
+    OPCODE(0x632, "sll (iy+d), d",    4, (rotate<Rotation::SLL, Operand8::IY_D, Operand8::D>()))  \
+    OPCODE(0x633, "sll (iy+d), e",    4, (rotate<Rotation::SLL, Operand8::IY_D, Operand8::E>()))  \
+    OPCODE(0x634, "sll (iy+d), h",    4, (rotate<Rotation::SLL, Operand8::IY_D, Operand8::H>()))  \
+    OPCODE(0x635, "sll (iy+d), l",    4, (rotate<Rotation::SLL, Operand8::IY_D, Operand8::L>()))  \
+    OPCODE(0x636, "sll (iy+d)",       4, (rotate<Rotation::SLL, Operand8::IY_D>()))               \
+    OPCODE(0x637, "sll (iy+d), a",    4, (rotate<Rotation::SLL, Operand8::IY_D, Operand8::A>()))  \
+    OPCODE(0x638, "srl (iy+d), b",    4, (rotate<Rotation::SRL, Operand8::IY_D, Operand8::B>()))  \
+    OPCODE(0x639, "srl (iy+d), c",    4, (rotate<Rotation::SRL, Operand8::IY_D, Operand8::C>()))  \
+    OPCODE(0x63A, "srl (iy+d), d",    4, (rotate<Rotation::SRL, Operand8::IY_D, Operand8::D>()))  \
+    OPCODE(0x63B, "srl (iy+d), e",    4, (rotate<Rotation::SRL, Operand8::IY_D, Operand8::E>()))  \
+    OPCODE(0x63C, "srl (iy+d), h",    4, (rotate<Rotation::SRL, Operand8::IY_D, Operand8::H>()))  \
+    OPCODE(0x63D, "srl (iy+d), l",    4, (rotate<Rotation::SRL, Operand8::IY_D, Operand8::L>()))  \
+    OPCODE(0x63E, "srl (iy+d)",       4, (rotate<Rotation::SRL, Operand8::IY_D>()))               \
+    OPCODE(0x63F, "srl (iy+d), a",    4, (rotate<Rotation::SRL, Operand8::IY_D, Operand8::A>()))  \
+    OPCODE(0x640, "bit 0, (iy+d)",    4, (test_bit<0, Operand8::IY_D>()))                         \
+    OPCODE(0x641, "bit 0, (iy+d)",    4, (test_bit<0, Operand8::IY_D>()))                         \
+    OPCODE(0x642, "bit 0, (iy+d)",    4, (test_bit<0, Operand8::IY_D>()))                         \
+    OPCODE(0x643, "bit 0, (iy+d)",    4, (test_bit<0, Operand8::IY_D>()))                         \
+    OPCODE(0x644, "bit 0, (iy+d)",    4, (test_bit<0, Operand8::IY_D>()))                         \
+    OPCODE(0x645, "bit 0, (iy+d)",    4, (test_bit<0, Operand8::IY_D>()))                         \
+    OPCODE(0x646, "bit 0, (iy+d)",    4, (test_bit<0, Operand8::IY_D>()))                         \
+    OPCODE(0x647, "bit 0, (iy+d)",    4, (test_bit<0, Operand8::IY_D>()))                         \
+    OPCODE(0x648, "bit 1, (iy+d)",    4, (test_bit<1, Operand8::IY_D>()))                         \
+    OPCODE(0x649, "bit 1, (iy+d)",    4, (test_bit<1, Operand8::IY_D>()))                         \
+    OPCODE(0x64A, "bit 1, (iy+d)",    4, (test_bit<1, Operand8::IY_D>()))                         \
+    OPCODE(0x64B, "bit 1, (iy+d)",    4, (test_bit<1, Operand8::IY_D>()))                         \
+    OPCODE(0x64C, "bit 1, (iy+d)",    4, (test_bit<1, Operand8::IY_D>()))                         \
+    OPCODE(0x64D, "bit 1, (iy+d)",    4, (test_bit<1, Operand8::IY_D>()))                         \
+    OPCODE(0x64E, "bit 1, (iy+d)",    4, (test_bit<1, Operand8::IY_D>()))                         \
+    OPCODE(0x64F, "bit 1, (iy+d)",    4, (test_bit<1, Operand8::IY_D>()))                         \
+    OPCODE(0x650, "bit 2, (iy+d)",    4, (test_bit<2, Operand8::IY_D>()))                         \
+    OPCODE(0x651, "bit 2, (iy+d)",    4, (test_bit<2, Operand8::IY_D>()))                         \
+    OPCODE(0x652, "bit 2, (iy+d)",    4, (test_bit<2, Operand8::IY_D>()))                         \
+    OPCODE(0x653, "bit 2, (iy+d)",    4, (test_bit<2, Operand8::IY_D>()))                         \
+    OPCODE(0x654, "bit 2, (iy+d)",    4, (test_bit<2, Operand8::IY_D>()))                         \
+    OPCODE(0x655, "bit 2, (iy+d)",    4, (test_bit<2, Operand8::IY_D>()))                         \
+    OPCODE(0x656, "bit 2, (iy+d)",    4, (test_bit<2, Operand8::IY_D>()))                         \
+    OPCODE(0x657, "bit 2, (iy+d)",    4, (test_bit<2, Operand8::IY_D>()))                         \
+    OPCODE(0x658, "bit 3, (iy+d)",    4, (test_bit<3, Operand8::IY_D>()))                         \
+    OPCODE(0x659, "bit 3, (iy+d)",    4, (test_bit<3, Operand8::IY_D>()))                         \
+    OPCODE(0x65A, "bit 3, (iy+d)",    4, (test_bit<3, Operand8::IY_D>()))                         \
+    OPCODE(0x65B, "bit 3, (iy+d)",    4, (test_bit<3, Operand8::IY_D>()))                         \
+    OPCODE(0x65C, "bit 3, (iy+d)",    4, (test_bit<3, Operand8::IY_D>()))                         \
+    OPCODE(0x65D, "bit 3, (iy+d)",    4, (test_bit<3, Operand8::IY_D>()))                         \
+    OPCODE(0x65E, "bit 3, (iy+d)",    4, (test_bit<3, Operand8::IY_D>()))                         \
+    OPCODE(0x65F, "bit 3, (iy+d)",    4, (test_bit<3, Operand8::IY_D>()))                         \
+    OPCODE(0x660, "bit 4, (iy+d)",    4, (test_bit<4, Operand8::IY_D>()))                         \
+    OPCODE(0x661, "bit 4, (iy+d)",    4, (test_bit<4, Operand8::IY_D>()))                         \
+    OPCODE(0x662, "bit 4, (iy+d)",    4, (test_bit<4, Operand8::IY_D>()))                         \
+    OPCODE(0x663, "bit 4, (iy+d)",    4, (test_bit<4, Operand8::IY_D>()))                         \
+    OPCODE(0x664, "bit 4, (iy+d)",    4, (test_bit<4, Operand8::IY_D>()))                         \
+    OPCODE(0x665, "bit 4, (iy+d)",    4, (test_bit<4, Operand8::IY_D>()))                         \
+    OPCODE(0x666, "bit 4, (iy+d)",    4, (test_bit<4, Operand8::IY_D>()))                         \
+    OPCODE(0x667, "bit 4, (iy+d)",    4, (test_bit<4, Operand8::IY_D>()))                         \
+    OPCODE(0x668, "bit 5, (iy+d)",    4, (test_bit<5, Operand8::IY_D>()))                         \
+    OPCODE(0x669, "bit 5, (iy+d)",    4, (test_bit<5, Operand8::IY_D>()))                         \
+    OPCODE(0x66A, "bit 5, (iy+d)",    4, (test_bit<5, Operand8::IY_D>()))                         \
+    OPCODE(0x66B, "bit 5, (iy+d)",    4, (test_bit<5, Operand8::IY_D>()))                         \
+    OPCODE(0x66C, "bit 5, (iy+d)",    4, (test_bit<5, Operand8::IY_D>()))                         \
+    OPCODE(0x66D, "bit 5, (iy+d)",    4, (test_bit<5, Operand8::IY_D>()))                         \
+    OPCODE(0x66E, "bit 5, (iy+d)",    4, (test_bit<5, Operand8::IY_D>()))                         \
+    OPCODE(0x66F, "bit 5, (iy+d)",    4, (test_bit<5, Operand8::IY_D>()))                         \
+    OPCODE(0x670, "bit 6, (iy+d)",    4, (test_bit<6, Operand8::IY_D>()))                         \
+    OPCODE(0x671, "bit 6, (iy+d)",    4, (test_bit<6, Operand8::IY_D>()))                         \
+    OPCODE(0x672, "bit 6, (iy+d)",    4, (test_bit<6, Operand8::IY_D>()))                         \
+    OPCODE(0x673, "bit 6, (iy+d)",    4, (test_bit<6, Operand8::IY_D>()))                         \
+    OPCODE(0x674, "bit 6, (iy+d)",    4, (test_bit<6, Operand8::IY_D>()))                         \
+    OPCODE(0x675, "bit 6, (iy+d)",    4, (test_bit<6, Operand8::IY_D>()))                         \
+    OPCODE(0x676, "bit 6, (iy+d)",    4, (test_bit<6, Operand8::IY_D>()))                         \
+    OPCODE(0x677, "bit 6, (iy+d)",    4, (test_bit<6, Operand8::IY_D>()))                         \
+    OPCODE(0x678, "bit 7, (iy+d)",    4, (test_bit<7, Operand8::IY_D>()))                         \
+    OPCODE(0x679, "bit 7, (iy+d)",    4, (test_bit<7, Operand8::IY_D>()))                         \
+    OPCODE(0x67A, "bit 7, (iy+d)",    4, (test_bit<7, Operand8::IY_D>()))                         \
+    OPCODE(0x67B, "bit 7, (iy+d)",    4, (test_bit<7, Operand8::IY_D>()))                         \
+    OPCODE(0x67C, "bit 7, (iy+d)",    4, (test_bit<7, Operand8::IY_D>()))                         \
+    OPCODE(0x67D, "bit 7, (iy+d)",    4, (test_bit<7, Operand8::IY_D>()))                         \
+    OPCODE(0x67E, "bit 7, (iy+d)",    4, (test_bit<7, Operand8::IY_D>()))                         \
+    OPCODE(0x67F, "bit 7, (iy+d)",    4, (test_bit<7, Operand8::IY_D>()))                         \
+    OPCODE(0x680, "res 0, (iy+d), b", 4, (change_bit<0, false, Operand8::IY_D, Operand8::B>()))   \
+    OPCODE(0x681, "res 0, (iy+d), c", 4, (change_bit<0, false, Operand8::IY_D, Operand8::C>()))   \
+    OPCODE(0x682, "res 0, (iy+d), d", 4, (change_bit<0, false, Operand8::IY_D, Operand8::D>()))   \
+    OPCODE(0x683, "res 0, (iy+d), e", 4, (change_bit<0, false, Operand8::IY_D, Operand8::E>()))   \
+    OPCODE(0x684, "res 0, (iy+d), h", 4, (change_bit<0, false, Operand8::IY_D, Operand8::H>()))   \
+    OPCODE(0x685, "res 0, (iy+d), l", 4, (change_bit<0, false, Operand8::IY_D, Operand8::L>()))   \
+    OPCODE(0x686, "res 0, (iy+d)",    4, (change_bit<0, false, Operand8::IY_D>()))                \
+    OPCODE(0x687, "res 0, (iy+d), a", 4, (change_bit<0, false, Operand8::IY_D, Operand8::A>()))   \
+    OPCODE(0x688, "res 1, (iy+d), b", 4, (change_bit<1, false, Operand8::IY_D, Operand8::B>()))   \
+    OPCODE(0x689, "res 1, (iy+d), c", 4, (change_bit<1, false, Operand8::IY_D, Operand8::C>()))   \
+    OPCODE(0x68A, "res 1, (iy+d), d", 4, (change_bit<1, false, Operand8::IY_D, Operand8::D>()))   \
+    OPCODE(0x68B, "res 1, (iy+d), e", 4, (change_bit<1, false, Operand8::IY_D, Operand8::E>()))   \
+    OPCODE(0x68C, "res 1, (iy+d), h", 4, (change_bit<1, false, Operand8::IY_D, Operand8::H>()))   \
+    OPCODE(0x68D, "res 1, (iy+d), l", 4, (change_bit<1, false, Operand8::IY_D, Operand8::L>()))   \
+    OPCODE(0x68E, "res 1, (iy+d)",    4, (change_bit<1, false, Operand8::IY_D>()))                \
+    OPCODE(0x68F, "res 1, (iy+d), a", 4, (change_bit<1, false, Operand8::IY_D, Operand8::A>()))   \
+    OPCODE(0x690, "res 2, (iy+d), b", 4, (change_bit<2, false, Operand8::IY_D, Operand8::B>()))   \
+    OPCODE(0x691, "res 2, (iy+d), c", 4, (change_bit<2, false, Operand8::IY_D, Operand8::C>()))   \
+    OPCODE(0x692, "res 2, (iy+d), d", 4, (change_bit<2, false, Operand8::IY_D, Operand8::D>()))   \
+    OPCODE(0x693, "res 2, (iy+d), e", 4, (change_bit<2, false, Operand8::IY_D, Operand8::E>()))   \
+    OPCODE(0x694, "res 2, (iy+d), h", 4, (change_bit<2, false, Operand8::IY_D, Operand8::H>()))   \
+    OPCODE(0x695, "res 2, (iy+d), l", 4, (change_bit<2, false, Operand8::IY_D, Operand8::L>()))   \
+    OPCODE(0x696, "res 2, (iy+d)",    4, (change_bit<2, false, Operand8::IY_D>()))                \
+    OPCODE(0x697, "res 2, (iy+d), a", 4, (change_bit<2, false, Operand8::IY_D, Operand8::A>()))   \
+    OPCODE(0x698, "res 3, (iy+d), b", 4, (change_bit<3, false, Operand8::IY_D, Operand8::B>()))   \
+    OPCODE(0x699, "res 3, (iy+d), c", 4, (change_bit<3, false, Operand8::IY_D, Operand8::C>()))   \
+    OPCODE(0x69A, "res 3, (iy+d), d", 4, (change_bit<3, false, Operand8::IY_D, Operand8::D>()))   \
+    OPCODE(0x69B, "res 3, (iy+d), e", 4, (change_bit<3, false, Operand8::IY_D, Operand8::E>()))   \
+    OPCODE(0x69C, "res 3, (iy+d), h", 4, (change_bit<3, false, Operand8::IY_D, Operand8::H>()))   \
+    OPCODE(0x69D, "res 3, (iy+d), l", 4, (change_bit<3, false, Operand8::IY_D, Operand8::L>()))   \
+    OPCODE(0x69E, "res 3, (iy+d)",    4, (change_bit<3, false, Operand8::IY_D>()))                \
+    OPCODE(0x69F, "res 3, (iy+d), a", 4, (change_bit<3, false, Operand8::IY_D, Operand8::A>()))   \
+    OPCODE(0x6A0, "res 4, (iy+d), b", 4, (change_bit<4, false, Operand8::IY_D, Operand8::B>()))   \
+    OPCODE(0x6A1, "res 4, (iy+d), c", 4, (change_bit<4, false, Operand8::IY_D, Operand8::C>()))   \
+    OPCODE(0x6A2, "res 4, (iy+d), d", 4, (change_bit<4, false, Operand8::IY_D, Operand8::D>()))   \
+    OPCODE(0x6A3, "res 4, (iy+d), e", 4, (change_bit<4, false, Operand8::IY_D, Operand8::E>()))   \
+    OPCODE(0x6A4, "res 4, (iy+d), h", 4, (change_bit<4, false, Operand8::IY_D, Operand8::H>()))   \
+    OPCODE(0x6A5, "res 4, (iy+d), l", 4, (change_bit<4, false, Operand8::IY_D, Operand8::L>()))   \
+    OPCODE(0x6A6, "res 4, (iy+d)",    4, (change_bit<4, false, Operand8::IY_D>()))                \
+    OPCODE(0x6A7, "res 4, (iy+d), a", 4, (change_bit<4, false, Operand8::IY_D, Operand8::A>()))   \
+    OPCODE(0x6A8, "res 5, (iy+d), b", 4, (change_bit<5, false, Operand8::IY_D, Operand8::B>()))   \
+    OPCODE(0x6A9, "res 5, (iy+d), c", 4, (change_bit<5, false, Operand8::IY_D, Operand8::C>()))   \
+    OPCODE(0x6AA, "res 5, (iy+d), d", 4, (change_bit<5, false, Operand8::IY_D, Operand8::D>()))   \
+    OPCODE(0x6AB, "res 5, (iy+d), e", 4, (change_bit<5, false, Operand8::IY_D, Operand8::E>()))   \
+    OPCODE(0x6AC, "res 5, (iy+d), h", 4, (change_bit<5, false, Operand8::IY_D, Operand8::H>()))   \
+    OPCODE(0x6AD, "res 5, (iy+d), l", 4, (change_bit<5, false, Operand8::IY_D, Operand8::L>()))   \
+    OPCODE(0x6AE, "res 5, (iy+d)",    4, (change_bit<5, false, Operand8::IY_D>()))                \
+    OPCODE(0x6AF, "res 5, (iy+d), a", 4, (change_bit<5, false, Operand8::IY_D, Operand8::A>()))   \
+    OPCODE(0x6B0, "res 6, (iy+d), b", 4, (change_bit<6, false, Operand8::IY_D, Operand8::B>()))   \
+    OPCODE(0x6B1, "res 6, (iy+d), c", 4, (change_bit<6, false, Operand8::IY_D, Operand8::C>()))   \
+    OPCODE(0x6B2, "res 6, (iy+d), d", 4, (change_bit<6, false, Operand8::IY_D, Operand8::D>()))   \
+    OPCODE(0x6B3, "res 6, (iy+d), e", 4, (change_bit<6, false, Operand8::IY_D, Operand8::E>()))   \
+    OPCODE(0x6B4, "res 6, (iy+d), h", 4, (change_bit<6, false, Operand8::IY_D, Operand8::H>()))   \
+    OPCODE(0x6B5, "res 6, (iy+d), l", 4, (change_bit<6, false, Operand8::IY_D, Operand8::L>()))   \
+    OPCODE(0x6B6, "res 6, (iy+d)",    4, (change_bit<6, false, Operand8::IY_D>()))                \
+    OPCODE(0x6B7, "res 6, (iy+d), a", 4, (change_bit<6, false, Operand8::IY_D, Operand8::A>()))   \
+    OPCODE(0x6B8, "res 7, (iy+d), b", 4, (change_bit<7, false, Operand8::IY_D, Operand8::B>()))   \
+    OPCODE(0x6B9, "res 7, (iy+d), c", 4, (change_bit<7, false, Operand8::IY_D, Operand8::C>()))   \
+    OPCODE(0x6BA, "res 7, (iy+d), d", 4, (change_bit<7, false, Operand8::IY_D, Operand8::D>()))   \
+    OPCODE(0x6BB, "res 7, (iy+d), e", 4, (change_bit<7, false, Operand8::IY_D, Operand8::E>()))   \
+    OPCODE(0x6BC, "res 7, (iy+d), h", 4, (change_bit<7, false, Operand8::IY_D, Operand8::H>()))   \
+    OPCODE(0x6BD, "res 7, (iy+d), l", 4, (change_bit<7, false, Operand8::IY_D, Operand8::L>()))   \
+    OPCODE(0x6BE, "res 7, (iy+d)",    4, (change_bit<7, false, Operand8::IY_D>()))                \
+    OPCODE(0x6BF, "res 7, (iy+d), a", 4, (change_bit<7, false, Operand8::IY_D, Operand8::A>()))   \
+    OPCODE(0x6C0, "set 0, (iy+d), b", 4, (change_bit<0, true, Operand8::IY_D, Operand8::B>()))    \
+    OPCODE(0x6C1, "set 0, (iy+d), c", 4, (change_bit<0, true, Operand8::IY_D, Operand8::C>()))    \
+    OPCODE(0x6C2, "set 0, (iy+d), d", 4, (change_bit<0, true, Operand8::IY_D, Operand8::D>()))    \
+    OPCODE(0x6C3, "set 0, (iy+d), e", 4, (change_bit<0, true, Operand8::IY_D, Operand8::E>()))    \
+    OPCODE(0x6C4, "set 0, (iy+d), h", 4, (change_bit<0, true, Operand8::IY_D, Operand8::H>()))    \
+    OPCODE(0x6C5, "set 0, (iy+d), l", 4, (change_bit<0, true, Operand8::IY_D, Operand8::L>()))    \
+    OPCODE(0x6C6, "set 0, (iy+d)",    4, (change_bit<0, true, Operand8::IY_D>()))                 \
+    OPCODE(0x6C7, "set 0, (iy+d), a", 4, (change_bit<0, true, Operand8::IY_D, Operand8::A>()))    \
+    OPCODE(0x6C8, "set 1, (iy+d), b", 4, (change_bit<1, true, Operand8::IY_D, Operand8::B>()))    \
+    OPCODE(0x6C9, "set 1, (iy+d), c", 4, (change_bit<1, true, Operand8::IY_D, Operand8::C>()))    \
+    OPCODE(0x6CA, "set 1, (iy+d), d", 4, (change_bit<1, true, Operand8::IY_D, Operand8::D>()))    \
+    OPCODE(0x6CB, "set 1, (iy+d), e", 4, (change_bit<1, true, Operand8::IY_D, Operand8::E>()))    \
+    OPCODE(0x6CC, "set 1, (iy+d), h", 4, (change_bit<1, true, Operand8::IY_D, Operand8::H>()))    \
+    OPCODE(0x6CD, "set 1, (iy+d), l", 4, (change_bit<1, true, Operand8::IY_D, Operand8::L>()))    \
+    OPCODE(0x6CE, "set 1, (iy+d)",    4, (change_bit<1, true, Operand8::IY_D>()))                 \
+    OPCODE(0x6CF, "set 1, (iy+d), a", 4, (change_bit<1, true, Operand8::IY_D, Operand8::A>()))    \
+    OPCODE(0x6D0, "set 2, (iy+d), b", 4, (change_bit<2, true, Operand8::IY_D, Operand8::B>()))    \
+    OPCODE(0x6D1, "set 2, (iy+d), c", 4, (change_bit<2, true, Operand8::IY_D, Operand8::C>()))    \
+    OPCODE(0x6D2, "set 2, (iy+d), d", 4, (change_bit<2, true, Operand8::IY_D, Operand8::D>()))    \
+    OPCODE(0x6D3, "set 2, (iy+d), e", 4, (change_bit<2, true, Operand8::IY_D, Operand8::E>()))    \
+    OPCODE(0x6D4, "set 2, (iy+d), h", 4, (change_bit<2, true, Operand8::IY_D, Operand8::H>()))    \
+    OPCODE(0x6D5, "set 2, (iy+d), l", 4, (change_bit<2, true, Operand8::IY_D, Operand8::L>()))    \
+    OPCODE(0x6D6, "set 2, (iy+d)",    4, (change_bit<2, true, Operand8::IY_D>()))                 \
+    OPCODE(0x6D7, "set 2, (iy+d), a", 4, (change_bit<2, true, Operand8::IY_D, Operand8::A>()))    \
+    OPCODE(0x6D8, "set 3, (iy+d), b", 4, (change_bit<3, true, Operand8::IY_D, Operand8::B>()))    \
+    OPCODE(0x6D9, "set 3, (iy+d), c", 4, (change_bit<3, true, Operand8::IY_D, Operand8::C>()))    \
+    OPCODE(0x6DA, "set 3, (iy+d), d", 4, (change_bit<3, true, Operand8::IY_D, Operand8::D>()))    \
+    OPCODE(0x6DB, "set 3, (iy+d), e", 4, (change_bit<3, true, Operand8::IY_D, Operand8::E>()))    \
+    OPCODE(0x6DC, "set 3, (iy+d), h", 4, (change_bit<3, true, Operand8::IY_D, Operand8::H>()))    \
+    OPCODE(0x6DD, "set 3, (iy+d), l", 4, (change_bit<3, true, Operand8::IY_D, Operand8::L>()))    \
+    OPCODE(0x6DE, "set 3, (iy+d)",    4, (change_bit<3, true, Operand8::IY_D>()))                 \
+    OPCODE(0x6DF, "set 3, (iy+d), a", 4, (change_bit<3, true, Operand8::IY_D, Operand8::A>()))    \
+    OPCODE(0x6E0, "set 4, (iy+d), b", 4, (change_bit<4, true, Operand8::IY_D, Operand8::B>()))    \
+    OPCODE(0x6E1, "set 4, (iy+d), c", 4, (change_bit<4, true, Operand8::IY_D, Operand8::C>()))    \
+    OPCODE(0x6E2, "set 4, (iy+d), d", 4, (change_bit<4, true, Operand8::IY_D, Operand8::D>()))    \
+    OPCODE(0x6E3, "set 4, (iy+d), e", 4, (change_bit<4, true, Operand8::IY_D, Operand8::E>()))    \
+    OPCODE(0x6E4, "set 4, (iy+d), h", 4, (change_bit<4, true, Operand8::IY_D, Operand8::H>()))    \
+    OPCODE(0x6E5, "set 4, (iy+d), l", 4, (change_bit<4, true, Operand8::IY_D, Operand8::L>()))    \
+    OPCODE(0x6E6, "set 4, (iy+d)",    4, (change_bit<4, true, Operand8::IY_D>()))                 \
+    OPCODE(0x6E7, "set 4, (iy+d), a", 4, (change_bit<4, true, Operand8::IY_D, Operand8::A>()))    \
+    OPCODE(0x6E8, "set 5, (iy+d), b", 4, (change_bit<5, true, Operand8::IY_D, Operand8::B>()))    \
+    OPCODE(0x6E9, "set 5, (iy+d), c", 4, (change_bit<5, true, Operand8::IY_D, Operand8::C>()))    \
+    OPCODE(0x6EA, "set 5, (iy+d), d", 4, (change_bit<5, true, Operand8::IY_D, Operand8::D>()))    \
+    OPCODE(0x6EB, "set 5, (iy+d), e", 4, (change_bit<5, true, Operand8::IY_D, Operand8::E>()))    \
+    OPCODE(0x6EC, "set 5, (iy+d), h", 4, (change_bit<5, true, Operand8::IY_D, Operand8::H>()))    \
+    OPCODE(0x6ED, "set 5, (iy+d), l", 4, (change_bit<5, true, Operand8::IY_D, Operand8::L>()))    \
+    OPCODE(0x6EE, "set 5, (iy+d)",    4, (change_bit<5, true, Operand8::IY_D>()))                 \
+    OPCODE(0x6EF, "set 5, (iy+d), a", 4, (change_bit<5, true, Operand8::IY_D, Operand8::A>()))    \
+    OPCODE(0x6F0, "set 6, (iy+d), b", 4, (change_bit<6, true, Operand8::IY_D, Operand8::B>()))    \
+    OPCODE(0x6F1, "set 6, (iy+d), c", 4, (change_bit<6, true, Operand8::IY_D, Operand8::C>()))    \
+    OPCODE(0x6F2, "set 6, (iy+d), d", 4, (change_bit<6, true, Operand8::IY_D, Operand8::D>()))    \
+    OPCODE(0x6F3, "set 6, (iy+d), e", 4, (change_bit<6, true, Operand8::IY_D, Operand8::E>()))    \
+    OPCODE(0x6F4, "set 6, (iy+d), h", 4, (change_bit<6, true, Operand8::IY_D, Operand8::H>()))    \
+    OPCODE(0x6F5, "set 6, (iy+d), l", 4, (change_bit<6, true, Operand8::IY_D, Operand8::L>()))    \
+    OPCODE(0x6F6, "set 6, (iy+d)",    4, (change_bit<6, true, Operand8::IY_D>()))                 \
+    OPCODE(0x6F7, "set 6, (iy+d), a", 4, (change_bit<6, true, Operand8::IY_D, Operand8::A>()))    \
+    OPCODE(0x6F8, "set 7, (iy+d), b", 4, (change_bit<7, true, Operand8::IY_D, Operand8::B>()))    \
+    OPCODE(0x6F9, "set 7, (iy+d), c", 4, (change_bit<7, true, Operand8::IY_D, Operand8::C>()))    \
+    OPCODE(0x6FA, "set 7, (iy+d), d", 4, (change_bit<7, true, Operand8::IY_D, Operand8::D>()))    \
+    OPCODE(0x6FB, "set 7, (iy+d), e", 4, (change_bit<7, true, Operand8::IY_D, Operand8::E>()))    \
+    OPCODE(0x6FC, "set 7, (iy+d), h", 4, (change_bit<7, true, Operand8::IY_D, Operand8::H>()))    \
+    OPCODE(0x6FD, "set 7, (iy+d), l", 4, (change_bit<7, true, Operand8::IY_D, Operand8::L>()))    \
+    OPCODE(0x6FE, "set 7, (iy+d)",    4, (change_bit<7, true, Operand8::IY_D>()))                 \
+    OPCODE(0x6FF, "set 7, (iy+d), a", 4, (change_bit<7, true, Operand8::IY_D, Operand8::A>()))
+
+#endif //SOMOS_Z80_PREFIXEDOPCODETABLE_H
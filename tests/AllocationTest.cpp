@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "SMS.h"
+
+/**
+ * Every heap allocation of the test program goes through these, so that a test can check that a piece of code
+ * doesn't allocate
+ **/
+static std::atomic<unsigned long> allocation_count{0};
+
+// GCC warns about a mismatched new and delete when it inlines malloc() into one side and free() into the other, so
+// the functions that call them are kept out of line and everything else forwards to them
+#if defined(__GNUC__)
+#define OUT_OF_LINE __attribute__((noinline))
+#else
+#define OUT_OF_LINE
+#endif
+
+OUT_OF_LINE void* operator new(std::size_t size) {
+  allocation_count++;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+OUT_OF_LINE void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  allocation_count++;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+  return operator new(size, tag);
+}
+
+OUT_OF_LINE void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  operator delete(ptr);
+}
+
+TEST(AllocationTest, Update_NoAllocations) {
+  // di
+  // ld sp, 0xdff0
+  // im 1
+  // ld hl, 0xc000
+  // ld de, 0xc001
+  // ld bc, 0x0100
+  // ldir
+  // loop: in a, (0x7e)
+  // out (0xbe), a
+  // call sub
+  // jr loop
+  // sub: push af, push bc, pop bc, pop af, ret
+  std::vector<uint8_t> rom(0x8000, 0x00);
+  std::vector<uint8_t> program = {0xF3, 0x31, 0xF0, 0xDF, 0xED, 0x56, 0x21, 0x00, 0xC0, 0x11, 0x01, 0xC0, 0x01, 0x00,
+                                  0x01, 0xED, 0xB0, 0xDB, 0x7E, 0xD3, 0xBE, 0xCD, 0x20, 0x00, 0x18, 0xF7};
+  std::vector<uint8_t> sub = {0xF5, 0xC5, 0xC1, 0xF1, 0xC9};
+  std::copy(program.begin(), program.end(), rom.begin());
+  std::copy(sub.begin(), sub.end(), rom.begin() + 0x20);
+  rom[0x66] = 0xED; // retn
+  rom[0x67] = 0x45;
+
+  SMS sms{};
+  sms.load_cartridge(rom);
+  // Anything that is set up lazily, such as the code buffer of the JIT, gets set up in the first frames
+  for(int frame = 0; frame < 10; frame++) {
+    sms.update();
+  }
+
+  // Loading the cartridge allocated, which shows that the counter works
+  unsigned long allocations = allocation_count;
+  ASSERT_GT(allocations, 0);
+  for(int frame = 0; frame < 3000; frame++) {
+    if (frame % 100 == 0) {
+      sms.press_pause();
+    }
+    sms.update();
+  }
+  EXPECT_EQ(allocation_count - allocations, 0);
+  EXPECT_EQ(sms.dump_cartridge_data().size(), rom.size());
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+#include <cstdint>
+
+#include "Aot.h"
+#include "Memory.h"
+#include "Z80_Opcodes.h"
+
+/**
+ * ld b, 0x05
+ * loop: inc b
+ * djnz loop
+ * inc b undoes the decrement of djnz, so the loop never ends. Everything else is ret, which ends the walk
+ **/
+std::vector<uint8_t> loop_rom() {
+  std::vector<uint8_t> rom(0x8000, 0xC9);
+  const std::vector<uint8_t> program = {0x06, 0x05, 0x04, 0x10, 0xFD};
+  std::copy(program.begin(), program.end(), rom.begin());
+
+  return rom;
+}
+
+// What somos_aot generates for the block at loop
+void loop_block(Z80& cpu) {
+  if (!Z80::aot_step<0x04>(cpu)) return;
+  Z80::aot_step<0x10>(cpu);
+}
+
+TEST(AotTest, Walk_FollowsBranches) {
+  Memory mem{};
+  mem.load_cartridge(loop_rom());
+  AotTranslator translator{&mem};
+  translator.walk();
+
+  const std::vector<AotTranslator::Block>& blocks = translator.get_blocks();
+  // The two blocks of the program, the ret after it and the ones at the interrupt vectors
+  ASSERT_EQ(blocks.size(), 5);
+  EXPECT_EQ(blocks[0].physical, 0x0000);
+  EXPECT_EQ(blocks[0].opcodes, std::vector<uint16_t>({0x06, 0x04, 0x10}));
+  // The djnz target starts a block of its own
+  EXPECT_EQ(blocks[1].physical, 0x0002);
+  EXPECT_EQ(blocks[1].bank, 0);
+  EXPECT_EQ(blocks[1].address, 0x0002);
+  EXPECT_EQ(blocks[1].opcodes, std::vector<uint16_t>({0x04, 0x10}));
+  EXPECT_EQ(blocks[2].physical, 0x0005);
+  EXPECT_EQ(blocks[3].physical, 0x0038);
+  EXPECT_EQ(blocks[4].physical, 0x0066);
+  EXPECT_EQ(blocks[4].opcodes, std::vector<uint16_t>({0xC9}));
+}
+
+TEST(AotTest, Emit_WritesEveryBlock) {
+  Memory mem{};
+  mem.load_cartridge(loop_rom());
+  AotTranslator translator{&mem};
+  translator.walk();
+
+  std::ostringstream out;
+  translator.emit(out, "loop");
+  std::string source = out.str();
+  EXPECT_NE(source.find("namespace aot_loop"), std::string::npos);
+  EXPECT_NE(source.find("void block_000002(Z80& cpu)"), std::string::npos);
+  EXPECT_NE(source.find("if (!Z80::aot_step<0x04>(cpu)) return;"), std::string::npos);
+  EXPECT_NE(source.find("register_aot_program(&program)"), std::string::npos);
+}
+
+TEST(AotTest, Program_FoundByChecksum) {
+  std::vector<uint8_t> rom = loop_rom();
+  static const AotBlock blocks[] = {{0x0002, 0, 0x0002, loop_block}};
+  static const AotProgram program = {0x8000, rom_checksum(rom), blocks, 1};
+  register_aot_program(&program);
+
+  EXPECT_EQ(find_aot_program(rom), &program);
+  EXPECT_EQ(program.find_block(0x0002), &loop_block);
+  EXPECT_EQ(program.find_block(0x0000), nullptr);
+
+  rom[0x1000] = 0x00;
+  EXPECT_EQ(find_aot_program(rom), nullptr);
+
+  // Otherwise every later test that loads the same ROM would run loop_block
+  unregister_aot_program(&program);
+  EXPECT_EQ(find_aot_program(loop_rom()), nullptr);
+}
+
+TEST(AotTest, Program_RunsLikeInterpreter) {
+  std::vector<uint8_t> rom = loop_rom();
+  const AotBlock blocks[] = {{0x0002, 0, 0x0002, loop_block}};
+  const AotProgram program = {0x8000, rom_checksum(rom), blocks, 1};
+
+  Memory aot_mem{};
+  aot_mem.load_cartridge(rom);
+  Z80 aot_z80{&aot_mem};
+  aot_z80.reset();
+  aot_z80.set_aot_program(&program);
+
+  Memory step_mem{};
+  step_mem.load_cartridge(rom);
+  Z80 step_z80{&step_mem};
+  step_z80.reset();
+
+  unsigned long cycles = aot_z80.run(1000);
+  unsigned long step_cycles = 0;
+  while(step_cycles < cycles) {
+    step_z80.step();
+    step_cycles += step_z80.get_cycles();
+  }
+
+  Registers aot_reg = aot_z80.get_registers();
+  Registers step_reg = step_z80.get_registers();
+  EXPECT_EQ(step_cycles, cycles);
+  EXPECT_EQ(aot_reg.BC, step_reg.BC);
+  EXPECT_EQ(aot_reg.PC, step_reg.PC);
+  EXPECT_EQ(aot_reg.R, step_reg.R);
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <cstdint>
+
+#include "IoBus.h"
+
+/**
+ * Stands in for a device, and remembers the last access it got
+ **/
+struct TestDevice {
+  uint8_t value{0};
+  uint8_t last_port{0};
+  int writes{0};
+
+  uint8_t read(uint8_t port) {
+    last_port = port;
+    return value;
+  }
+
+  void write(uint8_t port, uint8_t data) {
+    last_port = port;
+    value = data;
+    writes++;
+  }
+};
+
+TEST(IoBusTest, Ports_Unconnected) {
+  IoBus io{};
+  EXPECT_EQ(io.read(0x7E), 0xFF);
+  io.write(0xBF, 0x12);
+  // Reading an unconnected port has no side effects
+  EXPECT_EQ(io.side_effect_count(), 1);
+}
+
+TEST(IoBusTest, Ports_Mirrored) {
+  IoBus io{};
+  TestDevice vdp{};
+  io.attach_read<&TestDevice::read>(PortFunction::VDP_CONTROL, &vdp);
+  io.attach_write<&TestDevice::write>(PortFunction::VDP_CONTROL, &vdp);
+
+  // Only bits 7, 6 and 0 are decoded, so every odd port from 0x80 to 0xBF is the VDP control port
+  io.write(0xBF, 0x34);
+  EXPECT_EQ(vdp.value, 0x34);
+  io.write(0x81, 0x56);
+  EXPECT_EQ(vdp.value, 0x56);
+  EXPECT_EQ(io.read(0xA5), 0x56);
+  EXPECT_EQ(vdp.last_port, 0xA5);
+
+  // The even ports are the data port
+  io.write(0xBE, 0x78);
+  EXPECT_EQ(vdp.writes, 2);
+  EXPECT_EQ(io.read(0xBE), 0xFF);
+}
+
+TEST(IoBusTest, Ports_ReadAndWriteDiffer) {
+  IoBus io{};
+  TestDevice counter{};
+  TestDevice psg{};
+  counter.value = 0x42;
+  io.attach_read<&TestDevice::read>(PortFunction::V_COUNTER, &counter);
+  io.attach_write<&TestDevice::write>(PortFunction::PSG, &psg);
+
+  // 0x7E is the V counter when read and the PSG when written
+  EXPECT_EQ(io.read(0x7E), 0x42);
+  io.write(0x7E, 0x9F);
+  EXPECT_EQ(psg.value, 0x9F);
+  EXPECT_EQ(counter.value, 0x42);
+  io.write(0x7F, 0x9E);
+  EXPECT_EQ(psg.writes, 2);
+}
+
+TEST(IoBusTest, SideEffects_WritesAndStatefulReads) {
+  IoBus io{};
+  TestDevice counter{};
+  TestDevice vdp{};
+  io.attach_read<&TestDevice::read>(PortFunction::V_COUNTER, &counter);
+  io.attach_read<&TestDevice::read>(PortFunction::VDP_DATA, &vdp, true);
+
+  // Polling the V counter can't change anything
+  io.read(0x7E);
+  io.read(0x7E);
+  EXPECT_EQ(io.side_effect_count(), 0);
+
+  io.read(0xBE);
+  io.write(0x7E, 0x9F);
+  EXPECT_EQ(io.side_effect_count(), 2);
+}
+
+TEST(IoBusTest, Ports_GameGear) {
+  IoBus io{};
+  TestDevice gg{};
+  TestDevice memory_control{};
+  gg.value = 0x80;
+  io.attach_read<&TestDevice::read>(PortFunction::GG_REGISTERS, &gg);
+  io.attach_write<&TestDevice::write>(PortFunction::MEMORY_CONTROL, &memory_control);
+
+  // Ports 0x00-0x06 only exist on the Game Gear, the rest of the range is the memory control port on both
+  io.write(0x06, 0xFF);
+  EXPECT_EQ(memory_control.writes, 1);
+  EXPECT_EQ(io.read(0x00), 0xFF);
+
+  io.set_model(ConsoleModel::GAME_GEAR);
+  EXPECT_EQ(io.get_model(), ConsoleModel::GAME_GEAR);
+  EXPECT_EQ(io.read(0x00), 0x80);
+  io.write(0x06, 0xFF);
+  io.write(0x3E, 0xAB);
+  EXPECT_EQ(gg.value, 0x80);
+  EXPECT_EQ(memory_control.writes, 2);
+  EXPECT_EQ(memory_control.value, 0xAB);
+}
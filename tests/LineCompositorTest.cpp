@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdint>
+#include <random>
+
+#include "LineCompositor.h"
+#include "Vdp.h"
+
+/**
+ * Layers of a line, filled with random pixels that follow the format of the compositor
+ **/
+struct TestLine {
+  std::array<uint8_t, SCREEN_WIDTH> background{};
+  std::array<uint8_t, SCREEN_WIDTH> priority{};
+  std::array<uint8_t, SCREEN_WIDTH> sprites{};
+  std::array<uint8_t, CRAM_SIZE> cram{};
+
+  explicit TestLine(std::mt19937& random) {
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+      background[x] = random() % 32;
+      priority[x] = (background[x] & 0x0F) != 0 && random() % 2 ? 0xFF : 0;
+      sprites[x] = random() % 3 == 0 ? random() % 16 : 0;
+    }
+    for (uint8_t& color : cram) {
+      color = random() % 64;
+    }
+  }
+
+  std::array<uint8_t, SCREEN_WIDTH> compose(CompositorKernel kernel) const {
+    std::array<uint8_t, SCREEN_WIDTH> out{};
+    get_line_compositor(kernel)(background.data(), priority.data(), sprites.data(), cram.data(), out.data());
+    return out;
+  }
+};
+
+TEST(LineCompositorTest, Scalar_Layers) {
+  std::mt19937 random{1};
+  TestLine line{random};
+  for (int i = 0; i < CRAM_SIZE; i++) {
+    line.cram[i] = i;
+  }
+  // Background only, sprite over the background, and background in front of the sprite
+  line.background[0] = 5;
+  line.sprites[0] = 0;
+  line.background[1] = 21;
+  line.priority[1] = 0;
+  line.sprites[1] = 3;
+  line.background[2] = 7;
+  line.priority[2] = 0xFF;
+  line.sprites[2] = 3;
+
+  std::array<uint8_t, SCREEN_WIDTH> out = line.compose(CompositorKernel::SCALAR);
+  EXPECT_EQ(out[0], 5);
+  EXPECT_EQ(out[1], 19);
+  EXPECT_EQ(out[2], 7);
+}
+
+TEST(LineCompositorTest, Kernels_MatchScalar) {
+  std::mt19937 random{42};
+  for (CompositorKernel kernel : {CompositorKernel::SSE2, CompositorKernel::AVX2}) {
+    if (!compositor_supported(kernel)) {
+      continue;
+    }
+    for (int i = 0; i < 100; i++) {
+      TestLine line{random};
+      EXPECT_EQ(line.compose(kernel), line.compose(CompositorKernel::SCALAR));
+    }
+  }
+}
+
+TEST(LineCompositorTest, Best_Supported) {
+  EXPECT_TRUE(compositor_supported(best_compositor_kernel()));
+  EXPECT_NE(get_line_compositor(best_compositor_kernel()), nullptr);
+}
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <cstdint>
+
+#include "Memory.h"
+
+/**
+ * Builds a SEGA mapper ROM where the first byte of every 16KB page holds the page number
+ **/
+std::vector<uint8_t> paged_rom(int pages) {
+  std::vector<uint8_t> rom(pages * CART_PAGE_SIZE, 0);
+  for(int page = 0; page < pages; page++) {
+    rom[page * CART_PAGE_SIZE] = page;
+    rom[page * CART_PAGE_SIZE + 0x0400] = page;
+  }
+
+  return rom;
+}
+
+TEST(MemoryTest, Mapper_DefaultPages) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(8));
+
+  EXPECT_EQ(mem.read(0x0400), 0);
+  EXPECT_EQ(mem.read(0x4000), 1);
+  EXPECT_EQ(mem.read(0x8000), 2);
+}
+
+TEST(MemoryTest, Mapper_SwitchPages) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(8));
+
+  mem.write(MAPPER_SLOT0_CONTROL_R, 5);
+  mem.write(MAPPER_SLOT1_CONTROL_R, 6);
+  mem.write(MAPPER_SLOT2_CONTROL_R, 7);
+
+  // The first 1KB of slot 0 is never paged
+  EXPECT_EQ(mem.read(0x0000), 0);
+  EXPECT_EQ(mem.read(0x0400), 5);
+  EXPECT_EQ(mem.read(0x4000), 6);
+  EXPECT_EQ(mem.read(0x8000), 7);
+
+  // Page numbers larger than the cartridge wrap around
+  mem.write(MAPPER_SLOT2_CONTROL_R, 11);
+  EXPECT_EQ(mem.read(0x8000), 3);
+}
+
+TEST(MemoryTest, Mapper_CartridgeRAM) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(8));
+
+  // Map cartridge RAM bank 0 into slot 2
+  mem.write(MAPPER_RAM_CONTROL_R, 0x08);
+  mem.write(0x8000, 0xAB);
+  EXPECT_EQ(mem.read(0x8000), 0xAB);
+
+  // Bank 1 is a separate block of memory
+  mem.write(MAPPER_RAM_CONTROL_R, 0x0C);
+  EXPECT_EQ(mem.read(0x8000), 0x00);
+  mem.write(0x8000, 0xCD);
+
+  mem.write(MAPPER_RAM_CONTROL_R, 0x08);
+  EXPECT_EQ(mem.read(0x8000), 0xAB);
+
+  // Back to ROM
+  mem.write(MAPPER_RAM_CONTROL_R, 0x00);
+  EXPECT_EQ(mem.read(0x8000), 2);
+}
+
+TEST(MemoryTest, RAM_Mirror) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(8));
+
+  mem.write(0xc010, 0x12);
+  EXPECT_EQ(mem.read(0xe010), 0x12);
+
+  mem.write(0xe020, 0x34);
+  EXPECT_EQ(mem.read(0xc020), 0x34);
+
+  // The mapper control registers are written through to RAM
+  mem.write(MAPPER_SLOT2_CONTROL_R, 3);
+  EXPECT_EQ(mem.read(0xdfff), 3);
+  EXPECT_EQ(mem.read(0xffff), 3);
+
+  // Writing the same byte of RAM through the non-mirrored address does not change the mapper
+  mem.write(0xdfff, 5);
+  EXPECT_EQ(mem.read(0xffff), 5);
+  EXPECT_EQ(mem.read(0x8000), 3);
+}
+
+TEST(MemoryTest, RAM_ClearedOnLoad) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(8));
+  mem.write(0xc123, 0x42);
+  mem.write(MAPPER_RAM_CONTROL_R, 0x08);
+  mem.write(0x8123, 0x24);
+
+  mem.load_cartridge(paged_rom(8));
+  EXPECT_EQ(mem.read(0xc123), 0x00);
+  mem.write(MAPPER_RAM_CONTROL_R, 0x08);
+  EXPECT_EQ(mem.read(0x8123), 0x00);
+}
+
+TEST(MemoryTest, ROM_IsReadOnly) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(8));
+
+  mem.write(0x4000, 0xff);
+  EXPECT_EQ(mem.read(0x4000), 1);
+}
+
+TEST(MemoryTest, Mapper_Detection) {
+  Memory mem{};
+
+  mem.load_cartridge(paged_rom(8));
+  EXPECT_EQ(mem.get_mapper(), MapperType::SEGA);
+
+  mem.load_cartridge(paged_rom(2));
+  EXPECT_EQ(mem.get_mapper(), MapperType::NONE);
+
+  // Codemasters header checksum and its negation add up to 0x10000
+  std::vector<uint8_t> rom = paged_rom(8);
+  rom[0x7fe6] = 0x34;
+  rom[0x7fe7] = 0x12;
+  rom[0x7fe8] = 0xcc;
+  rom[0x7fe9] = 0xed;
+  mem.load_cartridge(rom);
+  EXPECT_EQ(mem.get_mapper(), MapperType::CODEMASTERS);
+}
+
+TEST(MemoryTest, Mapper_Codemasters) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(8), MapperType::CODEMASTERS);
+
+  EXPECT_EQ(mem.read(0x0400), 0);
+  EXPECT_EQ(mem.read(0x4000), 1);
+  EXPECT_EQ(mem.read(0x8000), 0);
+
+  mem.write(CODEMASTERS_SLOT0_CONTROL_R, 3);
+  mem.write(CODEMASTERS_SLOT2_CONTROL_R, 5);
+
+  // Slot 0 is fully paged
+  EXPECT_EQ(mem.read(0x0000), 3);
+  EXPECT_EQ(mem.read(0x8000), 5);
+
+  // The SEGA registers are plain RAM
+  mem.write(MAPPER_SLOT1_CONTROL_R, 6);
+  EXPECT_EQ(mem.read(0x4000), 1);
+}
+
+TEST(MemoryTest, Mapper_Korean) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(8), MapperType::KOREAN);
+
+  mem.write(KOREAN_SLOT2_CONTROL_R, 6);
+  EXPECT_EQ(mem.read(0x8000), 6);
+  EXPECT_EQ(mem.read(0x4000), 1);
+
+  mem.write(MAPPER_SLOT2_CONTROL_R, 3);
+  EXPECT_EQ(mem.read(0x8000), 6);
+}
+
+TEST(MemoryTest, Mapper_None) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(2), MapperType::NONE);
+
+  mem.write(MAPPER_SLOT1_CONTROL_R, 0);
+  EXPECT_EQ(mem.read(0x0400), 0);
+  EXPECT_EQ(mem.read(0x4000), 1);
+}
+
+TEST(MemoryTest, PhysicalAddress) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(8));
+
+  // The same ROM byte has the same physical address whichever slot it is mapped to
+  mem.write(MAPPER_SLOT2_CONTROL_R, 5);
+  EXPECT_EQ(mem.physical_address(0x8010), 5 * CART_PAGE_SIZE + 0x10);
+  mem.write(MAPPER_SLOT1_CONTROL_R, 5);
+  EXPECT_EQ(mem.physical_address(0x4010), 5 * CART_PAGE_SIZE + 0x10);
+
+  // RAM comes after the ROM and the mirror shares its addresses
+  EXPECT_EQ(mem.physical_address(0xc010), 8 * CART_PAGE_SIZE + 0x10);
+  EXPECT_EQ(mem.physical_address(0xe010), 8 * CART_PAGE_SIZE + 0x10);
+}
+
+TEST(MemoryTest, CodeGeneration) {
+  Memory mem{};
+  mem.load_cartridge(paged_rom(8));
+  uint32_t physical = mem.physical_address(0xc000);
+  uint32_t generation = mem.page_generation(physical);
+
+  // Writes only change the generation of watched pages
+  mem.write(0xc000, 0x01);
+  EXPECT_EQ(mem.page_generation(physical), generation);
+
+  mem.watch_code(physical);
+  mem.write(0xe3ff, 0x01);
+  EXPECT_NE(mem.page_generation(physical), generation);
+  EXPECT_EQ(mem.page_generation(mem.physical_address(0xc400)), generation);
+}
+
+TEST(MemoryTest, RamImage) {
+  Memory mem{};
+  mem.load_ram_image(paged_rom(2));
+
+  // The image is copied to RAM, and the mapper registers are plain RAM
+  EXPECT_EQ(mem.get_mapper(), MapperType::NONE);
+  EXPECT_EQ(mem.read(0x4000), 1);
+  mem.write(0x0000, 0x12);
+  mem.write(MAPPER_SLOT1_CONTROL_R, 0);
+  EXPECT_EQ(mem.read(0x0000), 0x12);
+  EXPECT_EQ(mem.read(MAPPER_SLOT1_CONTROL_R), 0);
+  EXPECT_EQ(mem.read(0x4000), 1);
+
+  // There is no mirror
+  mem.write(0xc000, 0x34);
+  EXPECT_EQ(mem.read(0xe000), 0);
+  mem.write_word(0xffff, 0x5678);
+  EXPECT_EQ(mem.read_word(0xffff), 0x5678);
+  EXPECT_EQ(mem.read(0x0000), 0x56);
+  EXPECT_FALSE(mem.is_rom(mem.physical_address(0x0000)));
+}
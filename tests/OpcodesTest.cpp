@@ -1,15 +1,20 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <vector>
 #include <cstdint>
 #include <iostream>
+#include <random>
 #include <fstream>
+#include <utility>
 
 #include "Registers.h"
 #include "Z80.h"
+#include "IoBus.h"
 #include "Memory.h"
 
 Memory mem{};
-Z80 z80{&mem};
+IoBus io{};
+Z80 z80{&mem, &io};
 
 std::vector<uint8_t> open_file(const std::string path) {
   std::ifstream f{path, std::ios::binary};
@@ -23,6 +28,27 @@ const std::vector<uint8_t> blank_rom = open_file("test_roms/blank.sms");
 void setup() {
   z80.reset();
   mem.load_cartridge(blank_rom);
+  io.detach_all();
+}
+
+/**
+ * Device for the I/O instruction tests. Reads return the port number plus one, writes are logged
+ **/
+struct PortLog {
+  std::vector<std::pair<uint8_t, uint8_t>> writes;
+
+  uint8_t read(uint8_t port) {
+    return port + 1;
+  }
+
+  void write(uint8_t port, uint8_t value) {
+    writes.emplace_back(port, value);
+  }
+};
+
+void attach_port_log(PortLog& log) {
+  io.attach_read<&PortLog::read>(PortFunction::VDP_DATA, &log);
+  io.attach_write<&PortLog::write>(PortFunction::VDP_DATA, &log);
 }
 
 /**
@@ -166,3 +192,1012 @@ TEST(OpcodesTest, Opcode_0x05_DEC_B) {
   EXPECT_TRUE(z80.is_flag_set(FLAGS::SUBTRACT_N));
   EXPECT_TRUE(z80.is_flag_set(FLAGS::OVERFLOW_V));
 }
+
+TEST(OpcodesTest, Run_RunsUntilCycleBudget) {
+  setup();
+
+  // The blank ROM is filled with nop, which takes 4 cycles. The overshoot is included in the result
+  EXPECT_EQ(z80.run(10), 12);
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.PC, 0x03);
+  EXPECT_EQ(z80.get_run_cycles(), 12);
+}
+
+TEST(OpcodesTest, Refresh_R_IncrementsEveryInstruction) {
+  setup();
+  z80.run(4 * 130);
+
+  // Only the lower 7 bits are incremented
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.R, 130 & 0x7F);
+}
+
+TEST(OpcodesTest, LazyFlags_KeepUnaffectedFlags) {
+  setup();
+  write_to_ram({0x06, 0xFF, 0x04, 0x0C, 0x08, 0x08});
+  z80.flag_set(FLAGS::CARRY_C);
+  z80.step(); // ld b, 0xff
+  z80.step(); // inc b
+  z80.step(); // inc c
+
+  // inc c overwrote the zero flag from inc b, carry is untouched by both
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::ZERO_Z));
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::HALF_CARRY_H));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::CARRY_C));
+
+  z80.step(); // ex af, af'
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::CARRY_C));
+  z80.step(); // ex af, af'
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::CARRY_C));
+}
+
+TEST(OpcodesTest, Run_SelfModifyingCode) {
+  setup();
+  write_to_ram({0x04, 0x04, 0x04});
+  z80.run(12); // inc b, inc b, inc b
+  EXPECT_EQ(z80.get_registers().B, 3);
+
+  // Code that was already run from RAM must not be reused after it is overwritten
+  mem.write(0xc001, 0x05);
+  z80.set_pc(0xc000);
+  z80.run(12); // inc b, dec b, inc b
+  EXPECT_EQ(z80.get_registers().B, 4);
+}
+
+/**
+ * Runs a ROM with run() and with step() on separate CPUs and checks that they end up in the same state
+ **/
+void expect_run_matches_step(const std::vector<uint8_t>& program, unsigned long budget) {
+  std::vector<uint8_t> rom(0x8000, 0x00);
+  std::copy(program.begin(), program.end(), rom.begin());
+
+  Memory run_mem{};
+  run_mem.load_cartridge(rom);
+  Z80 run_z80{&run_mem};
+  run_z80.reset();
+
+  Memory step_mem{};
+  step_mem.load_cartridge(rom);
+  Z80 step_z80{&step_mem};
+  step_z80.reset();
+
+  unsigned long cycles = 0;
+  for(int frame = 0; frame < 20; frame++) {
+    cycles += run_z80.run(budget);
+  }
+
+  unsigned long step_cycles = 0;
+  while(step_cycles < cycles) {
+    step_z80.step();
+    step_cycles += step_z80.get_cycles();
+  }
+
+  Registers run_reg = run_z80.get_registers();
+  Registers step_reg = step_z80.get_registers();
+  EXPECT_EQ(step_cycles, cycles);
+  EXPECT_EQ(run_reg.AF, step_reg.AF);
+  EXPECT_EQ(run_reg.BC, step_reg.BC);
+  EXPECT_EQ(run_reg.DE, step_reg.DE);
+  EXPECT_EQ(run_reg.HL, step_reg.HL);
+  EXPECT_EQ(run_reg.SP, step_reg.SP);
+  EXPECT_EQ(run_reg.PC, step_reg.PC);
+  EXPECT_EQ(run_reg.R, step_reg.R);
+}
+
+TEST(OpcodesTest, Run_MatchesStep) {
+  // A loop in ROM that runs often enough to be translated when the JIT is enabled
+  expect_run_matches_step({0x06, 0x40, 0x0C, 0x81, 0xA8, 0x98, 0x10, 0xFC}, 5000);
+}
+
+TEST(OpcodesTest, Run_TranslatedBlocksMatchStep) {
+  // Random loops of the instructions that the JIT emits as native code: 8-bit loads and arithmetic on registers and
+  // immediates, 16-bit loads, increments and decrements, and forward jr and djnz. Instructions that run from their
+  // steps are mixed in, some of which leave the flags lazy (add hl, bc) or read them (adc, sbc, ccf)
+  const std::vector<uint8_t> stepped = {0x07, 0x09, 0x27, 0x2F, 0x37, 0x3F};
+  std::mt19937 random{0x5E6A};
+  // Register field of an opcode, anything but (hl)
+  auto register_field = [&random]() {
+    uint8_t r = random() % 7;
+    return static_cast<uint8_t>(r == 6 ? 7 : r);
+  };
+
+  for(int program_index = 0; program_index < 20; program_index++) {
+    std::vector<std::vector<uint8_t>> instructions;
+    // Number of instructions each jr or djnz skips, its offset is only known once they are all generated
+    std::vector<int> skips;
+
+    for(int i = 0; i < 40; i++) {
+      uint8_t r = register_field();
+      uint8_t r2 = register_field();
+      uint8_t n = random();
+      std::vector<uint8_t> instruction;
+      int skip = -1;
+
+      switch(random() % 10) {
+        case 0: instruction = {static_cast<uint8_t>(0x40 | r << 3 | r2)}; break;
+        case 1: instruction = {static_cast<uint8_t>(0x06 | r << 3), n}; break;
+        case 2: instruction = {static_cast<uint8_t>(0x01 | (random() % 4) << 4), n, static_cast<uint8_t>(random())}; break;
+        case 3: instruction = {static_cast<uint8_t>(0x04 | r << 3 | random() % 2)}; break;
+        case 4: instruction = {static_cast<uint8_t>(0x03 | (random() % 8) << 3)}; break;
+        case 5: instruction = {static_cast<uint8_t>(0x80 | (random() % 8) << 3 | r2)}; break;
+        case 6: instruction = {static_cast<uint8_t>(0xC6 | (random() % 8) << 3), n}; break;
+        case 7: instruction = {stepped[random() % stepped.size()]}; break;
+        case 8: instruction = {0x00}; break;
+        case 9:
+          // djnz, jr, jr nz, jr z, jr nc or jr c
+          instruction = {static_cast<uint8_t>(0x10 + 8 * (random() % 6)), 0};
+          skip = random() % 4;
+          break;
+      }
+
+      instructions.push_back(instruction);
+      skips.push_back(skip);
+    }
+
+    // The skipped instructions have to exist, and the loop ends with jp 0x0000
+    std::vector<uint8_t> program;
+    for(size_t i = 0; i < instructions.size(); i++) {
+      if(skips[i] >= 0) {
+        int offset = 0;
+        for(size_t j = i + 1; j < instructions.size() && j <= i + skips[i]; j++) {
+          offset += instructions[j].size();
+        }
+        instructions[i][1] = offset;
+      }
+      program.insert(program.end(), instructions[i].begin(), instructions[i].end());
+    }
+    program.insert(program.end(), {0xC3, 0x00, 0x00});
+
+    SCOPED_TRACE(program_index);
+    expect_run_matches_step(program, 3001);
+  }
+}
+
+TEST(OpcodesTest, Run_IdleLoopMatchesStep) {
+  // ld b, 0x01
+  // loop: and b
+  // jr z, loop
+  // A is 0, so the loop never ends and is skipped up to the deadline
+  expect_run_matches_step({0x06, 0x01, 0xA0, 0x28, 0xFD}, 1001);
+
+  // Same loop, but inc c changes the state every iteration
+  expect_run_matches_step({0x06, 0x01, 0xA0, 0x0C, 0x28, 0xFC}, 1001);
+
+  // ld bc, 0xc000
+  // loop: ld (bc), a
+  // jp loop
+  // Writes every iteration, so it isn't idle
+  expect_run_matches_step({0x01, 0x00, 0xC0, 0x02, 0xC3, 0x03, 0x00}, 1001);
+}
+
+/**
+ * Stands in for the V counter, and counts how often it is read
+ **/
+struct VCounterPort {
+  int reads{0};
+
+  uint8_t read(uint8_t) {
+    reads++;
+    return 0xB0;
+  }
+};
+
+TEST(OpcodesTest, Run_PollingLoopMatchesStep) {
+  // loop: in a, (0x7e)
+  // jr loop
+  // Reading the V counter has no side effects, so the loop is skipped up to the deadline
+  std::vector<uint8_t> rom(0x8000, 0x00);
+  const std::vector<uint8_t> program = {0xDB, 0x7E, 0x18, 0xFC};
+  std::copy(program.begin(), program.end(), rom.begin());
+
+  Memory run_mem{};
+  run_mem.load_cartridge(rom);
+  IoBus run_io{};
+  VCounterPort run_counter{};
+  run_io.attach_read<&VCounterPort::read>(PortFunction::V_COUNTER, &run_counter);
+  Z80 run_z80{&run_mem, &run_io};
+  run_z80.reset();
+
+  Memory step_mem{};
+  step_mem.load_cartridge(rom);
+  IoBus step_io{};
+  VCounterPort step_counter{};
+  step_io.attach_read<&VCounterPort::read>(PortFunction::V_COUNTER, &step_counter);
+  Z80 step_z80{&step_mem, &step_io};
+  step_z80.reset();
+
+  unsigned long cycles = run_z80.run(100000);
+  EXPECT_GE(cycles, 100000);
+  EXPECT_LT(cycles, 100000 + 23);
+  EXPECT_LE(run_counter.reads, 3);
+
+  unsigned long step_cycles = 0;
+  while(step_cycles < cycles) {
+    step_z80.step();
+    step_cycles += step_z80.get_cycles();
+  }
+
+  Registers run_reg = run_z80.get_registers();
+  Registers step_reg = step_z80.get_registers();
+  EXPECT_EQ(step_cycles, cycles);
+  EXPECT_EQ(run_reg.AF, step_reg.AF);
+  EXPECT_EQ(run_reg.PC, step_reg.PC);
+  EXPECT_EQ(run_reg.R, step_reg.R);
+  EXPECT_GT(step_counter.reads, 4000);
+}
+
+TEST(OpcodesTest, Opcode_0x76_HALT) {
+  setup();
+  write_to_ram({0x76});
+  z80.step();
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 4);
+  EXPECT_EQ(reg.PC, 0xc000);
+  EXPECT_TRUE(z80.is_halted());
+
+  // The nops up to the deadline are run at once
+  EXPECT_EQ(z80.run(1002), 1004);
+  reg = z80.get_registers();
+  EXPECT_EQ(reg.PC, 0xc000);
+  EXPECT_EQ(reg.R, (1 + 1004 / 4) & 0x7F);
+}
+
+TEST(OpcodesTest, Opcode_0x18_JR_d) {
+  setup();
+  write_to_ram({0x18, 0x02, 0x00, 0x00, 0x18, 0xFA});
+  z80.step(); // jr 2
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 12);
+  EXPECT_EQ(reg.PC, 0xc004);
+
+  z80.step(); // jr -6
+  reg = z80.get_registers();
+  EXPECT_EQ(reg.PC, 0xc000);
+}
+
+TEST(OpcodesTest, Opcode_0x20_JR_NZ_d) {
+  setup();
+  write_to_ram({0xA8, 0x20, 0x10});
+  z80.step(); // xor b
+  z80.step(); // jr nz, 0x10
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 7);
+  EXPECT_EQ(reg.PC, 0xc003);
+}
+
+TEST(OpcodesTest, Opcode_0xC3_JP_nn) {
+  setup();
+  write_to_ram({0xC3, 0x34, 0x12});
+  z80.step();
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 10);
+  EXPECT_EQ(reg.PC, 0x1234);
+}
+
+TEST(OpcodesTest, Opcode_0x80_ADD_A_B) {
+  setup();
+  write_to_ram({0x06, 0x01, 0x80});
+  z80.step(); // ld b, 0x01
+  z80.step(); // add a, b
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 4);
+  EXPECT_EQ(reg.PC, 0xc003);
+  EXPECT_EQ(reg.A, 0x01);
+  EXPECT_EQ(reg.F, 0);
+
+  // 0x7F + 0x01 overflows into the sign bit
+  setup();
+  write_to_ram({0x06, 0x7F, 0x80, 0x80});
+  z80.step(); // ld b, 0x7f
+  z80.step(); // add a, b
+  z80.step(); // add a, b
+  reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 0xFE);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::SIGN_S));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::OVERFLOW_V));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::HALF_CARRY_H));
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::CARRY_C));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::COPY_5));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::COPY_3));
+}
+
+TEST(OpcodesTest, Opcode_0x88_ADC_A_B) {
+  setup();
+  write_to_ram({0x06, 0xFF, 0x88});
+  z80.flag_set(FLAGS::CARRY_C);
+  z80.step(); // ld b, 0xff
+  z80.step(); // adc a, b
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 0x00);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::ZERO_Z));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::CARRY_C));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::HALF_CARRY_H));
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::OVERFLOW_V));
+}
+
+TEST(OpcodesTest, Opcode_0x90_SUB_B) {
+  setup();
+  write_to_ram({0x06, 0x01, 0x90});
+  z80.step(); // ld b, 0x01
+  z80.step(); // sub b
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 0xFF);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::SUBTRACT_N));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::CARRY_C));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::HALF_CARRY_H));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::SIGN_S));
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::OVERFLOW_V));
+}
+
+TEST(OpcodesTest, Opcode_0x98_SBC_A_B) {
+  setup();
+  write_to_ram({0x98});
+  z80.flag_set(FLAGS::CARRY_C);
+  z80.step(); // sbc a, b
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 0xFF);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::CARRY_C));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::SUBTRACT_N));
+}
+
+TEST(OpcodesTest, Opcode_0xA0_AND_B) {
+  setup();
+  write_to_ram({0xC6, 0x0F, 0x06, 0x3C, 0xA0});
+  z80.step(); // add a, 0x0f
+  z80.step(); // ld b, 0x3c
+  z80.step(); // and b
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 0x0C);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::HALF_CARRY_H));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::PARITY_P));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::COPY_3));
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::CARRY_C));
+}
+
+TEST(OpcodesTest, Opcode_0xAF_XOR_A) {
+  setup();
+  write_to_ram({0xC6, 0x55, 0xAF});
+  z80.step(); // add a, 0x55
+  z80.step(); // xor a
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 0x00);
+  EXPECT_EQ(reg.F, flag_mask(FLAGS::ZERO_Z) | flag_mask(FLAGS::PARITY_P));
+}
+
+TEST(OpcodesTest, Opcode_0xB8_CP_B) {
+  setup();
+  write_to_ram({0xC6, 0x10, 0x06, 0x28, 0xB8});
+  z80.step(); // add a, 0x10
+  z80.step(); // ld b, 0x28
+  z80.step(); // cp b
+
+  // A is left untouched and bits 3 and 5 are copied from the compared value
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 0x10);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::CARRY_C));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::SUBTRACT_N));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::COPY_3));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::COPY_5));
+}
+
+TEST(OpcodesTest, Opcode_0xFE_CP_n) {
+  setup();
+  write_to_ram({0xFE, 0x00});
+  z80.step(); // cp 0x00
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 7);
+  EXPECT_EQ(reg.PC, 0xc002);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::ZERO_Z));
+}
+
+TEST(OpcodesTest, Opcode_0xED_0xB0_LDIR) {
+  setup();
+  // ld hl, 0xc800
+  // ld de, 0xd000
+  // ld bc, 0x0010
+  // ldir
+  write_to_ram({0x21, 0x00, 0xC8, 0x11, 0x00, 0xD0, 0x01, 0x10, 0x00, 0xED, 0xB0});
+  for(int i = 0; i < 0x10; i++) {
+    mem.write(0xc800 + i, i + 1);
+  }
+  z80.step();
+  z80.step();
+  z80.step();
+
+  // A single iteration per step
+  z80.step();
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 21);
+  EXPECT_EQ(reg.PC, 0xc009);
+  EXPECT_EQ(reg.BC, 0x000F);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::OVERFLOW_V));
+
+  // The rest of them at once
+  EXPECT_EQ(z80.run(14 * 21 + 16), 14 * 21 + 16);
+  reg = z80.get_registers();
+  EXPECT_EQ(reg.PC, 0xc00b);
+  EXPECT_EQ(reg.BC, 0x0000);
+  EXPECT_EQ(reg.HL, 0xc810);
+  EXPECT_EQ(reg.DE, 0xd010);
+  EXPECT_EQ(reg.R, (3 + 2 * 0x10) & 0x7F);
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::OVERFLOW_V));
+  for(int i = 0; i < 0x10; i++) {
+    EXPECT_EQ(mem.read(0xd000 + i), i + 1);
+  }
+}
+
+TEST(OpcodesTest, Opcode_0xED_0xB0_LDIR_Fill) {
+  setup();
+  // ld hl, 0xc800
+  // ld de, 0xc801
+  // ld bc, 0x07FF
+  // ldir
+  write_to_ram({0x21, 0x00, 0xC8, 0x11, 0x01, 0xC8, 0x01, 0xFF, 0x07, 0xED, 0xB0});
+  mem.write(0xc800, 0xAA);
+  // The byte just past the range must be left alone
+  mem.write(0xd000, 0x55);
+  z80.run(30 + 0x7FE * 21 + 16);
+
+  // Copying onto the next byte fills the whole range, across pages, with the first one
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.PC, 0xc00b);
+  EXPECT_EQ(reg.BC, 0x0000);
+  EXPECT_EQ(reg.DE, 0xd000);
+  for(uint16_t address = 0xc800; address < 0xd000; address++) {
+    EXPECT_EQ(mem.read(address), 0xAA);
+  }
+  EXPECT_EQ(mem.read(0xd000), 0x55);
+}
+
+TEST(OpcodesTest, Opcode_0xED_0xB8_LDDR) {
+  setup();
+  // ld hl, 0xc803
+  // ld de, 0xc804
+  // ld bc, 0x0004
+  // lddr
+  write_to_ram({0x21, 0x03, 0xC8, 0x11, 0x04, 0xC8, 0x01, 0x04, 0x00, 0xED, 0xB8});
+  for(int i = 0; i < 4; i++) {
+    mem.write(0xc800 + i, i + 1);
+  }
+  z80.run(30 + 3 * 21 + 16);
+
+  // Copying down onto the previous byte shifts the range up by one
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.PC, 0xc00b);
+  EXPECT_EQ(reg.HL, 0xc7ff);
+  EXPECT_EQ(reg.DE, 0xc800);
+  EXPECT_EQ(mem.read(0xc800), 0x01);
+  EXPECT_EQ(mem.read(0xc801), 0x01);
+  EXPECT_EQ(mem.read(0xc802), 0x02);
+  EXPECT_EQ(mem.read(0xc803), 0x03);
+  EXPECT_EQ(mem.read(0xc804), 0x04);
+}
+
+TEST(OpcodesTest, Opcode_0x10_DJNZ_Delay) {
+  setup();
+  // ld b, 0x00
+  // djnz $
+  write_to_ram({0x06, 0x00, 0x10, 0xFE});
+  z80.step();
+
+  // 255 jumps and the final iteration that falls through
+  EXPECT_EQ(z80.run(255 * 13 + 8), 255 * 13 + 8);
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.B, 0);
+  EXPECT_EQ(reg.PC, 0xc004);
+  EXPECT_EQ(reg.R, (1 + 256) & 0x7F);
+}
+
+TEST(OpcodesTest, Run_BulkLoopsMatchStep) {
+  // ld hl, 0x0000
+  // ld de, 0xc000
+  // ld bc, 0x0400
+  // ldir
+  // ld b, 0x00
+  // djnz $
+  // jr -17
+  expect_run_matches_step({0x21, 0x00, 0x00, 0x11, 0x00, 0xC0, 0x01, 0x00, 0x04, 0xED, 0xB0,
+                           0x06, 0x00, 0x10, 0xFE, 0x18, 0xEF}, 1001);
+}
+
+TEST(OpcodesTest, Opcode_0x41_LD_B_C) {
+  setup();
+  write_to_ram({0x0E, 0x42, 0x41});
+  z80.step(); // ld c, 0x42
+  z80.step(); // ld b, c
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 4);
+  EXPECT_EQ(reg.B, 0x42);
+  EXPECT_EQ(reg.PC, 0xc003);
+}
+
+TEST(OpcodesTest, Opcode_0x36_LD_HL_n) {
+  setup();
+  write_to_ram({0x21, 0x00, 0xD0, 0x36, 0x7F, 0x34, 0x46});
+  z80.step(); // ld hl, 0xd000
+  z80.step(); // ld (hl), 0x7f
+  EXPECT_EQ(z80.get_cycles(), 10);
+  EXPECT_EQ(mem.read(0xd000), 0x7F);
+
+  z80.step(); // inc (hl)
+  EXPECT_EQ(z80.get_cycles(), 11);
+  EXPECT_EQ(mem.read(0xd000), 0x80);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::OVERFLOW_V));
+
+  z80.step(); // ld b, (hl)
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 7);
+  EXPECT_EQ(reg.B, 0x80);
+}
+
+TEST(OpcodesTest, Opcode_0xCD_CALL_nn) {
+  setup();
+  // call 0xc010
+  // ...
+  // 0xc010: ret
+  write_to_ram({0xCD, 0x10, 0xC0});
+  mem.write(0xc010, 0xC9);
+  uint16_t sp = z80.get_registers().SP;
+
+  z80.step();
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 17);
+  EXPECT_EQ(reg.PC, 0xc010);
+  EXPECT_EQ(reg.SP, sp - 2);
+  EXPECT_EQ(mem.read_word(reg.SP), 0xc003);
+
+  z80.step();
+  reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 10);
+  EXPECT_EQ(reg.PC, 0xc003);
+  EXPECT_EQ(reg.SP, sp);
+}
+
+TEST(OpcodesTest, Opcode_0xF5_PUSH_AF) {
+  setup();
+  write_to_ram({0x3E, 0x7F, 0x3C, 0xF5, 0xC1});
+  z80.step(); // ld a, 0x7f
+  z80.step(); // inc a
+  z80.step(); // push af
+  EXPECT_EQ(z80.get_cycles(), 11);
+
+  // The pending flags of inc are pushed
+  z80.step(); // pop bc
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 10);
+  EXPECT_EQ(reg.B, 0x80);
+  EXPECT_EQ(reg.C, reg.F);
+}
+
+TEST(OpcodesTest, Opcode_0x27_DAA) {
+  setup();
+  write_to_ram({0x3E, 0x19, 0xC6, 0x28, 0x27});
+  z80.step(); // ld a, 0x19
+  z80.step(); // add a, 0x28
+  z80.step(); // daa
+
+  // 19 + 28 = 47 in BCD
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 0x47);
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::CARRY_C));
+}
+
+TEST(OpcodesTest, Opcode_0xFF_RST_38) {
+  setup();
+  write_to_ram({0xFF});
+  z80.step();
+
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 11);
+  EXPECT_EQ(reg.PC, 0x0038);
+  EXPECT_EQ(mem.read_word(reg.SP), 0xc001);
+}
+
+TEST(OpcodesTest, Opcode_0xCB_Prefix) {
+  setup();
+  write_to_ram({0x06, 0x81, 0xCB, 0x00, 0xCB, 0x78, 0xCB, 0xDF});
+  z80.step(); // ld b, 0x81
+  z80.step(); // rlc b
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 8);
+  EXPECT_EQ(reg.B, 0x03);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::CARRY_C));
+
+  z80.step(); // bit 7, b
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::ZERO_Z));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::CARRY_C));
+
+  z80.step(); // set 3, a
+  reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 0x08);
+  EXPECT_EQ(reg.PC, 0xc008);
+  // Both the prefix and the opcode move R on
+  EXPECT_EQ(reg.R, 7);
+}
+
+TEST(OpcodesTest, Opcode_0xDD_Prefix) {
+  setup();
+  // ld ix, 0xd000
+  // ld (ix+5), 0x42
+  // ld a, (ix+5)
+  // inc (ix-1)
+  // ld ixh, a
+  write_to_ram({0xDD, 0x21, 0x00, 0xD0, 0xDD, 0x36, 0x05, 0x42, 0xDD, 0x7E, 0x05, 0xDD, 0x34, 0xFF, 0xDD, 0x67});
+  mem.write(0xd005, 0x00);
+  mem.write(0xcfff, 0x7F);
+  z80.step();
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 14);
+  EXPECT_EQ(reg.IX, 0xd000);
+  EXPECT_EQ(reg.PC, 0xc004);
+
+  z80.step();
+  EXPECT_EQ(z80.get_cycles(), 19);
+  EXPECT_EQ(mem.read(0xd005), 0x42);
+
+  z80.step();
+  reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 19);
+  EXPECT_EQ(reg.A, 0x42);
+
+  z80.step();
+  EXPECT_EQ(z80.get_cycles(), 23);
+  EXPECT_EQ(mem.read(0xcfff), 0x80);
+
+  z80.step();
+  reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 8);
+  EXPECT_EQ(reg.IX, 0x4200);
+  EXPECT_EQ(reg.PC, 0xc010);
+  EXPECT_EQ(reg.R, 10);
+}
+
+TEST(OpcodesTest, Opcode_0xDD_IgnoredPrefix) {
+  setup();
+  write_to_ram({0xDD, 0x04});
+  z80.step(); // The prefix on its own
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 4);
+  EXPECT_EQ(reg.PC, 0xc001);
+
+  z80.step(); // inc b
+  reg = z80.get_registers();
+  EXPECT_EQ(reg.B, 1);
+  EXPECT_EQ(reg.R, 2);
+}
+
+TEST(OpcodesTest, Opcode_0xFD_0xCB_Prefix) {
+  setup();
+  // ld iy, 0xd000
+  // set 0, (iy+2)
+  // rlc (iy+2), b
+  write_to_ram({0xFD, 0x21, 0x00, 0xD0, 0xFD, 0xCB, 0x02, 0xC6, 0xFD, 0xCB, 0x02, 0x00});
+  mem.write(0xd002, 0x00);
+  z80.step();
+  z80.step();
+  EXPECT_EQ(z80.get_cycles(), 23);
+  EXPECT_EQ(mem.read(0xd002), 0x01);
+
+  // The result is also copied to B
+  z80.step();
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(mem.read(0xd002), 0x02);
+  EXPECT_EQ(reg.B, 0x02);
+  EXPECT_EQ(reg.PC, 0xc00c);
+  EXPECT_EQ(reg.R, 6);
+  EXPECT_EQ(Z80::decode_opcode(&mem, 0xc008), OPCODE_TABLE_FDCB | 0x00);
+}
+
+TEST(OpcodesTest, Opcode_0xED_Prefix) {
+  setup();
+  // ld a, 0x01
+  // neg
+  // ld hl, 0x1000
+  // ld de, 0x0001
+  // sbc hl, de
+  // ld a, r
+  write_to_ram({0x3E, 0x01, 0xED, 0x44, 0x21, 0x00, 0x10, 0x11, 0x01, 0x00, 0xED, 0x52, 0xED, 0x5F});
+  z80.step();
+  z80.step();
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 8);
+  EXPECT_EQ(reg.A, 0xFF);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::CARRY_C));
+
+  z80.step();
+  z80.step();
+  z80.step(); // sbc hl, de with the carry of neg
+  reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 15);
+  EXPECT_EQ(reg.HL, 0x0FFE);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::HALF_CARRY_H));
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::CARRY_C));
+
+  z80.step();
+  reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 9);
+  EXPECT_EQ(reg.PC, 0xc00e);
+}
+
+TEST(OpcodesTest, Run_PrefixedMatchesStep) {
+  // ld ix, 0xc000
+  // loop: ld (ix+0), b
+  // inc ix
+  // bit 0, b
+  // djnz loop
+  // jr -13
+  expect_run_matches_step({0xDD, 0x21, 0x00, 0xC0, 0xDD, 0x70, 0x00, 0xDD, 0x23, 0xCB, 0x40, 0x10, 0xF7, 0x18, 0xF1},
+                          1001);
+}
+
+TEST(OpcodesTest, Opcode_0xD3_OUT_n_A) {
+  setup();
+  PortLog log{};
+  attach_port_log(log);
+  // ld a, 0x12
+  // out (0xbe), a
+  // in a, (0xbe)
+  write_to_ram({0x3E, 0x12, 0xD3, 0xBE, 0xDB, 0xBE});
+  z80.step();
+  z80.step();
+  EXPECT_EQ(z80.get_cycles(), 11);
+  ASSERT_EQ(log.writes.size(), 1);
+  EXPECT_EQ(log.writes[0].first, 0xBE);
+  EXPECT_EQ(log.writes[0].second, 0x12);
+
+  z80.step();
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 11);
+  EXPECT_EQ(reg.A, 0xBF);
+  EXPECT_EQ(reg.PC, 0xc006);
+}
+
+TEST(OpcodesTest, Opcode_0xED_0x78_IN_A_C) {
+  setup();
+  PortLog log{};
+  attach_port_log(log);
+  // ld c, 0x7f
+  // in a, (c)
+  // in a, (c) from an unconnected port
+  // out (c), 0
+  write_to_ram({0x0E, 0x7F, 0xED, 0x78, 0x0E, 0xBE, 0xED, 0x78, 0xED, 0x71});
+  z80.step();
+  z80.step();
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 12);
+  EXPECT_EQ(reg.A, 0xFF);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::SIGN_S));
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::PARITY_P));
+
+  z80.step();
+  z80.step();
+  reg = z80.get_registers();
+  EXPECT_EQ(reg.A, 0xBF);
+  EXPECT_FALSE(z80.is_flag_set(FLAGS::PARITY_P));
+
+  z80.step();
+  ASSERT_EQ(log.writes.size(), 1);
+  EXPECT_EQ(log.writes[0].second, 0x00);
+}
+
+TEST(OpcodesTest, Opcode_0xED_0xB3_OTIR) {
+  setup();
+  PortLog log{};
+  attach_port_log(log);
+  // ld hl, 0xd000
+  // ld bc, 0x04be
+  // otir
+  write_to_ram({0x21, 0x00, 0xD0, 0x01, 0xBE, 0x04, 0xED, 0xB3});
+  for(int i = 0; i < 4; i++) {
+    mem.write(0xd000 + i, 0x10 + i);
+  }
+  z80.step();
+  z80.step();
+
+  // Without a deadline every iteration is a separate instruction
+  z80.step();
+  EXPECT_EQ(z80.get_cycles(), 21);
+  EXPECT_EQ(z80.get_registers().PC, 0xc006);
+  for(int i = 0; i < 3; i++) {
+    z80.step();
+  }
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 16);
+  EXPECT_EQ(reg.B, 0);
+  EXPECT_EQ(reg.HL, 0xd004);
+  EXPECT_EQ(reg.PC, 0xc008);
+  EXPECT_TRUE(z80.is_flag_set(FLAGS::ZERO_Z));
+  ASSERT_EQ(log.writes.size(), 4);
+  EXPECT_EQ(log.writes[3].first, 0xBE);
+  EXPECT_EQ(log.writes[3].second, 0x13);
+}
+
+TEST(OpcodesTest, Run_BlockOutputMatchesStep) {
+  // ld hl, 0x0100
+  // ld bc, 0x40be
+  // loop: otir
+  // inir
+  // jr loop
+  expect_run_matches_step({0x21, 0x00, 0x01, 0x01, 0xBE, 0x40, 0xED, 0xB3, 0xED, 0xB2, 0x18, 0xFA}, 1001);
+}
+
+/**
+ * Same as setup(), with RAM over the whole address space so that the interrupt tests can write their routines to the
+ * vectors at 0x0038 and 0x0066
+ **/
+void setup_ram_image() {
+  z80.reset();
+  mem.load_ram_image(blank_rom);
+  io.detach_all();
+}
+
+/**
+ * Writes a routine to the start of memory, for the interrupt tests. Needs setup_ram_image()
+ **/
+void write_to_address(uint16_t address, std::vector<uint8_t> patch) {
+  for(auto value : patch) {
+    mem.write(address++, value);
+  }
+}
+
+TEST(OpcodesTest, Interrupt_IM1) {
+  setup_ram_image();
+  write_to_address(0x0038, {0x04, 0xC9}); // inc b, ret
+  // im 1
+  // ei
+  // nop
+  write_to_ram({0xED, 0x56, 0xFB, 0x00});
+  z80.set_irq_line(true);
+  z80.step();
+  z80.step();
+
+  // The instruction after ei can't be interrupted
+  z80.step();
+  EXPECT_EQ(z80.get_registers().PC, 0xc004);
+
+  z80.step();
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 13);
+  EXPECT_EQ(reg.PC, 0x0038);
+  EXPECT_EQ(reg.SP, 0xdfee);
+  EXPECT_EQ(mem.read_word(0xdfee), 0xc004);
+
+  // Interrupts are disabled by taking one, so the line being held doesn't interrupt the routine
+  z80.step();
+  z80.step();
+  reg = z80.get_registers();
+  EXPECT_EQ(reg.B, 1);
+  EXPECT_EQ(reg.PC, 0xc004);
+  z80.set_irq_line(false);
+}
+
+TEST(OpcodesTest, Interrupt_LongAfterEi) {
+  // Only the instruction right after ei holds interrupts off, however many instructions ago it was
+  for(int count : {1, 255, 256, 512}) {
+    setup();
+    // im 1
+    // ei
+    // loop: jr loop
+    write_to_ram({0xED, 0x56, 0xFB, 0x18, 0xFE});
+    z80.step();
+    z80.step();
+    for(int i = 0; i < count; i++) {
+      z80.step();
+    }
+
+    z80.set_irq_line(true);
+    z80.step();
+    z80.set_irq_line(false);
+    EXPECT_EQ(z80.get_registers().PC, 0x0038) << count;
+    EXPECT_EQ(mem.read_word(0xdfee), 0xc003) << count;
+  }
+}
+
+TEST(OpcodesTest, Interrupt_HaltWakeUp) {
+  setup();
+  // im 1
+  // ei
+  // halt
+  write_to_ram({0xED, 0x56, 0xFB, 0x76});
+  z80.step();
+  z80.step();
+  z80.step();
+  z80.step();
+  EXPECT_TRUE(z80.is_halted());
+  EXPECT_EQ(z80.get_registers().PC, 0xc003);
+
+  // The routine returns to the instruction after halt
+  z80.set_irq_line(true);
+  z80.step();
+  z80.set_irq_line(false);
+  EXPECT_FALSE(z80.is_halted());
+  EXPECT_EQ(z80.get_registers().PC, 0x0038);
+  EXPECT_EQ(mem.read_word(0xdfee), 0xc004);
+}
+
+TEST(OpcodesTest, Interrupt_NMI) {
+  setup_ram_image();
+  write_to_address(0x0066, {0xED, 0x45}); // retn
+  // ei
+  // nop
+  write_to_ram({0xFB, 0x00, 0x00});
+  z80.step();
+
+  // Not held off by ei or by interrupts being disabled
+  z80.trigger_nmi();
+  z80.step();
+  Registers reg = z80.get_registers();
+  EXPECT_EQ(z80.get_cycles(), 11);
+  EXPECT_EQ(reg.PC, 0x0066);
+  EXPECT_EQ(mem.read_word(0xdfee), 0xc001);
+
+  // retn restores the interrupt state from before the NMI
+  z80.step();
+  z80.set_irq_line(true);
+  z80.step();
+  z80.set_irq_line(false);
+  EXPECT_EQ(z80.get_registers().PC, 0x0038);
+}
+
+TEST(OpcodesTest, Interrupt_Run) {
+  setup_ram_image();
+  write_to_address(0x0038, {0x04, 0xC9}); // inc b, ret
+  // im 1
+  // ei
+  // loop: jr loop
+  write_to_ram({0xED, 0x56, 0xFB, 0x18, 0xFE});
+  z80.run(100);
+  EXPECT_EQ(z80.get_registers().B, 0);
+
+  // The interrupt is taken at the start of the next run, and the run carries on to its budget
+  z80.set_irq_line(true);
+  unsigned long cycles = z80.run(100);
+  z80.set_irq_line(false);
+  Registers reg = z80.get_registers();
+  EXPECT_GE(cycles, 100);
+  EXPECT_EQ(reg.PC, 0xc003);
+  EXPECT_EQ(reg.SP, 0xdff0);
+  EXPECT_EQ(reg.B, 1);
+}
+
+/**
+ * Asserts the interrupt line when written to, like a device enabling its interrupt
+ **/
+struct InterruptSource {
+  Z80* cpu;
+
+  void write(uint8_t, uint8_t value) {
+    cpu->set_irq_line(value != 0);
+  }
+};
+
+TEST(OpcodesTest, Interrupt_FromPortWrite) {
+  setup_ram_image();
+  InterruptSource source{&z80};
+  io.attach_write<&InterruptSource::write>(PortFunction::VDP_CONTROL, &source);
+  write_to_address(0x0038, {0x3E, 0x00, 0xD3, 0xBF, 0x04, 0xFB, 0xC9}); // ld a, 0, out (0xbf), a, inc b, ei, ret
+  // im 1
+  // ei
+  // ld a, 1
+  // out (0xbf), a
+  // loop: jr loop
+  write_to_ram({0xED, 0x56, 0xFB, 0x3E, 0x01, 0xD3, 0xBF, 0x18, 0xFE});
+  unsigned long cycles = z80.run(1000);
+
+  // Taken right after the write, in the middle of the run
+  Registers reg = z80.get_registers();
+  EXPECT_GE(cycles, 1000);
+  EXPECT_EQ(reg.B, 1);
+  EXPECT_EQ(reg.PC, 0xc007);
+  EXPECT_EQ(reg.SP, 0xdff0);
+}
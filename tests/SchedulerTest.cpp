@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <cstdint>
+
+#include "Scheduler.h"
+#include "SMS.h"
+
+TEST(SchedulerTest, Events_PopInOrder) {
+  Scheduler scheduler{};
+  scheduler.schedule(EventType::VBLANK, 300);
+  scheduler.schedule(EventType::LINE, 100);
+  scheduler.schedule(EventType::FRAME_END, 200);
+  EXPECT_EQ(scheduler.next_deadline(), 100);
+
+  // Nothing is due until the clock reaches the deadline
+  Event event{};
+  EXPECT_FALSE(scheduler.pop_due(event));
+
+  scheduler.advance(250);
+  ASSERT_TRUE(scheduler.pop_due(event));
+  EXPECT_EQ(event.type, EventType::LINE);
+  ASSERT_TRUE(scheduler.pop_due(event));
+  EXPECT_EQ(event.type, EventType::FRAME_END);
+  EXPECT_FALSE(scheduler.pop_due(event));
+  EXPECT_EQ(scheduler.next_deadline(), 300);
+}
+
+TEST(SchedulerTest, Events_RescheduleAndCancel) {
+  Scheduler scheduler{};
+  scheduler.schedule(EventType::LINE, 100);
+  scheduler.schedule(EventType::VBLANK, 200);
+
+  // Only one event of each type can be pending
+  scheduler.schedule(EventType::LINE, 400);
+  EXPECT_EQ(scheduler.next_deadline(), 200);
+
+  scheduler.cancel(EventType::VBLANK);
+  EXPECT_EQ(scheduler.next_deadline(), 400);
+  scheduler.cancel(EventType::LINE);
+  EXPECT_EQ(scheduler.next_deadline(), UINT64_MAX);
+}
+
+TEST(SchedulerTest, Update_CarriesOvershoot) {
+  SMS sms{};
+  // A cartridge full of nops
+  sms.load_cartridge(std::vector<uint8_t>(0x4000, 0x00));
+
+  // Frames end on exact multiples of the frame length, give or take the last instruction, so every frame ends as the
+  // VDP wraps back to line 0
+  for(int frame = 0; frame < 60; frame++) {
+    sms.update();
+    EXPECT_EQ(sms.get_line(), 0);
+  }
+
+  EXPECT_GE(sms.get_clock(), 60 * CYCLES_PER_FRAME);
+  EXPECT_LT(sms.get_clock(), 60 * CYCLES_PER_FRAME + 4);
+}
@@ -0,0 +1,375 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+#include "Memory.h"
+#include "Vdp.h"
+#include "Z80.h"
+
+static void set_register(Vdp& vdp, int reg, uint8_t value) {
+  vdp.write_control(0xBF, value);
+  vdp.write_control(0xBF, 0x80 | reg);
+}
+
+static void write_vram(Vdp& vdp, uint16_t address, const std::vector<uint8_t>& data) {
+  vdp.write_control(0xBF, address & 0xFF);
+  vdp.write_control(0xBF, 0x40 | (address >> 8));
+  for (uint8_t value : data) {
+    vdp.write_data(0xBE, value);
+  }
+}
+
+static void render_line(Vdp& vdp, int line) {
+  vdp.start_line(line);
+  vdp.end_line();
+}
+
+/**
+ * Fills CRAM with its own indices, so the framebuffer shows the palette index of every pixel
+ **/
+static void set_index_palette(Vdp& vdp) {
+  vdp.write_control(0xBF, 0x00);
+  vdp.write_control(0xBF, 0xC0);
+  for (int i = 0; i < CRAM_SIZE; i++) {
+    vdp.write_data(0xBE, i);
+  }
+}
+
+/**
+ * Name table at 0x3800, sprite attribute table at 0x3F00 and sprite tiles from 0, with the display on
+ **/
+static void setup_display(Vdp& vdp) {
+  vdp.reset();
+  set_index_palette(vdp);
+  set_register(vdp, 1, 0x40);
+  set_register(vdp, 2, 0xFF);
+  set_register(vdp, 5, 0xFF);
+  set_register(vdp, 6, 0xFB);
+  // No sprites
+  write_vram(vdp, 0x3F00, {0xD0});
+}
+
+TEST(VdpTest, Ports_ReadBuffer) {
+  Vdp vdp{};
+  vdp.reset();
+  write_vram(vdp, 0x1234, {0x11, 0x22, 0x33});
+
+  // Setting a read address fills the buffer, every read returns it and refills it from the next address
+  vdp.write_control(0xBF, 0x34);
+  vdp.write_control(0xBF, 0x12);
+  EXPECT_EQ(vdp.read_data(0xBE), 0x11);
+  EXPECT_EQ(vdp.read_data(0xBE), 0x22);
+
+  // Writes go through the buffer too
+  vdp.write_data(0xBE, 0x44);
+  EXPECT_EQ(vdp.read_data(0xBE), 0x44);
+}
+
+TEST(VdpTest, Ports_Cram) {
+  Vdp vdp{};
+  vdp.reset();
+  vdp.write_control(0xBF, 0x02);
+  vdp.write_control(0xBF, 0xC0);
+  vdp.write_data(0xBE, 0x3F);
+  vdp.write_data(0xBE, 0x30);
+
+  EXPECT_EQ(vdp.get_cram()[2], 0x3F);
+  EXPECT_EQ(vdp.get_cram()[3], 0x30);
+  EXPECT_EQ(Vdp::to_rgb(0x3F), 0xFFFFFF);
+  EXPECT_EQ(Vdp::to_rgb(0x30), 0x0000FF);
+  EXPECT_EQ(Vdp::to_rgb(0x01), 0x550000);
+}
+
+TEST(VdpTest, Render_Blank) {
+  Vdp vdp{};
+  vdp.reset();
+  set_index_palette(vdp);
+  set_register(vdp, 7, 0x05);
+  render_line(vdp, 10);
+
+  // The display is off after a reset, so the line is the backdrop colour from the sprite palette
+  EXPECT_EQ(vdp.get_framebuffer()[10 * SCREEN_WIDTH], 21);
+  EXPECT_EQ(vdp.get_framebuffer()[11 * SCREEN_WIDTH - 1], 21);
+}
+
+TEST(VdpTest, Render_Background) {
+  Vdp vdp{};
+  setup_display(vdp);
+  // Tile 1, row 0: colour 1 on the leftmost pixel, colour 2 on the rightmost one
+  write_vram(vdp, 0x0020, {0x80, 0x01});
+  // Top left entry: tile 1. The next one: tile 1 flipped horizontally, with the sprite palette
+  write_vram(vdp, 0x3800, {0x01, 0x00, 0x01, 0x0A});
+  render_line(vdp, 0);
+
+  const Framebuffer& frame = vdp.get_framebuffer();
+  EXPECT_EQ(frame[0], 1);
+  EXPECT_EQ(frame[1], 0);
+  EXPECT_EQ(frame[7], 2);
+  EXPECT_EQ(frame[8], 18);
+  EXPECT_EQ(frame[15], 17);
+
+  // Scrolling right by 3 pixels
+  set_register(vdp, 8, 3);
+  render_line(vdp, 0);
+  EXPECT_EQ(frame[3], 1);
+  EXPECT_EQ(frame[10], 2);
+
+  // Scrolling down by a row, which only takes effect at the start of the next frame
+  write_vram(vdp, 0x3840, {0x01, 0x08});
+  set_register(vdp, 8, 0);
+  set_register(vdp, 9, 8);
+  vdp.end_line();
+  EXPECT_EQ(frame[0], 1);
+  render_line(vdp, 0);
+  EXPECT_EQ(frame[0], 17);
+}
+
+TEST(VdpTest, Render_PaletteChange) {
+  Vdp vdp{};
+  setup_display(vdp);
+  write_vram(vdp, 0x0020, {0x80, 0x00, 0x00, 0x00, 0x80});
+  write_vram(vdp, 0x3800, {0x01, 0x00});
+  render_line(vdp, 0);
+
+  // The colours are looked up as lines are drawn, so the lines already drawn keep the old ones
+  vdp.write_control(0xBF, 0x01);
+  vdp.write_control(0xBF, 0xC0);
+  vdp.write_data(0xBE, 0x2A);
+  render_line(vdp, 1);
+  EXPECT_EQ(vdp.get_framebuffer()[0], 1);
+  EXPECT_EQ(vdp.get_framebuffer()[SCREEN_WIDTH], 0x2A);
+}
+
+TEST(VdpTest, Render_TileRewritten) {
+  Vdp vdp{};
+  setup_display(vdp);
+  // Tile 1 at the top left and flipped next to it
+  write_vram(vdp, 0x3800, {0x01, 0x00, 0x01, 0x02});
+  write_vram(vdp, 0x0020, {0x80});
+  render_line(vdp, 0);
+  const Framebuffer& frame = vdp.get_framebuffer();
+  EXPECT_EQ(frame[0], 1);
+  EXPECT_EQ(frame[15], 1);
+
+  // Both the tile and its flipped copy see the new data on the next line rendered
+  write_vram(vdp, 0x0020, {0x40, 0x40});
+  render_line(vdp, 0);
+  EXPECT_EQ(frame[0], 0);
+  EXPECT_EQ(frame[1], 3);
+  EXPECT_EQ(frame[14], 3);
+  EXPECT_EQ(frame[15], 0);
+
+  // The last tile of VRAM, which overlaps the sprite attribute table
+  write_vram(vdp, 0x3800, {0xFF, 0x01});
+  write_vram(vdp, 0x3FE0, {0x00, 0x00, 0x80});
+  render_line(vdp, 0);
+  EXPECT_EQ(frame[0], 4);
+}
+
+TEST(VdpTest, Render_Sprites) {
+  Vdp vdp{};
+  setup_display(vdp);
+  // Tile 2, every row in colour 3
+  for (int row = 0; row < 8; row++) {
+    write_vram(vdp, 0x0040 + row * 4, {0xFF, 0xFF});
+  }
+  // Sprite 0 at (16, 10), using tile 2
+  write_vram(vdp, 0x3F00, {9, 0xD0});
+  write_vram(vdp, 0x3F80, {16, 2});
+
+  render_line(vdp, 9);
+  EXPECT_EQ(vdp.get_framebuffer()[9 * SCREEN_WIDTH + 16], 0);
+
+  render_line(vdp, 10);
+  const uint8_t* line = &vdp.get_framebuffer()[10 * SCREEN_WIDTH];
+  EXPECT_EQ(line[15], 0);
+  EXPECT_EQ(line[16], 19);
+  EXPECT_EQ(line[23], 19);
+  EXPECT_EQ(line[24], 0);
+
+  // Background tiles with their priority bit cover the sprites, except for their colour 0
+  write_vram(vdp, 0x0028, {0x80});
+  write_vram(vdp, 0x3844, {0x01, 0x10});
+  render_line(vdp, 10);
+  EXPECT_EQ(line[16], 1);
+  EXPECT_EQ(line[17], 19);
+}
+
+TEST(VdpTest, Sprites_Moved) {
+  Vdp vdp{};
+  setup_display(vdp);
+  for (int row = 0; row < 8; row++) {
+    write_vram(vdp, 0x0040 + row * 4, {0xFF});
+    write_vram(vdp, 0x0060 + row * 4, {0x00, 0xFF});
+  }
+  write_vram(vdp, 0x3F00, {9, 0xD0});
+  write_vram(vdp, 0x3F80, {16, 2});
+  const Framebuffer& frame = vdp.get_framebuffer();
+  render_line(vdp, 10);
+  EXPECT_EQ(frame[10 * SCREEN_WIDTH + 16], 17);
+
+  // The lines the sprite leaves and the ones it moves to see the change
+  write_vram(vdp, 0x3F00, {19});
+  render_line(vdp, 10);
+  render_line(vdp, 20);
+  EXPECT_EQ(frame[10 * SCREEN_WIDTH + 16], 0);
+  EXPECT_EQ(frame[20 * SCREEN_WIDTH + 16], 17);
+
+  // So does every line when the sprites become 8x16, which shows tile 3 under tile 2
+  set_register(vdp, 1, 0x42);
+  render_line(vdp, 28);
+  EXPECT_EQ(frame[28 * SCREEN_WIDTH + 16], 18);
+
+  // And when the terminator moves in front of the sprite
+  write_vram(vdp, 0x3F00, {0xD0});
+  render_line(vdp, 20);
+  EXPECT_EQ(frame[20 * SCREEN_WIDTH + 16], 0);
+}
+
+TEST(VdpTest, Sprites_OverflowAndCollision) {
+  Vdp vdp{};
+  setup_display(vdp);
+  write_vram(vdp, 0x0040, {0xFF});
+  // 9 sprites on line 0, all at x = 0 but the last one
+  write_vram(vdp, 0x3F00, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xD0});
+  write_vram(vdp, 0x3F80, {0, 2, 0, 2, 0, 2, 0, 2, 0, 2, 0, 2, 0, 2, 0, 2, 100, 2});
+  render_line(vdp, 0);
+
+  EXPECT_EQ(vdp.get_framebuffer()[0], 17);
+  EXPECT_EQ(vdp.get_framebuffer()[100], 0);
+
+  // Reading the status clears the flags
+  EXPECT_EQ(vdp.read_control(0xBF), VDP_STATUS_SPRITE_OVERFLOW | VDP_STATUS_SPRITE_COLLISION);
+  EXPECT_EQ(vdp.read_control(0xBF), 0);
+
+  // The terminator hides the sprites after it
+  write_vram(vdp, 0x3F01, {0xD0});
+  render_line(vdp, 0);
+  EXPECT_EQ(vdp.read_control(0xBF), 0);
+}
+
+TEST(VdpTest, Render_UnchangedLinesReused) {
+  Vdp vdp{};
+  setup_display(vdp);
+  write_vram(vdp, 0x0020, {0x80});
+  write_vram(vdp, 0x0040, {0xFF});
+  write_vram(vdp, 0x3800, {0x01, 0x00});
+  // Two sprites on top of each other
+  write_vram(vdp, 0x3F00, {0xFF, 0xFF, 0xD0});
+  write_vram(vdp, 0x3F80, {32, 2, 32, 2});
+  const Framebuffer& frame = vdp.get_framebuffer();
+  render_line(vdp, 0);
+  EXPECT_EQ(vdp.rendered_line_count(), 1);
+  EXPECT_EQ(vdp.read_control(0xBF), VDP_STATUS_SPRITE_COLLISION);
+
+  // The line is left as it was, but still sets the collision flag
+  render_line(vdp, 0);
+  EXPECT_EQ(vdp.rendered_line_count(), 1);
+  EXPECT_EQ(vdp.read_control(0xBF), VDP_STATUS_SPRITE_COLLISION);
+  EXPECT_EQ(frame[0], 1);
+  EXPECT_EQ(frame[32], 17);
+
+  // Every input of the line is noticed: scrolling, CRAM, tiles and the sprites
+  set_register(vdp, 8, 1);
+  render_line(vdp, 0);
+  EXPECT_EQ(frame[1], 1);
+
+  vdp.write_control(0xBF, 0x01);
+  vdp.write_control(0xBF, 0xC0);
+  vdp.write_data(0xBE, 0x2A);
+  render_line(vdp, 0);
+  EXPECT_EQ(frame[1], 0x2A);
+
+  write_vram(vdp, 0x0020, {0x40});
+  render_line(vdp, 0);
+  EXPECT_EQ(frame[1], 0);
+  EXPECT_EQ(frame[2], 0x2A);
+
+  write_vram(vdp, 0x3F82, {40});
+  render_line(vdp, 0);
+  EXPECT_EQ(frame[40], 17);
+  EXPECT_EQ(vdp.rendered_line_count(), 5);
+
+  // Blanking the display redraws the line once it is turned back on
+  set_register(vdp, 1, 0x00);
+  render_line(vdp, 0);
+  set_register(vdp, 1, 0x40);
+  render_line(vdp, 0);
+  EXPECT_EQ(frame[2], 0x2A);
+  EXPECT_EQ(vdp.rendered_line_count(), 6);
+}
+
+/**
+ * Runs im 1, ei, halt so that the CPU sleeps until the VDP interrupts it. The routine re-enables interrupts and goes
+ * back to the halt
+ **/
+static void halt_cpu(Memory& mem, Z80& cpu) {
+  std::vector<uint8_t> rom(0x8000, 0);
+  const std::vector<uint8_t> program = {0xED, 0x56, 0xFB, 0x76, 0x18, 0xFD};
+  std::copy(program.begin(), program.end(), rom.begin());
+  rom[0x0038] = 0xFB;
+  rom[0x0039] = 0xC9;
+  mem.load_cartridge(rom);
+  cpu.reset();
+  for (int i = 0; i < 4; i++) {
+    cpu.step();
+  }
+}
+
+TEST(VdpTest, Interrupt_Frame) {
+  Memory mem{};
+  Z80 cpu{&mem};
+  Vdp vdp{&cpu};
+  vdp.reset();
+  halt_cpu(mem, cpu);
+
+  // Disabled in register 1
+  vdp.start_vblank();
+  cpu.step();
+  EXPECT_TRUE(cpu.is_halted());
+
+  set_register(vdp, 1, 0x20);
+  cpu.step();
+  EXPECT_EQ(cpu.get_registers().PC, 0x0038);
+
+  // Reading the status acknowledges the interrupt
+  EXPECT_EQ(vdp.read_control(0xBF), VDP_STATUS_FRAME_INTERRUPT);
+  for (int i = 0; i < 5; i++) {
+    cpu.step();
+  }
+  EXPECT_TRUE(cpu.is_halted());
+}
+
+TEST(VdpTest, Interrupt_Line) {
+  Memory mem{};
+  Z80 cpu{&mem};
+  Vdp vdp{&cpu};
+  vdp.reset();
+  halt_cpu(mem, cpu);
+  set_register(vdp, 0, 0x10);
+  set_register(vdp, 10, 2);
+
+  // The counter is reloaded outside the active display, then it fires every 3 lines
+  vdp.start_line(193);
+  vdp.start_line(0);
+  vdp.start_line(1);
+  cpu.step();
+  EXPECT_TRUE(cpu.is_halted());
+
+  vdp.start_line(2);
+  cpu.step();
+  EXPECT_EQ(cpu.get_registers().PC, 0x0038);
+  vdp.read_control(0xBF);
+}
+
+TEST(VdpTest, Counters) {
+  Vdp vdp{};
+  vdp.reset();
+  vdp.start_line(0xDA);
+  EXPECT_EQ(vdp.read_v_counter(0x7E), 0xDA);
+  vdp.start_line(0xDB);
+  EXPECT_EQ(vdp.read_v_counter(0x7E), 0xD5);
+  vdp.start_line(261);
+  EXPECT_EQ(vdp.read_v_counter(0x7E), 0xFF);
+}